@@ -0,0 +1,956 @@
+#include <array>
+#include <cstdio>
+#include <deque>
+#include <list>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "globals.h"
+#define RANGED_IMPLEMENTATION
+#define RANGED_NO_DEPRECATION_WARNINGS 1
+#include "ranged.h"
+
+#if __cplusplus >= 202002L
+#include <ranges>
+#endif
+
+static std::vector<int> make_input(const size_t size) {
+    std::vector<int> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = static_cast<int>((i * 2654435761u) % 1000003);
+    }
+    return v;
+}
+
+// Containers used by the tests, filled with `size` distinct keys in scrambled order
+template<typename C>
+struct container_traits;
+template<>
+struct container_traits<std::vector<int>> { static const char *name() { return "vector"; } };
+template<>
+struct container_traits<std::deque<int>> { static const char *name() { return "deque"; } };
+template<>
+struct container_traits<std::list<int>> { static const char *name() { return "list"; } };
+template<>
+struct container_traits<std::set<int>> { static const char *name() { return "set"; } };
+template<>
+struct container_traits<std::unordered_map<int, int>> { static const char *name() { return "unordered_map"; } };
+
+inline int make_element(const size_t i, const size_t size, int) { return static_cast<int>(i * 7919 % size); }
+inline std::pair<const int, int> make_element(const size_t i, const size_t size, std::pair<const int, int>) {
+    return {static_cast<int>(i * 7919 % size), static_cast<int>(i)};
+}
+
+template<typename C>
+static C make_container(const size_t size) {
+    C container;
+    for (size_t i = 0; i < size; ++i) {
+        container.insert(container.end(), make_element(i, size, typename C::value_type {}));
+    }
+    return container;
+}
+
+inline int key(const int &x) { return x; }
+inline int key(const std::pair<const int, int> &x) { return x.first; }
+
+// Where `filter` and `to<>` results go: key/value elements are materialized through `to<std::map>`
+template<typename T>
+struct sink {
+    using type = std::vector<T>;
+    static const char *name() { return "to<vector>"; }
+    template<typename R>
+    static type to(const R &range) { return ranged::to<std::vector>(range); }
+    static void add(type &result, const T &x) { result.push_back(x); }
+};
+template<>
+struct sink<std::pair<const int, int>> {
+    using type = std::map<int, int>;
+    static const char *name() { return "to<map>"; }
+    template<typename R>
+    static type to(const R &range) { return ranged::to<std::map>(range); }
+    static void add(type &result, const std::pair<const int, int> &x) { result.insert(x); }
+};
+
+// Every algorithm and view over one container type: the ranged version first, then the raw loop and `std::ranges`
+template<typename C>
+static void container_benchmarks() {
+    using T = typename C::value_type;
+    const std::string container = container_traits<C>::name();
+    const auto pred = [](const T &x) { return key(x) % 3 == 0; };
+    const auto func = [](const T &x) { return key(x) * 2; };
+
+    for (const size_t size: benchmark_sizes()) {
+        const C c = make_container<C>(size);
+
+        record("filter", container, "ranged", size, measure([&] {
+            do_not_optimize(sink<T>::to(ranged::filter(c, pred)));
+        }));
+        record("filter", container, "raw", size, measure([&] {
+            typename sink<T>::type result;
+            for (const T &x: c) {
+                if (pred(x))
+                    sink<T>::add(result, x);
+            }
+            do_not_optimize(result);
+        }));
+#if __cplusplus >= 202002L
+        record("filter", container, "std::ranges", size, measure([&] {
+            typename sink<T>::type result;
+            for (const T &x: c | std::views::filter(pred)) {
+                sink<T>::add(result, x);
+            }
+            do_not_optimize(result);
+        }));
+#endif
+
+        record("transform", container, "ranged", size, measure([&] {
+            do_not_optimize(ranged::to<std::vector>(ranged::transform(c, func)));
+        }));
+        record("transform", container, "raw", size, measure([&] {
+            std::vector<int> result;
+            result.reserve(c.size());
+            for (const T &x: c) {
+                result.push_back(func(x));
+            }
+            do_not_optimize(result);
+        }));
+#if __cplusplus >= 202002L
+        record("transform", container, "std::ranges", size, measure([&] {
+            std::vector<int> result;
+            result.reserve(c.size());
+            for (const int x: c | std::views::transform(func)) {
+                result.push_back(x);
+            }
+            do_not_optimize(result);
+        }));
+#endif
+
+        record("zip", container, "ranged", size, measure([&] {
+            long long sum = 0;
+            for (const auto &pair: ranged::zip(c, c)) {
+                sum += key(std::get<0>(pair)) + key(std::get<1>(pair));
+            }
+            do_not_optimize(sum);
+        }));
+        record("zip", container, "raw", size, measure([&] {
+            long long sum = 0;
+            for (auto first = c.begin(), second = c.begin(); first != c.end(); ++first, ++second) {
+                sum += key(*first) + key(*second);
+            }
+            do_not_optimize(sum);
+        }));
+
+        record(sink<T>::name(), container, "ranged", size, measure([&] {
+            do_not_optimize(sink<T>::to(c));
+        }));
+        record(sink<T>::name(), container, "raw", size, measure([&] {
+            do_not_optimize(typename sink<T>::type(c.begin(), c.end()));
+        }));
+
+        record("count_if", container, "ranged", size, measure([&] {
+            do_not_optimize(ranged::count_if(c, pred));
+        }));
+        record("count_if", container, "raw", size, measure([&] {
+            size_t result = 0;
+            for (const T &x: c) {
+                result += pred(x);
+            }
+            do_not_optimize(result);
+        }));
+#if __cplusplus >= 202002L
+        record("count_if", container, "std::ranges", size, measure([&] {
+            do_not_optimize(std::ranges::count_if(c, pred));
+        }));
+#endif
+
+        record("max", container, "ranged", size, measure([&] {
+            do_not_optimize(ranged::max(c));
+        }));
+        record("max", container, "raw", size, measure([&] {
+            auto result = c.begin();
+            for (auto it = std::next(c.begin()); it != c.end(); ++it) {
+                if (*result < *it)
+                    result = it;
+            }
+            do_not_optimize(*result);
+        }));
+#if __cplusplus >= 202002L
+        record("max", container, "std::ranges", size, measure([&] {
+            do_not_optimize(std::ranges::max(c));
+        }));
+#endif
+
+        record("min", container, "ranged", size, measure([&] {
+            do_not_optimize(ranged::min(c));
+        }));
+        record("min", container, "raw", size, measure([&] {
+            auto result = c.begin();
+            for (auto it = std::next(c.begin()); it != c.end(); ++it) {
+                if (*it < *result)
+                    result = it;
+            }
+            do_not_optimize(*result);
+        }));
+#if __cplusplus >= 202002L
+        record("min", container, "std::ranges", size, measure([&] {
+            do_not_optimize(std::ranges::min(c));
+        }));
+#endif
+
+        record("emplace_range", container, "ranged", size, measure([&] {
+            std::vector<T> result;
+            ranged::emplace_range(result, c);
+            do_not_optimize(result);
+        }));
+        record("emplace_range", container, "raw", size, measure([&] {
+            std::vector<T> result;
+            for (const T &x: c) {
+                result.emplace_back(x);
+            }
+            do_not_optimize(result);
+        }));
+#if __cplusplus >= 202002L
+        record("emplace_range", container, "std::ranges", size, measure([&] {
+            std::vector<T> result;
+            std::ranges::copy(c, std::back_inserter(result));
+            do_not_optimize(result);
+        }));
+#endif
+    }
+}
+
+// `to_array` copies a fixed number of elements, whatever the size of the container
+template<typename C>
+static void to_array_benchmarks() {
+    using T = typename C::value_type;
+    constexpr size_t N = 64;
+    const std::string container = container_traits<C>::name();
+    const C c = make_container<C>(std::max(options.min_size, N));
+
+    record("to_array<64>", container, "ranged", N, measure([&] {
+        do_not_optimize(ranged::to_array<N>(c));
+    }));
+    record("to_array<64>", container, "raw", N, measure([&] {
+        std::array<T, N> result {};
+        auto it = c.begin();
+        for (size_t i = 0; i < N; ++i, ++it) {
+            result[i] = *it;
+        }
+        do_not_optimize(result);
+    }));
+}
+
+BENCHMARK(containers, vector) {
+    container_benchmarks<std::vector<int>>();
+    to_array_benchmarks<std::vector<int>>();
+}
+
+BENCHMARK(containers, deque) {
+    container_benchmarks<std::deque<int>>();
+    to_array_benchmarks<std::deque<int>>();
+}
+
+BENCHMARK(containers, list) {
+    container_benchmarks<std::list<int>>();
+    to_array_benchmarks<std::list<int>>();
+}
+
+BENCHMARK(containers, set) {
+    container_benchmarks<std::set<int>>();
+    to_array_benchmarks<std::set<int>>();
+}
+
+// Elements of an unordered_map have a const key, so `to_array` (which assigns into the array) does not apply
+BENCHMARK(containers, unordered_map) {
+    container_benchmarks<std::unordered_map<int, int>>();
+}
+
+// Runs `func(policy)` with 1, 2, 4, ... hardware threads; the relative column is the time against one thread
+template<typename FuncT>
+static void scaling(const char *name, const size_t elements, const FuncT &func) {
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1;; threads = std::min(threads * 2, hardware)) {
+        record(name, "vector", "par(" + std::to_string(threads) + ")", elements, measure([&] {
+            func(ranged::execution::par(threads));
+        }));
+        if (threads == hardware)
+            break;
+    }
+}
+
+BENCHMARK(parallel, scaling) {
+    const std::vector<int> v = make_input(std::max<size_t>(options.max_size, size_t {1} << 20));
+    const auto pred = [](const int &x) { return x % 7 == 0; };
+
+    scaling("count_if", v.size(), [&](const ranged::execution::parallel_policy &policy) {
+        do_not_optimize(ranged::count_if(policy, v, pred));
+    });
+    scaling("max", v.size(), [&](const ranged::execution::parallel_policy &policy) {
+        do_not_optimize(ranged::max(policy, v));
+    });
+    scaling("any", v.size(), [&](const ranged::execution::parallel_policy &policy) {
+        do_not_optimize(ranged::any(policy, v, [](const int &x) { return x < 0; }));
+    });
+}
+
+// Each SIMD kernel against the same algorithm driven by an opaque lambda, which takes the generic loop
+template<typename T>
+static void kernels_of(const char *type) {
+    const std::vector<int> input = make_input(options.max_size);
+    const std::vector<T> v(input.begin(), input.end());
+    const T pivot = static_cast<T>(500000);
+
+    record("max", type, "simd", v.size(), measure([&] { do_not_optimize(ranged::max(v)); }));
+    record("max", type, "generic", v.size(), measure([&] {
+        do_not_optimize(ranged::max(v, [](const T &a, const T &b) { return a < b; }));
+    }));
+    record("min", type, "simd", v.size(), measure([&] { do_not_optimize(ranged::min(v)); }));
+    record("min", type, "generic", v.size(), measure([&] {
+        do_not_optimize(ranged::min(v, [](const T &a, const T &b) { return a > b; }));
+    }));
+    record("count_if", type, "simd", v.size(), measure([&] {
+        do_not_optimize(ranged::count_if(v, ranged::greater_than(pivot)));
+    }));
+    record("count_if", type, "generic", v.size(), measure([&] {
+        do_not_optimize(ranged::count_if(v, [&](const T &x) { return x > pivot; }));
+    }));
+    record("contains", type, "simd", v.size(), measure([&] { do_not_optimize(ranged::contains(v, static_cast<T>(-1))); }));
+    record("contains", type, "generic", v.size(), measure([&] {
+        do_not_optimize(ranged::any(v, [](const T &x) { return x == static_cast<T>(-1); }));
+    }));
+}
+
+BENCHMARK(simd, kernels) {
+    kernels_of<int>("int32");
+    kernels_of<long long>("int64");
+    kernels_of<float>("float");
+    kernels_of<double>("double");
+}
+
+BENCHMARK(pipeline, fused_vs_hand_written) {
+    const std::vector<int> v = make_input(options.max_size);
+    const auto odd = [](const int &x) { return x % 2 != 0; };
+    const auto small = [](const int &x) { return x < 666666; };
+    const auto not_three = [](const int &x) { return x % 10 != 3; };
+    const auto scale = [](const int &x) { return static_cast<long long>(x) * 3; };
+    const auto shift = [](const long long &x) { return x + 7; };
+    const auto not_ten = [](const long long &x) { return x % 10 != 0; };
+
+    // Fuses into a single filter followed by a single transform
+    record("filter^3|transform^2", "vector", "piped", v.size(), measure([&] {
+        long long sum = 0;
+        for (const long long x: v | ranged::filter(odd) | ranged::filter(small) | ranged::filter(not_three) |
+                                ranged::transform(scale) | ranged::transform(shift)) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    record("filter^3|transform^2", "vector", "hand-written", v.size(), measure([&] {
+        long long sum = 0;
+        for (const int item: v) {
+            if (item % 2 == 0 || item >= 666666 || item % 10 == 3)
+                continue;
+            sum += static_cast<long long>(item) * 3 + 7;
+        }
+        do_not_optimize(sum);
+    }));
+
+    // A filter after a transform calls the transform again when the element is read
+    record("interleaved", "vector", "piped", v.size(), measure([&] {
+        long long sum = 0;
+        for (const long long x: v | ranged::filter(odd) | ranged::transform(scale) | ranged::filter([](const long long &x) { return x < 2000000; }) |
+                                ranged::transform(shift) | ranged::filter(not_ten)) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    record("interleaved", "vector", "hand-written", v.size(), measure([&] {
+        long long sum = 0;
+        for (const int item: v) {
+            if (item % 2 == 0)
+                continue;
+            const long long scaled = static_cast<long long>(item) * 3;
+            if (scaled >= 2000000)
+                continue;
+            const long long shifted = scaled + 7;
+            if (shifted % 10 == 0)
+                continue;
+            sum += shifted;
+        }
+        do_not_optimize(sum);
+    }));
+}
+
+BENCHMARK(chunk, blocked_vs_element) {
+    const std::vector<int> v = make_input(options.max_size);
+    const std::list<int> l(v.begin(), v.end());
+
+    // A per-chunk kernel the compiler vectorizes, against one transform call per element
+    const auto chunk_sum = [](ranged::span<const int> chunk) {
+        long long sum = 0;
+        for (const int x: chunk) {
+            sum += static_cast<long long>(x) * x;
+        }
+        return sum;
+    };
+    record("sum of squares", "vector", "chunk(4096)", v.size(), measure([&] {
+        long long sum = 0;
+        for (const long long partial: v | ranged::chunk(4096) | ranged::transform(chunk_sum)) {
+            sum += partial;
+        }
+        do_not_optimize(sum);
+    }));
+    record("sum of squares", "vector", "transform", v.size(), measure([&] {
+        long long sum = 0;
+        for (const long long x: v | ranged::transform([](const int &x) { return static_cast<long long>(x) * x; })) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    record("sum of squares", "list", "chunk(256)", l.size(), measure([&] {
+        long long sum = 0;
+        for (const long long partial: l | ranged::chunk(256) | ranged::transform(chunk_sum)) {
+            sum += partial;
+        }
+        do_not_optimize(sum);
+    }));
+}
+
+BENCHMARK(selection, half_selectivity) {
+    // `make_input` is scrambled, so a 50% predicate is unpredictable for the branchy filter
+    const std::vector<int> v = make_input(options.max_size);
+    const auto half = [](const int &x) { return x < 500000; };
+    const auto twice = [](const int &x) { return static_cast<long long>(x) * 2; };
+
+    record("to<vector>", "vector", "filter", v.size(), measure([&] {
+        const auto result = ranged::to<std::vector>(ranged::filter(v, half));
+        do_not_optimize(result.size());
+    }));
+    record("to<vector>", "vector", "selection", v.size(), measure([&] {
+        const auto result = ranged::to<std::vector>(ranged::filter(ranged::selection, v, half));
+        do_not_optimize(result.size());
+    }));
+    record("transform sum", "vector", "filter", v.size(), measure([&] {
+        long long sum = 0;
+        for (const long long x: v | ranged::filter(half) | ranged::transform(twice)) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    record("transform sum", "vector", "selection", v.size(), measure([&] {
+        long long sum = 0;
+        for (const long long x: v | ranged::filter(ranged::selection, half) | ranged::transform(twice)) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    record("count", "vector", "filter", v.size(), measure([&] {
+        const auto filtered = ranged::filter(v, half);
+        do_not_optimize(std::distance(filtered.begin(), filtered.end()));
+    }));
+    record("count", "vector", "selection", v.size(), measure([&] {
+        do_not_optimize(ranged::filter(ranged::selection, v, half).size());
+    }));
+}
+
+BENCHMARK(zip, soa_vs_aos) {
+    const std::vector<int> ids = make_input(options.max_size);
+    const std::vector<double> prices(ids.begin(), ids.end());
+    const std::vector<long long> stamps(ids.begin(), ids.end());
+
+    record("zip3 sum", "vector", "ranged", ids.size(), measure([&] {
+        double sum = 0;
+        for (const auto &row: ranged::zip(ids, prices, stamps)) {
+            sum += std::get<0>(row) * std::get<1>(row) + static_cast<double>(std::get<2>(row));
+        }
+        do_not_optimize(sum);
+    }));
+    record("zip3 sum", "vector", "raw", ids.size(), measure([&] {
+        double sum = 0;
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            sum += ids[i] * prices[i] + static_cast<double>(stamps[i]);
+        }
+        do_not_optimize(sum);
+    }));
+
+    // Materializing the zip: one vector per column, against copying the columns by hand and a vector of tuples.
+    // Large fresh columns are dominated by page faults, which the single vector of tuples may avoid.
+    record("materialize", "vector", "to_soa", ids.size(), measure([&] {
+        const auto columns = ranged::to_soa(ranged::zip(ids, prices, stamps));
+        do_not_optimize(std::get<2>(columns).back());
+    }));
+    record("materialize", "vector", "raw columns", ids.size(), measure([&] {
+        const std::vector<int> first(ids.begin(), ids.end());
+        const std::vector<double> second(prices.begin(), prices.end());
+        const std::vector<long long> third(stamps.begin(), stamps.end());
+        do_not_optimize(third.back());
+    }));
+    record("materialize", "vector", "to<vector>", ids.size(), measure([&] {
+        const auto rows = ranged::to<std::vector>(ranged::zip(ids, prices, stamps));
+        do_not_optimize(std::get<2>(rows.back()));
+    }));
+}
+
+BENCHMARK(arena, intermediates) {
+    // Many short-lived materializations of a small filtered batch, as when handling one request after another
+    const std::vector<int> v = make_input(options.max_size);
+    const std::size_t batch = 64;
+    const auto odd = [](const int &x) { return x % 2 == 1; };
+
+    record("small to<vector>", "vector", "std::allocator", v.size(), measure([&] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i + batch <= v.size(); i += batch) {
+            const std::vector<int> slice(v.begin() + i, v.begin() + i + batch);
+            total += ranged::to<std::vector>(ranged::filter(slice, odd)).size();
+        }
+        do_not_optimize(total);
+    }));
+    ranged::monotonic_arena arena;
+    record("small to<vector>", "vector", "arena", v.size(), measure([&] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i + batch <= v.size(); i += batch) {
+            const std::vector<int, ranged::arena_allocator<int>> slice(v.begin() + i, v.begin() + i + batch, ranged::arena_allocator<int>(arena));
+            total += ranged::to<std::vector>(ranged::filter(slice, odd), ranged::arena_allocator<int>(arena)).size();
+            arena.reset();
+        }
+        do_not_optimize(total);
+    }));
+}
+
+BENCHMARK(group_by, sum_count_by_key) {
+    // Rows keyed by one of `groups` keys, summed and counted per key: the flat table against the hand-written
+    // `std::unordered_map` loop, at low and high cardinality
+    const std::vector<int> v = make_input(options.max_size);
+    for (const int groups: {100, 100000}) {
+        const std::string container = "groups=" + std::to_string(groups);
+        const auto key = [groups](const int &x) { return x % groups; };
+        const auto amount = [](const int &x) { return static_cast<long long>(x); };
+
+        record("sum+count", container, "unordered_map", v.size(), measure([&] {
+            std::unordered_map<int, std::pair<long long, std::size_t>> result;
+            for (const int x: v) {
+                auto &group = result[key(x)];
+                group.first += amount(x);
+                ++group.second;
+            }
+            do_not_optimize(result.size());
+        }));
+        record("sum+count", container, "aggregate_by", v.size(), measure([&] {
+            const auto result = ranged::aggregate_by(v, key, ranged::agg::sum(amount), ranged::agg::count());
+            do_not_optimize(result.size());
+        }));
+        record("sum+count", container, "aggregate_by par", v.size(), measure([&] {
+            const auto result = ranged::aggregate_by(ranged::execution::par, v, key, ranged::agg::sum(amount), ranged::agg::count());
+            do_not_optimize(result.size());
+        }));
+    }
+}
+
+BENCHMARK(join, orders_customers) {
+    // `max_size` orders against a tenth as many customers, every order matching one customer. Customer ids are dense,
+    // which suits `std::hash`: as the identity, it keeps neighbouring ids in neighbouring buckets.
+    const std::size_t customer_count = std::max<std::size_t>(options.max_size / 10, 1);
+    std::vector<std::pair<int, double>> customers(customer_count);
+    for (std::size_t i = 0; i < customer_count; ++i) {
+        customers[i] = std::make_pair(static_cast<int>(i), static_cast<double>(i % 7));
+    }
+    const std::vector<int> input = make_input(options.max_size);
+    std::vector<std::pair<int, int>> orders(input.size());
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        orders[i] = std::make_pair(static_cast<int>(i), static_cast<int>(static_cast<std::size_t>(input[i]) % customer_count));
+    }
+    const auto customer_id = [](const std::pair<int, double> &c) { return c.first; };
+    const auto order_customer = [](const std::pair<int, int> &o) { return o.second; };
+
+    record("inner join sum", "vector", "unordered_map", orders.size(), measure([&] {
+        std::unordered_multimap<int, const std::pair<int, double> *> index;
+        for (const auto &customer: customers) {
+            index.emplace(customer.first, &customer);
+        }
+        double sum = 0;
+        for (const auto &order: orders) {
+            const auto range = index.equal_range(order.second);
+            for (auto it = range.first; it != range.second; ++it) {
+                sum += it->second->second;
+            }
+        }
+        do_not_optimize(sum);
+    }));
+    record("inner join sum", "vector", "hash_join", orders.size(), measure([&] {
+        double sum = 0;
+        for (const auto &row: ranged::hash_join(customers, orders, customer_id, order_customer)) {
+            sum += std::get<0>(row).second;
+        }
+        do_not_optimize(sum);
+    }));
+
+    // Both sides sorted by customer
+    std::vector<std::pair<int, int>> sorted_orders = orders;
+    std::sort(sorted_orders.begin(), sorted_orders.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.second < b.second; });
+    record("sorted join sum", "vector", "hash_join", orders.size(), measure([&] {
+        double sum = 0;
+        for (const auto &row: ranged::hash_join(customers, sorted_orders, customer_id, order_customer)) {
+            sum += std::get<0>(row).second;
+        }
+        do_not_optimize(sum);
+    }));
+    record("sorted join sum", "vector", "merge_join", orders.size(), measure([&] {
+        double sum = 0;
+        for (const auto &row: ranged::merge_join(customers, sorted_orders, customer_id, order_customer)) {
+            sum += std::get<0>(row).second;
+        }
+        do_not_optimize(sum);
+    }));
+}
+
+BENCHMARK(memoize, repeated_traversals) {
+    // Three passes over the same transformed view: the plain transform converts every element on each pass, the cached
+    // one converts it once, then reads the stored strings
+    const std::vector<int> v = make_input(options.max_size);
+    const auto to_string = [](const int &x) { return std::to_string(x); };
+    const auto short_string = [](const std::string &s) { return s.size() < 6; };
+    const auto starts_with_one = [](const std::string &s) { return s[0] == '1'; };
+    const auto total_length = [](std::size_t total, const std::string &s) { return total + s.size(); };
+
+    record("3 passes", "vector", "transform", v.size(), measure([&] {
+        const auto strings = ranged::transform(v, to_string);
+        do_not_optimize(ranged::count_if(strings, short_string));
+        do_not_optimize(ranged::count_if(strings, starts_with_one));
+        do_not_optimize(std::accumulate(strings.begin(), strings.end(), std::size_t {0}, total_length));
+    }));
+    record("3 passes", "vector", "transform_cached", v.size(), measure([&] {
+        const auto strings = ranged::transform_cached(v, to_string);
+        do_not_optimize(ranged::count_if(strings, short_string));
+        do_not_optimize(ranged::count_if(strings, starts_with_one));
+        do_not_optimize(std::accumulate(strings.begin(), strings.end(), std::size_t {0}, total_length));
+    }));
+}
+
+BENCHMARK(top_k, top_100_scores) {
+    // The 100 best scores of a filtered range: materialize and sort, `std::partial_sort_copy` over the view, then the
+    // bounded heap; the parallel version needs a random access range, so it runs over the whole input
+    const std::vector<int> v = make_input(options.max_size);
+    const std::size_t k = 100;
+    const auto even = [](const int &x) { return x % 2 == 0; };
+
+    record("top 100", "vector", "to+sort", v.size(), measure([&] {
+        std::vector<int> all = ranged::to<std::vector>(ranged::filter(v, even));
+        std::sort(all.begin(), all.end(), std::greater<int>());
+        all.resize(std::min(k, all.size()));
+        do_not_optimize(all.data());
+    }));
+    record("top 100", "vector", "partial_sort_copy", v.size(), measure([&] {
+        const auto filtered = ranged::filter(v, even);
+        std::vector<int> best(k);
+        best.resize(static_cast<std::size_t>(std::partial_sort_copy(filtered.begin(), filtered.end(), best.begin(), best.end(), std::greater<int>()) - best.begin()));
+        do_not_optimize(best.data());
+    }));
+    record("top 100", "vector", "top_k", v.size(), measure([&] {
+        do_not_optimize(ranged::top_k(ranged::filter(v, even), k).data());
+    }));
+    record("top 100 of all", "vector", "top_k", v.size(), measure([&] {
+        do_not_optimize(ranged::top_k(v, k).data());
+    }));
+    record("top 100 of all", "vector", "top_k par", v.size(), measure([&] {
+        do_not_optimize(ranged::top_k(ranged::execution::par, v, k).data());
+    }));
+}
+
+BENCHMARK(merge, sorted_shards) {
+    // One sorted pass over 64 sorted shards: concatenating and sorting, a hand-written k-way merge over a binary heap
+    // (`std::priority_queue`), and the loser tree, plain and deduplicating
+    const std::vector<int> v = make_input(options.max_size);
+    const std::size_t shard_count = 64;
+    std::vector<std::vector<int>> shards(shard_count);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        shards[i % shard_count].push_back(v[i]);
+    }
+    for (auto &shard: shards) {
+        std::sort(shard.begin(), shard.end());
+    }
+
+    record("64 shards", "vector", "concat+sort", v.size(), measure([&] {
+        std::vector<int> all;
+        all.reserve(v.size());
+        for (const auto &shard: shards) {
+            all.insert(all.end(), shard.begin(), shard.end());
+        }
+        std::sort(all.begin(), all.end());
+        long long sum = 0;
+        for (const int x: all) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    record("64 shards", "vector", "priority_queue", v.size(), measure([&] {
+        typedef std::pair<int, std::size_t> head;
+        std::priority_queue<head, std::vector<head>, std::greater<head>> heads;
+        std::vector<std::size_t> positions(shard_count, 0);
+        for (std::size_t shard = 0; shard < shard_count; ++shard) {
+            if (!shards[shard].empty())
+                heads.emplace(shards[shard][0], shard);
+        }
+        long long sum = 0;
+        while (!heads.empty()) {
+            const head top = heads.top();
+            heads.pop();
+            sum += top.first;
+            if (++positions[top.second] < shards[top.second].size())
+                heads.emplace(shards[top.second][positions[top.second]], top.second);
+        }
+        do_not_optimize(sum);
+    }));
+    record("64 shards", "vector", "merge", v.size(), measure([&] {
+        long long sum = 0;
+        for (const int x: ranged::merge(shards)) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    record("64 shards", "vector", "merge unique", v.size(), measure([&] {
+        long long sum = 0;
+        for (const int x: ranged::merge(ranged::unique_merge, shards)) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+}
+
+BENCHMARK(take, first_matches) {
+    // The first 10 matches of a filter: materialized then truncated, against a lazy `take` which stops at the tenth
+    const std::vector<int> v = make_input(options.max_size);
+    const auto rare = [](const int &x) { return x % 1024 == 0; };
+
+    record("first 10", "vector", "to + resize", v.size(), measure([&] {
+        auto matches = ranged::to<std::vector>(v | ranged::filter(rare));
+        matches.resize(std::min<std::size_t>(matches.size(), 10));
+        do_not_optimize(matches.size());
+    }));
+    record("first 10", "vector", "take", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::vector>(v | ranged::filter(rare) | ranged::take(10)).size());
+    }));
+    record("page", "vector", "slice", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::vector>(v | ranged::slice(v.size() / 2, v.size() / 2 + 100)).size());
+    }));
+}
+
+BENCHMARK(flatten, partitions) {
+    // Counting matches over 64 partitions: copied into one vector first, iterated element by element through the
+    // flattened view, then scanned one segment at a time
+    const std::vector<int> v = make_input(options.max_size);
+    std::vector<std::vector<int>> partitions(64);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        partitions[i * partitions.size() / v.size()].push_back(v[i]);
+    }
+    const std::vector<std::vector<int>> &parts = partitions;
+    const int pivot = static_cast<int>(v.size() / 2);
+
+    record("count_if", "vector", "copy", v.size(), measure([&] {
+        std::vector<int> all;
+        all.reserve(v.size());
+        for (const std::vector<int> &part: parts) {
+            all.insert(all.end(), part.begin(), part.end());
+        }
+        do_not_optimize(ranged::count_if(all, ranged::greater_than(pivot)));
+    }));
+    record("count_if", "vector", "flatten, per element", v.size(), measure([&] {
+        const auto all = ranged::flatten(parts);
+        do_not_optimize(std::count_if(all.begin(), all.end(), ranged::greater_than(pivot)));
+    }));
+    record("count_if", "vector", "flatten, segments", v.size(), measure([&] {
+        do_not_optimize(ranged::count_if(ranged::flatten(parts), ranged::greater_than(pivot)));
+    }));
+}
+
+BENCHMARK(sliding, rolling_max) {
+    // Rolling sum and maximum over the last 64 samples: every window rescanned, then updated incrementally
+    const std::vector<int> v = make_input(options.max_size);
+    const std::size_t window = 64;
+
+    record("rolling max", "vector", "rescan", v.size(), measure([&] {
+        int checksum = 0;
+        for (const auto samples: ranged::sliding(v, window)) {
+            checksum ^= ranged::max(samples);
+        }
+        do_not_optimize(checksum);
+    }));
+    record("rolling max", "vector", "monotonic deque", v.size(), measure([&] {
+        int checksum = 0;
+        for (const int high: ranged::sliding(v, window, ranged::agg::max())) {
+            checksum ^= high;
+        }
+        do_not_optimize(checksum);
+    }));
+    record("rolling sum", "vector", "rescan", v.size(), measure([&] {
+        long long checksum = 0;
+        for (const auto samples: ranged::sliding(v, window)) {
+            checksum += std::accumulate(samples.begin(), samples.end(), 0LL);
+        }
+        do_not_optimize(checksum);
+    }));
+    record("rolling sum", "vector", "add/subtract", v.size(), measure([&] {
+        long long checksum = 0;
+        for (const long long sum: ranged::sliding(v, window, ranged::agg::sum([](int x) { return static_cast<long long>(x); }))) {
+            checksum += sum;
+        }
+        do_not_optimize(checksum);
+    }));
+}
+
+BENCHMARK(distinct, repeated_ids) {
+    // Ids repeated 16 times on average: deduplicated through node-based sets, then lazily through the flat hash set,
+    // the adjacent mode over a sorted copy, and the Bloom filter
+    std::vector<int> v = make_input(options.max_size);
+    for (int &x: v) {
+        x %= static_cast<int>(std::max<std::size_t>(v.size() / 16, 1));
+    }
+    const std::vector<int> &ids = v;
+    std::vector<int> sorted_ids = v;
+    std::sort(sorted_ids.begin(), sorted_ids.end());
+    const std::vector<int> &sorted = sorted_ids;
+
+    record("distinct", "vector", "to<set>", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::set>(ids).size());
+    }));
+    record("distinct", "vector", "to<unordered_set>", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::unordered_set>(ids).size());
+    }));
+    record("distinct", "vector", "distinct", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::vector>(ranged::distinct(ids)).size());
+    }));
+    record("distinct", "vector", "distinct sorted", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::vector>(ranged::distinct(ranged::sorted_input, sorted)).size());
+    }));
+    record("distinct", "vector", "distinct approximate", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::vector>(ranged::distinct(ranged::approximate, ids)).size());
+    }));
+}
+
+BENCHMARK(reduce, transformed_column) {
+    // Summing a transformed column: `for_each` into a captured accumulator (one dependency chain), `std::accumulate`
+    // over the view, then `transform_reduce` with its four accumulators, sequential and parallel
+    const std::vector<int> v = make_input(options.max_size);
+    const auto scaled = [](int x) { return x * 0.5; };
+
+    record("sum", "vector", "for_each", v.size(), measure([&] {
+        double sum = 0;
+        ranged::for_each(v, [&sum, &scaled](const int &x) { sum += scaled(x); });
+        do_not_optimize(sum);
+    }));
+    record("sum", "vector", "accumulate", v.size(), measure([&] {
+        const auto column = ranged::transform(v, scaled);
+        do_not_optimize(std::accumulate(column.begin(), column.end(), 0.0));
+    }));
+    record("sum", "vector", "transform_reduce", v.size(), measure([&] {
+        do_not_optimize(ranged::transform_reduce(v, 0.0, std::plus<double>(), scaled));
+    }));
+    record("sum", "vector", "transform_reduce par", v.size(), measure([&] {
+        do_not_optimize(ranged::transform_reduce(ranged::execution::par, v, 0.0, std::plus<double>(), scaled));
+    }));
+    record("prefix sums", "vector", "partial_sum", v.size(), measure([&] {
+        std::vector<long long> result(v.size());
+        std::partial_sum(v.begin(), v.end(), result.begin(), std::plus<long long>());
+        do_not_optimize(result.data());
+    }));
+    record("prefix sums", "vector", "exclusive_scan par", v.size(), measure([&] {
+        do_not_optimize(ranged::exclusive_scan(ranged::execution::par, v, 0LL).data());
+    }));
+}
+
+BENCHMARK(pipeline, parse_stage) {
+    // A slow stage (formatting and parsing every element back) on the calling thread, then as a pipeline stage with
+    // one replica and with one per hardware thread
+    const std::vector<int> v = make_input(options.max_size);
+    const auto round_trip = [](int x) { return std::stoi(std::to_string(x)); };
+
+    record("parse", "vector", "transform", v.size(), measure([&] {
+        do_not_optimize(ranged::to<std::vector>(ranged::transform(v, round_trip)).data());
+    }));
+    record("parse", "vector", "pipeline", v.size(), measure([&] {
+        do_not_optimize(ranged::pipeline(v).transform(round_trip).to<std::vector>().data());
+    }));
+    record("parse", "vector", "pipeline replicated", v.size(), measure([&] {
+        do_not_optimize(ranged::pipeline(v).transform(round_trip, 0).to<std::vector>().data());
+    }));
+}
+
+#if RANGED_HAS_MMAP
+BENCHMARK(external_sort, filtered_ints) {
+    // Sorting a filtered range and reading it back: materialized and sorted in memory, then with a budget holding the
+    // whole input, and with one of an eighth of it (8 runs spilled to a temporary file and merged)
+    const std::vector<int> v = make_input(options.max_size);
+    const auto even = [](const int &x) { return x % 2 == 0; };
+    const auto filtered = ranged::filter(v, even);
+
+    record("sort+scan", "vector", "to+sort", v.size(), measure([&] {
+        std::vector<int> all = ranged::to<std::vector>(filtered);
+        std::sort(all.begin(), all.end());
+        long long sum = 0;
+        for (const int x: all) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+    const std::size_t bytes = v.size() * sizeof(int);
+    for (const std::size_t fraction: {1, 8}) {
+        record("sort+scan", "vector", fraction == 1 ? "external" : "external 1/8", v.size(), measure([&] {
+            long long sum = 0;
+            for (const int x: ranged::external_sort(filtered, std::less<int>(), bytes / fraction)) {
+                sum += x;
+            }
+            do_not_optimize(sum);
+        }));
+    }
+    record("sort+scan", "vector", "external 1/8 par", v.size(), measure([&] {
+        long long sum = 0;
+        for (const int x: ranged::external_sort(ranged::execution::par, filtered, std::less<int>(), bytes / 8)) {
+            sum += x;
+        }
+        do_not_optimize(sum);
+    }));
+}
+
+BENCHMARK(io, lines_vs_getline) {
+    // A log of `max_size` lines, about 40 bytes each
+    char path[] = "/tmp/ranged_bench_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        std::cerr << "Cannot create a temporary file\n";
+        return;
+    }
+    close(fd);
+    {
+        std::ofstream file(path);
+        const std::vector<int> input = make_input(options.max_size);
+        for (const int x: input) {
+            file << (x % 10 == 0 ? "ERROR" : "INFO ") << " request " << x << " served in " << x % 997 << "ms\n";
+        }
+    }
+    const auto is_error = [](const ranged::string_view &line) { return line.size() >= 5 && line.substr(0, 5) == "ERROR"; };
+
+    record("count errors", "file", "mapped lines", options.max_size, measure([&] {
+        const ranged::mapped_file file(path);
+        do_not_optimize(ranged::count_if(ranged::lines(file), is_error));
+    }));
+    record("count errors", "file", "getline", options.max_size, measure([&] {
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line)) {
+            lines.push_back(line);
+        }
+        do_not_optimize(std::count_if(lines.begin(), lines.end(), [](const std::string &l) { return l.compare(0, 5, "ERROR") == 0; }));
+    }));
+    std::remove(path);
+}
+#endif
+
+int main(int argc, char **argv) {
+    return benchmark_dispatcher::run_benchmarks(argc, argv);
+}
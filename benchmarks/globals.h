@@ -0,0 +1,240 @@
+#ifndef BENCHMARK_GLOBALS_H
+#define BENCHMARK_GLOBALS_H
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every allocation made by the process is counted, so a benchmark reports how many allocations one run performs.
+// The replacements below may only be defined once: this header is meant for the single benchmark translation unit.
+static std::atomic<std::size_t> allocation_count {0};
+
+// Neither side is inlined, or GCC would see `malloc` paired with `delete` (or `new` with `free`) and warn
+__attribute__((noinline)) void *operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc {};
+}
+void *operator new[](std::size_t size) { return ::operator new(size); }
+__attribute__((noinline)) void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { ::operator delete(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { ::operator delete(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { ::operator delete(ptr); }
+
+// Command line options, see `benchmark_dispatcher::parse`
+struct benchmark_options {
+    std::size_t min_size = 100;
+    std::size_t max_size = 1000000;
+    int repetitions = 7;
+    int warmup = 1;
+    std::string suite;
+    std::string json;
+};
+
+static benchmark_options options;
+
+// Input sizes of the container benchmarks: powers of ten from `min_size` to `max_size`
+inline std::vector<std::size_t> benchmark_sizes() {
+    std::vector<std::size_t> sizes;
+    for (std::size_t size = options.min_size; size <= options.max_size; size *= 10) {
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+// Prevents the optimizer from discarding a benchmarked result
+template<typename T>
+inline void do_not_optimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Timings of one run of a benchmarked function, in nanoseconds
+struct measurement {
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+    double stddev_ns = 0;
+    double allocations = 0;
+};
+
+// Runs `func` `warmup` times, then takes `repetitions` samples. Fast functions run several times per sample, so each
+// sample lasts at least `min_sample_ns` and the clock resolution does not matter.
+template<typename FuncT>
+measurement measure(const FuncT &func, const double min_sample_ns = 2e5) {
+    using clock = std::chrono::steady_clock;
+
+    double run_ns = 0;
+    for (int i = 0; i < std::max(options.warmup, 1); ++i) {
+        const auto start = clock::now();
+        func();
+        run_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    }
+    const std::size_t iterations = run_ns >= min_sample_ns ? 1 : static_cast<std::size_t>(min_sample_ns / std::max(run_ns, 1.0)) + 1;
+
+    std::vector<double> samples;
+    samples.reserve(static_cast<std::size_t>(std::max(options.repetitions, 1)));
+    const std::size_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < std::max(options.repetitions, 1); ++i) {
+        const auto start = clock::now();
+        for (std::size_t j = 0; j < iterations; ++j) {
+            func();
+        }
+        samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count() / static_cast<double>(iterations));
+    }
+    const std::size_t allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+
+    measurement result;
+    std::sort(samples.begin(), samples.end());
+    result.min_ns = samples.front();
+    result.median_ns = samples.size() % 2 ? samples[samples.size() / 2] : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+    for (const double sample: samples) {
+        result.mean_ns += sample / static_cast<double>(samples.size());
+    }
+    for (const double sample: samples) {
+        result.stddev_ns += (sample - result.mean_ns) * (sample - result.mean_ns) / static_cast<double>(samples.size());
+    }
+    result.stddev_ns = std::sqrt(result.stddev_ns);
+    result.allocations = static_cast<double>(allocations) / static_cast<double>(iterations * samples.size());
+    return result;
+}
+
+// Best wall-clock time of one run of `func`, in nanoseconds
+template<typename FuncT>
+double measure_ns(const FuncT &func) {
+    return measure(func).min_ns;
+}
+
+struct benchmark_record {
+    std::string suite;
+    std::string name;
+    std::string container;
+    std::string variant;
+    std::size_t elements;
+    measurement timing;
+    // Median time relative to the first variant recorded for the same suite, name, container and size
+    double relative;
+};
+
+static std::vector<benchmark_record> benchmark_records;
+static std::string current_suite;
+
+// Stores and prints one result. The first variant recorded for a given operation is the reference the following ones
+// (e.g. the raw loop or `std::ranges`) are compared against.
+inline void record(const std::string &name, const std::string &container, const std::string &variant,
+                   const std::size_t elements, const measurement &timing) {
+    double relative = 1;
+    for (const auto &other: benchmark_records) {
+        if (other.suite == current_suite && other.name == name && other.container == container && other.elements == elements) {
+            relative = timing.median_ns / other.timing.median_ns;
+            break;
+        }
+    }
+    benchmark_records.push_back(benchmark_record {current_suite, name, container, variant, elements, timing, relative});
+
+    const double per_element = timing.median_ns / static_cast<double>(std::max<std::size_t>(elements, 1));
+    std::printf("\t\t%-16s %-14s %-12s n=%-10zu %9.3f ns/element %9.1f Melements/s  +-%5.1f%%  %8.1f allocs  %5.2fx\n",
+                name.c_str(), container.c_str(), variant.c_str(), elements, per_element, 1e3 / per_element,
+                timing.median_ns > 0 ? 100 * timing.stddev_ns / timing.median_ns : 0.0, timing.allocations, relative);
+}
+
+inline void write_json(std::ostream &os) {
+    os << "[\n";
+    for (std::size_t i = 0; i < benchmark_records.size(); ++i) {
+        const auto &r = benchmark_records[i];
+        const double per_element = r.timing.median_ns / static_cast<double>(std::max<std::size_t>(r.elements, 1));
+        os << "  {\"suite\": \"" << r.suite << "\", \"name\": \"" << r.name << "\", \"container\": \"" << r.container
+           << "\", \"variant\": \"" << r.variant << "\", \"elements\": " << r.elements
+           << ", \"median_ns\": " << r.timing.median_ns << ", \"min_ns\": " << r.timing.min_ns
+           << ", \"mean_ns\": " << r.timing.mean_ns << ", \"stddev_ns\": " << r.timing.stddev_ns
+           << ", \"ns_per_element\": " << per_element << ", \"elements_per_second\": " << 1e9 / per_element
+           << ", \"allocations\": " << r.timing.allocations << ", \"relative\": " << r.relative << "}"
+           << (i + 1 < benchmark_records.size() ? ",\n" : "\n");
+    }
+    os << "]\n";
+}
+
+using BenchmarkNameT = std::pair<std::string, std::string>;
+
+static std::vector<std::pair<BenchmarkNameT, void (*)()>> benchmark_v;
+
+struct benchmark_dispatcher {
+    template <typename FuncT>
+    benchmark_dispatcher(const BenchmarkNameT& name, const FuncT &func) {
+        benchmark_v.emplace_back(name, func);
+    }
+
+    // --min-size N, --max-size N, --repetitions N, --warmup N, --suite NAME, --json FILE ("-" for stdout)
+    static bool parse(const int argc, char **argv) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+                std::cerr << "Expected `--option value`, got " << arg << "\n";
+                return false;
+            }
+            const char *value = argv[++i];
+            if (arg == "--min-size")
+                options.min_size = std::max<std::size_t>(std::strtoull(value, nullptr, 10), 1);
+            else if (arg == "--max-size")
+                options.max_size = std::strtoull(value, nullptr, 10);
+            else if (arg == "--repetitions")
+                options.repetitions = std::atoi(value);
+            else if (arg == "--warmup")
+                options.warmup = std::atoi(value);
+            else if (arg == "--suite")
+                options.suite = value;
+            else if (arg == "--json")
+                options.json = value;
+            else {
+                std::cerr << "Unknown option " << arg << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static int run_benchmarks(const int argc, char **argv) {
+        if (!parse(argc, argv))
+            return 1;
+
+        std::sort(benchmark_v.begin(), benchmark_v.end());
+        for (const auto &pair: benchmark_v) {
+            if (!options.suite.empty() && options.suite != pair.first.first)
+                continue;
+            if (current_suite != pair.first.first) {
+                std::cout << "Benchmark suite: " << pair.first.first << "\n";
+                current_suite = pair.first.first;
+            }
+            std::cout << "\t" << pair.first.second << ":\n";
+            pair.second();
+        }
+
+        if (options.json == "-") {
+            write_json(std::cout);
+        } else if (!options.json.empty()) {
+            std::ofstream file(options.json);
+            write_json(file);
+            if (!file) {
+                std::cerr << "Could not write " << options.json << "\n";
+                return 1;
+            }
+        }
+        return 0;
+    }
+};
+
+#define BENCHMARK(suite, name) \
+    void suite## _## name(); \
+    int dummy_## suite## _## name = (benchmark_dispatcher(std::make_pair(#suite, #name), &suite## _## name), 0); \
+    void suite## _## name()
+
+#endif //BENCHMARK_GLOBALS_H
@@ -5,15 +5,77 @@
 #ifndef RANGED_H
 #define RANGED_H
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#include <string_view>
+#endif
 
 #ifndef RANGED_NO_DEPRECATION_WARNINGS
 #define RANGED_NO_DEPRECATION_WARNINGS 0
 #endif
 
+// Set to 1 to store view callables as `std::function` (one erased type per signature) instead of their own type
+#ifndef RANGED_TYPE_ERASED_CALLABLES
+#define RANGED_TYPE_ERASED_CALLABLES 0
+#endif
+
+// Set to 1 to let `to<>` reserve the upper bound reported by `size_hint()` (e.g. the base size of a filter)
+#ifndef RANGED_RESERVE_SIZE_HINT
+#define RANGED_RESERVE_SIZE_HINT 0
+#endif
+
+// SIMD kernels need GCC vector extensions and x86-64 runtime dispatch; define RANGED_NO_SIMD to use scalar loops only
+#if !defined(RANGED_NO_SIMD) && defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define RANGED_SIMD 1
+#else
+#define RANGED_SIMD 0
+#endif
+
+// `mapped_file` needs POSIX `mmap`; the `lines` and `records` views work on any in-memory buffer
+#if defined(__unix__) || defined(__APPLE__)
+#define RANGED_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define RANGED_HAS_MMAP 0
+#endif
+
+// `generator` needs c++20 coroutines; nothing about it is compiled otherwise
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#define RANGED_HAS_COROUTINES 1
+#include <coroutine>
+#else
+#define RANGED_HAS_COROUTINES 0
+#endif
+
 namespace ranged {
 
 #if __cplusplus >= 202002L
@@ -25,6 +87,7 @@ namespace ranged {
         typename T::pointer;
         typename T::reference;
     };
+#define std_container _std_container_
 #else
 #define std_container class
 #endif
@@ -42,6 +105,18 @@ namespace ranged {
         return tmp;
     }
 
+    // c++14's `std::index_sequence` for c++11, see: https://en.cppreference.com/w/cpp/utility/integer_sequence.html
+    template<std::size_t... Is>
+    struct index_sequence {};
+    template<std::size_t N, std::size_t... Is>
+    struct make_index_sequence_impl : make_index_sequence_impl<N - 1, N - 1, Is...> {};
+    template<std::size_t... Is>
+    struct make_index_sequence_impl<0, Is...> {
+        using type = index_sequence<Is...>;
+    };
+    template<std::size_t N>
+    using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
     template<class T>
     struct more;
 
@@ -50,6 +125,16 @@ namespace ranged {
         constexpr bool operator()(const T &lhs, const T &rhs) const { return lhs > rhs; };
     };
 
+    // c++14's `std::less<void>` and `std::greater<void>`, comparing operands of any (possibly different) types
+    struct transparent_less {
+        template<typename T, typename U>
+        constexpr bool operator()(const T &lhs, const U &rhs) const { return lhs < rhs; }
+    };
+    struct transparent_greater {
+        template<typename T, typename U>
+        constexpr bool operator()(const T &lhs, const U &rhs) const { return rhs < lhs; }
+    };
+
     template<typename... Args>
     using void_t = void;
 
@@ -78,6 +163,24 @@ namespace ranged {
     struct sized : std::false_type {};
     template<typename T>
     struct sized<T, void_t<decltype(std::declval<T>().size())>> : std::true_type {};
+    template<typename T, typename = void>
+    struct has_size_hint : std::false_type {};
+    template<typename T>
+    struct has_size_hint<T, void_t<decltype(std::declval<T>().size_hint())>> : std::true_type {};
+    template<typename T, typename = void>
+    struct is_range : std::false_type {};
+    template<typename T>
+    struct is_range<T, void_t<decltype(std::declval<T &>().begin()), decltype(std::declval<T &>().end())>> : std::true_type {};
+    template<typename Iter>
+    using is_random_access_iterator = std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>;
+    template<bool...>
+    struct bool_pack {};
+    template<bool... Bs>
+    using all_true = std::is_same<bool_pack<true, Bs...>, bool_pack<Bs..., true>>;
+    template<typename T, template<typename...> class Template>
+    struct is_specialization_of : std::false_type {};
+    template<template<typename...> class Template, typename... Args>
+    struct is_specialization_of<Template<Args...>, Template> : std::true_type {};
 
     template<typename T>
 #if __cplusplus >= 201304L
@@ -86,8 +189,12 @@ namespace ranged {
     struct has_pair_types : has_pair_types_impl<typename std::decay<T>::type> {};
 #endif
 
+    // Empty for callables without a single signature, e.g. generic lambdas
+    template<typename T, typename = void>
+    struct function_traits {};
     template<typename T>
-    struct function_traits : function_traits<decltype(&std::decay<T>::type::operator())> {};
+    struct function_traits<T, void_t<decltype(&std::decay<T>::type::operator())>>
+        : function_traits<decltype(&std::decay<T>::type::operator())> {};
 
     template<typename ReturnT, typename... Args>
     struct function_traits<ReturnT(Args...)> {
@@ -107,8 +214,518 @@ namespace ranged {
     template<typename T>
     using function_traits_rt = typename function_traits<T>::return_type;
 
+    // A generic predicate has no return type until it is called, so any class passes and is checked on its first call
+    template<typename Pred, typename = void>
+    struct is_bool_predicate : std::is_class<Pred> {};
+    template<typename Pred>
+    struct is_bool_predicate<Pred, void_t<function_traits_rt<Pred>>> : std::is_same<function_traits_rt<Pred>, bool> {};
+
+    // Weakest category of the given iterators, capped at random access since views never yield contiguous storage
+    template<typename... Iters>
+    using common_iterator_category = typename std::common_type<
+        std::random_access_iterator_tag, typename std::iterator_traits<Iters>::iterator_category...>::type;
+
+#if RANGED_TYPE_ERASED_CALLABLES
     template<typename Pred>
-    using is_bool_predicate = std::is_same<function_traits_rt<Pred>, bool>;
+    using callable_t = std::function<function_traits_s<Pred>>;
+#else
+    template<typename Pred>
+    using callable_t = typename std::decay<Pred>::type;
+#endif
+
+    template<typename T>
+#if __cplusplus >= 201402L
+    struct is_final_class : std::is_final<T> {};
+#else
+    struct is_final_class : std::integral_constant<bool, __is_final(T)> {};
+#endif
+
+    // Stateless callables are kept as an empty base, so they add nothing to the size of a view or iterator
+    template<typename F, bool = std::is_empty<F>::value && !is_final_class<F>::value>
+    class callable_storage : private F {
+    public:
+        callable_storage() = default;
+        constexpr explicit callable_storage(const F &f) noexcept(std::is_nothrow_copy_constructible<F>::value) : F(f) {}
+
+        constexpr const F &get() const noexcept { return *this; }
+        F &get() noexcept { return *this; }
+    };
+    template<typename F>
+    class callable_storage<F, false> {
+    public:
+        callable_storage() = default;
+        constexpr explicit callable_storage(const F &f) noexcept(std::is_nothrow_copy_constructible<F>::value) : f_(f) {}
+
+        constexpr const F &get() const noexcept { return f_; }
+        F &get() noexcept { return f_; }
+
+    private:
+        F f_;
+    };
+
+    // Closures are not copy assignable (before c++20), but iterators must be. A closure with state is constructed in
+    // place into raw storage, and assigning destroys it and constructs the copy in its place.
+    template<typename F>
+    class reconstructible_storage {
+    public:
+        explicit reconstructible_storage(const F &f) noexcept(std::is_nothrow_copy_constructible<F>::value) {
+            ::new (static_cast<void *>(storage_)) F(f);
+        }
+        reconstructible_storage(const reconstructible_storage &other) noexcept(std::is_nothrow_copy_constructible<F>::value) {
+            ::new (static_cast<void *>(storage_)) F(other.get());
+        }
+        reconstructible_storage &operator=(const reconstructible_storage &other) noexcept(std::is_nothrow_copy_constructible<F>::value) {
+            if (&other != this) {
+                get().~F();
+                ::new (static_cast<void *>(storage_)) F(other.get());
+            }
+            return *this;
+        }
+        ~reconstructible_storage() { get().~F(); }
+
+#if __cpp_lib_launder >= 201606L
+        const F &get() const noexcept { return *std::launder(reinterpret_cast<const F *>(storage_)); }
+        F &get() noexcept { return *std::launder(reinterpret_cast<F *>(storage_)); }
+#else
+        const F &get() const noexcept { return *reinterpret_cast<const F *>(storage_); }
+        F &get() noexcept { return *reinterpret_cast<F *>(storage_); }
+#endif
+
+    private:
+        alignas(F) unsigned char storage_[sizeof(F)];
+    };
+
+    // `Tag` only tells apart boxes of the same callable, see `indexed_callable`
+    template<typename F, typename Tag = void, bool = std::is_copy_assignable<F>::value, bool = std::is_empty<F>::value>
+    class callable_box : public callable_storage<F> {
+    public:
+        callable_box() = default;
+        constexpr explicit callable_box(const F &f) noexcept(std::is_nothrow_copy_constructible<F>::value) : callable_storage<F>(f) {}
+    };
+    template<typename F, typename Tag>
+    class callable_box<F, Tag, false, false> : public reconstructible_storage<F> {
+    public:
+        explicit callable_box(const F &f) noexcept(std::is_nothrow_copy_constructible<F>::value) : reconstructible_storage<F>(f) {}
+    };
+    // An empty closure has no state to copy, so it is kept as an empty base that assigning leaves as is
+    template<typename F, typename Tag>
+    class callable_box<F, Tag, false, true> : public callable_storage<F> {
+    public:
+        callable_box() = default;
+        constexpr explicit callable_box(const F &f) noexcept(std::is_nothrow_copy_constructible<F>::value) : callable_storage<F>(f) {}
+
+        callable_box(const callable_box &) = default;
+        callable_box &operator=(const callable_box &) noexcept { return *this; }
+    };
+
+    // A `callable_box` told apart by its position `I`, so that a class can derive from two boxes of the same callable.
+    // Being another type than `callable_box<F>`, it is never mistaken for the box of a view holding the whole class.
+    template<std::size_t I, typename F>
+    using indexed_callable = callable_box<F, std::integral_constant<std::size_t, I>>;
+
+    // Adjacent filters fused by `operator|`: one predicate testing both conditions. Both are boxed as bases, so stateless
+    // predicates add nothing to its size. Generic predicates are fused too, the call operator being a template.
+    template<typename First, typename Second>
+    class fused_predicate : private indexed_callable<0, First>, private indexed_callable<1, Second> {
+    public:
+        fused_predicate(const First &first, const Second &second) : indexed_callable<0, First>(first), indexed_callable<1, Second>(second) {}
+
+        template<typename Arg>
+        bool operator()(Arg &&item) const { return first()(item) && second()(item); }
+
+    private:
+        const First &first() const noexcept { return static_cast<const indexed_callable<0, First> &>(*this).get(); }
+        const Second &second() const noexcept { return static_cast<const indexed_callable<1, Second> &>(*this).get(); }
+    };
+
+    // Adjacent transforms fused by `operator|`: `second(first(item))`
+    template<typename First, typename Second>
+    class composed_function : private indexed_callable<0, First>, private indexed_callable<1, Second> {
+    public:
+        composed_function(const First &first, const Second &second) : indexed_callable<0, First>(first), indexed_callable<1, Second>(second) {}
+
+        template<typename Arg>
+        auto operator()(Arg &&item) const -> decltype(std::declval<const Second &>()(std::declval<const First &>()(std::forward<Arg>(item)))) {
+            return second()(first()(std::forward<Arg>(item)));
+        }
+
+    private:
+        const First &first() const noexcept { return static_cast<const indexed_callable<0, First> &>(*this).get(); }
+        const Second &second() const noexcept { return static_cast<const indexed_callable<1, Second> &>(*this).get(); }
+    };
+
+    // A fusion takes the argument of `First`, when it has one signature, e.g. for `callable_t` to type-erase it
+    template<typename First, typename Second, typename = function_traits_s<First>>
+    struct fusion_signatures;
+    template<typename First, typename Second, typename ReturnT, typename Arg>
+    struct fusion_signatures<First, Second, ReturnT(Arg)> {
+        using predicate = bool(Arg);
+        using composition = typename std::result_of<const Second &(ReturnT)>::type(Arg);
+    };
+    template<typename First, typename Second>
+    struct function_traits<fused_predicate<First, Second>, void_t<function_traits_s<First>>>
+        : function_traits<typename fusion_signatures<First, Second>::predicate> {};
+    template<typename First, typename Second>
+    struct function_traits<composed_function<First, Second>, void_t<function_traits_s<First>>>
+        : function_traits<typename fusion_signatures<First, Second>::composition> {};
+
+    // Non-owning view over contiguous elements, e.g. a raw buffer or a part of a vector
+    template<typename T>
+    class span {
+    public:
+        using element_type = T;
+        using value_type = typename std::remove_cv<T>::type;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *;
+        using reference = T &;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        constexpr span() noexcept : data_(nullptr), size_(0) {}
+        constexpr span(T *data, size_type size) noexcept : data_(data), size_(size) {}
+        constexpr span(T *first, T *last) noexcept : data_(first), size_(static_cast<size_type>(last - first)) {}
+        template<std::size_t N>
+        constexpr span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+        template<typename Container, typename = typename std::enable_if<
+            std::is_convertible<decltype(std::declval<Container &>().data()), T *>::value>::type>
+        constexpr span(Container &container) noexcept(noexcept(container.data())) : data_(container.data()), size_(container.size()) {}
+        // `span<const T>` from `span<T>`
+        template<typename U, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+        constexpr span(const span<U> &other) noexcept : data_(other.data()), size_(other.size()) {}
+
+        constexpr pointer data() const noexcept { return data_; }
+        constexpr size_type size() const noexcept { return size_; }
+        constexpr bool empty() const noexcept { return size_ == 0; }
+
+        constexpr iterator begin() const noexcept { return data_; }
+        constexpr iterator end() const noexcept { return data_ + size_; }
+
+        constexpr reference operator[](size_type i) const noexcept { return data_[i]; }
+        constexpr reference front() const noexcept { return data_[0]; }
+        constexpr reference back() const noexcept { return data_[size_ - 1]; }
+
+        constexpr span subspan(size_type offset, size_type count) const noexcept { return span(data_ + offset, count); }
+
+    private:
+        T *data_;
+        size_type size_;
+    };
+
+#if __cplusplus >= 201703L
+    using string_view = std::string_view;
+#else
+    // Read-only subset of c++17's `std::string_view`, e.g. the lines yielded by `lines`
+    class string_view {
+    public:
+        using value_type = char;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char *;
+        using reference = const char &;
+        using const_reference = const char &;
+        using iterator = const char *;
+        using const_iterator = const char *;
+
+        constexpr string_view() noexcept : data_(nullptr), size_(0) {}
+        constexpr string_view(const char *data, size_type size) noexcept : data_(data), size_(size) {}
+        string_view(const char *str) noexcept : data_(str), size_(std::strlen(str)) {}
+        string_view(const std::string &str) noexcept : data_(str.data()), size_(str.size()) {}
+
+        constexpr pointer data() const noexcept { return data_; }
+        constexpr size_type size() const noexcept { return size_; }
+        constexpr size_type length() const noexcept { return size_; }
+        constexpr bool empty() const noexcept { return size_ == 0; }
+
+        constexpr iterator begin() const noexcept { return data_; }
+        constexpr iterator end() const noexcept { return data_ + size_; }
+
+        constexpr reference operator[](size_type i) const noexcept { return data_[i]; }
+        constexpr reference front() const noexcept { return data_[0]; }
+        constexpr reference back() const noexcept { return data_[size_ - 1]; }
+
+        void remove_prefix(size_type n) noexcept {
+            data_ += n;
+            size_ -= n;
+        }
+        void remove_suffix(size_type n) noexcept { size_ -= n; }
+
+        string_view substr(size_type pos, size_type count = std::numeric_limits<size_type>::max()) const {
+            if (pos > size_)
+                throw std::out_of_range("string_view::substr");
+            return string_view(data_ + pos, std::min(count, size_ - pos));
+        }
+
+        int compare(string_view other) const noexcept {
+            const int result = other.size_ == 0 || size_ == 0 ? 0 : std::memcmp(data_, other.data_, std::min(size_, other.size_));
+            return result != 0 ? result : (size_ < other.size_ ? -1 : size_ > other.size_);
+        }
+
+        explicit operator std::string() const { return std::string(data_, size_); }
+
+        friend bool operator==(string_view lhs, string_view rhs) noexcept { return lhs.size_ == rhs.size_ && lhs.compare(rhs) == 0; }
+        friend bool operator!=(string_view lhs, string_view rhs) noexcept { return !(lhs == rhs); }
+        friend bool operator<(string_view lhs, string_view rhs) noexcept { return lhs.compare(rhs) < 0; }
+        friend bool operator>(string_view lhs, string_view rhs) noexcept { return rhs < lhs; }
+        friend bool operator<=(string_view lhs, string_view rhs) noexcept { return !(rhs < lhs); }
+        friend bool operator>=(string_view lhs, string_view rhs) noexcept { return !(lhs < rhs); }
+
+    private:
+        const char *data_;
+        size_type size_;
+    };
+#endif
+
+    // Predicate comparing elements against a fixed value. Unlike an equivalent lambda, `count_if` recognizes it and
+    // counts contiguous arithmetic ranges with SIMD kernels.
+    template<typename T, typename Compare>
+    struct threshold {
+        T value;
+
+        constexpr bool operator()(const T &item) const { return Compare {}(item, value); }
+    };
+    template<typename T>
+    constexpr threshold<T, std::greater<T>> greater_than(const T &value) { return threshold<T, std::greater<T>> {value}; }
+    template<typename T>
+    constexpr threshold<T, std::less<T>> less_than(const T &value) { return threshold<T, std::less<T>> {value}; }
+    template<typename T>
+    constexpr threshold<T, std::equal_to<T>> equal_to(const T &value) { return threshold<T, std::equal_to<T>> {value}; }
+
+    namespace simd {
+        template<typename T>
+        using is_vectorizable = std::integral_constant<bool,
+            std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, long double>::value>;
+
+#if RANGED_SIMD
+        // Kernels are written once with GCC vector extensions and inlined into per-ISA entry points, which pick the
+        // vector width (16, 32 or 64 bytes: 2 to 64 lanes) and let the compiler emit SSE2, AVX2 or AVX-512 code.
+#define RANGED_SIMD_INLINE inline __attribute__((always_inline))
+
+        template<bool Greatest, std::size_t Bytes, typename T>
+        RANGED_SIMD_INLINE T extremum(const T *data, std::size_t size) {
+            typedef T vec __attribute__((vector_size(Bytes)));
+            constexpr std::size_t lanes = Bytes / sizeof(T);
+
+            T result = data[0];
+            std::size_t i{0};
+            if (size >= 2 * lanes) {
+                vec a, b;
+                std::memcpy(&a, data, Bytes);
+                std::memcpy(&b, data + lanes, Bytes);
+                for (i = 2 * lanes; i + 2 * lanes <= size; i += 2 * lanes) {
+                    vec x, y;
+                    std::memcpy(&x, data + i, Bytes);
+                    std::memcpy(&y, data + i + lanes, Bytes);
+                    a = (Greatest ? a < x : x < a) ? x : a;
+                    b = (Greatest ? b < y : y < b) ? y : b;
+                }
+                a = (Greatest ? a < b : b < a) ? b : a;
+                result = a[0];
+                for (std::size_t lane{1}; lane < lanes; ++lane) {
+                    if (Greatest ? result < a[lane] : a[lane] < result)
+                        result = a[lane];
+                }
+            }
+            for (; i < size; ++i) {
+                if (Greatest ? result < data[i] : data[i] < result)
+                    result = data[i];
+            }
+
+            return result;
+        }
+
+        enum class comparison { greater, less, equal };
+
+        template<comparison Cmp, std::size_t Bytes, typename T>
+        RANGED_SIMD_INLINE std::size_t count(const T *data, std::size_t size, T value) {
+            typedef T vec __attribute__((vector_size(Bytes)));
+            typedef decltype(vec {} < vec {}) mask;
+            constexpr std::size_t lanes = Bytes / sizeof(T);
+            // Lane counters are as wide as the elements, so they are flushed before an 8-bit lane could overflow
+            constexpr std::size_t block = 64 * lanes;
+
+            vec bound;
+            for (std::size_t lane{0}; lane < lanes; ++lane) {
+                bound[lane] = value;
+            }
+
+            std::size_t result{0};
+            std::size_t i{0};
+            while (i + lanes <= size) {
+                mask counts {};
+                const std::size_t block_end = size - i > block ? i + block : size;
+                for (; i + lanes <= block_end; i += lanes) {
+                    vec x;
+                    std::memcpy(&x, data + i, Bytes);
+                    counts -= Cmp == comparison::greater ? x > bound : Cmp == comparison::less ? x < bound : x == bound;
+                }
+                for (std::size_t lane{0}; lane < lanes; ++lane) {
+                    result += static_cast<std::size_t>(counts[lane]);
+                }
+            }
+            for (; i < size; ++i) {
+                result += Cmp == comparison::greater ? data[i] > value : Cmp == comparison::less ? data[i] < value : data[i] == value;
+            }
+
+            return result;
+        }
+
+        template<std::size_t Bytes, typename T>
+        RANGED_SIMD_INLINE bool contains(const T *data, std::size_t size, T value) {
+            typedef T vec __attribute__((vector_size(Bytes)));
+            typedef decltype(vec {} < vec {}) mask;
+            constexpr std::size_t lanes = Bytes / sizeof(T);
+
+            vec needle;
+            for (std::size_t lane{0}; lane < lanes; ++lane) {
+                needle[lane] = value;
+            }
+
+            std::size_t i{0};
+            for (; i + 4 * lanes <= size; i += 4 * lanes) {
+                vec a, b, c, d;
+                std::memcpy(&a, data + i, Bytes);
+                std::memcpy(&b, data + i + lanes, Bytes);
+                std::memcpy(&c, data + i + 2 * lanes, Bytes);
+                std::memcpy(&d, data + i + 3 * lanes, Bytes);
+                // Accumulated rather than OR-ed: GCC scalarizes OR-ed comparison masks for AVX-512
+                mask hits {};
+                hits -= a == needle;
+                hits -= b == needle;
+                hits -= c == needle;
+                hits -= d == needle;
+                unsigned long long words[Bytes / sizeof(unsigned long long)];
+                std::memcpy(words, &hits, Bytes);
+                unsigned long long any{0};
+                for (const unsigned long long word: words) {
+                    any |= word;
+                }
+                if (any)
+                    return true;
+            }
+            for (; i < size; ++i) {
+                if (data[i] == value)
+                    return true;
+            }
+
+            return false;
+        }
+
+        template<bool Greatest>
+        struct extremum_kernel {
+            template<std::size_t Bytes, typename T>
+            static RANGED_SIMD_INLINE T run(const T *data, std::size_t size) { return extremum<Greatest, Bytes>(data, size); }
+        };
+        template<comparison Cmp>
+        struct count_kernel {
+            template<std::size_t Bytes, typename T>
+            static RANGED_SIMD_INLINE std::size_t run(const T *data, std::size_t size, T value) { return count<Cmp, Bytes>(data, size, value); }
+        };
+        struct contains_kernel {
+            template<std::size_t Bytes, typename T>
+            static RANGED_SIMD_INLINE bool run(const T *data, std::size_t size, T value) { return contains<Bytes>(data, size, value); }
+        };
+
+        template<typename Kernel, typename R, typename... Args>
+        R run_sse2(Args... args) { return Kernel::template run<16>(args...); }
+        template<typename Kernel, typename R, typename... Args>
+        __attribute__((target("avx2"))) R run_avx2(Args... args) { return Kernel::template run<32>(args...); }
+        template<typename Kernel, typename R, typename... Args>
+        __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl"))) R run_avx512(Args... args) { return Kernel::template run<64>(args...); }
+
+        enum class isa { sse2, avx2, avx512 };
+
+        // Widest instruction set of the running CPU, detected once
+        inline isa detected_isa() noexcept {
+            static const isa detected = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+                  __builtin_cpu_supports("avx512vl")
+                ? isa::avx512
+                : __builtin_cpu_supports("avx2") ? isa::avx2 : isa::sse2;
+            return detected;
+        }
+
+        template<typename Kernel, typename R, typename... Args>
+        R dispatch(Args... args) {
+            switch (detected_isa()) {
+                case isa::avx512:
+                    return run_avx512<Kernel, R>(args...);
+                case isa::avx2:
+                    return run_avx2<Kernel, R>(args...);
+                default:
+                    return run_sse2<Kernel, R>(args...);
+            }
+        }
+
+        // `size` must not be 0
+        template<typename T>
+        T max(const T *data, std::size_t size) { return dispatch<extremum_kernel<true>, T>(data, size); }
+        template<typename T>
+        T min(const T *data, std::size_t size) { return dispatch<extremum_kernel<false>, T>(data, size); }
+        template<comparison Cmp, typename T>
+        std::size_t count(const T *data, std::size_t size, T value) { return dispatch<count_kernel<Cmp>, std::size_t>(data, size, value); }
+        template<typename T>
+        bool contains(const T *data, std::size_t size, T value) { return dispatch<contains_kernel, bool>(data, size, value); }
+
+#undef RANGED_SIMD_INLINE
+#endif
+
+        template<typename Compare>
+        struct comparison_of;
+#if RANGED_SIMD
+        template<typename T>
+        struct comparison_of<std::greater<T>> : std::integral_constant<comparison, comparison::greater> {};
+        template<typename T>
+        struct comparison_of<std::less<T>> : std::integral_constant<comparison, comparison::less> {};
+        template<typename T>
+        struct comparison_of<std::equal_to<T>> : std::integral_constant<comparison, comparison::equal> {};
+#endif
+    } // namespace simd
+
+    // Ranges storing their elements back to back, reachable through `data()`
+    template<typename T, typename = void>
+    struct is_contiguous_range : std::false_type {};
+    template<typename T>
+    struct is_contiguous_range<T, void_t<decltype(std::declval<T &>().data()), decltype(std::declval<T &>().size())>> : std::is_same<
+        typename std::remove_cv<typename std::remove_pointer<decltype(std::declval<T &>().data())>::type>::type,
+        typename T::value_type> {};
+
+    // Bit scanning helpers of the selection bitmasks
+#if defined(__GNUC__)
+    inline unsigned count_trailing_zeros(std::uint64_t word) noexcept { return static_cast<unsigned>(__builtin_ctzll(word)); }
+    inline unsigned popcount(std::uint64_t word) noexcept { return static_cast<unsigned>(__builtin_popcountll(word)); }
+#else
+    inline unsigned count_trailing_zeros(std::uint64_t word) noexcept {
+        unsigned zeros = 0;
+        for (; (word & 1) == 0; word >>= 1) {
+            ++zeros;
+        }
+        return zeros;
+    }
+    inline unsigned popcount(std::uint64_t word) noexcept {
+        unsigned count = 0;
+        for (; word != 0; word &= word - 1) {
+            ++count;
+        }
+        return count;
+    }
+#endif
+
+    // Contiguous containers of arithmetic values, which `min`, `max`, `contains` and `count_if` scan with SIMD kernels
+    template<typename T, typename = void>
+    struct is_simd_range : std::false_type {};
+    template<typename T>
+    struct is_simd_range<T, void_t<decltype(std::declval<T &>().data()), decltype(std::declval<T &>().size())>> : std::integral_constant<bool,
+        RANGED_SIMD && simd::is_vectorizable<typename T::value_type>::value && is_contiguous_range<T>::value> {};
+
+    // Ranges made of contiguous segments, listed as spans by `segments()` (e.g. `concat` and `flatten` of vectors).
+    // `min`, `max`, `contains` and `count_if` run their contiguous (SIMD) loop over each segment in turn.
+    template<typename T, typename = void>
+    struct is_segmented : std::false_type {};
+    template<typename T>
+    struct is_segmented<T, void_t<decltype(std::declval<T &>().segments())>> : std::true_type {};
+    struct segmented_scan {};
+    template<typename T, typename Otherwise>
+    using segmented_or = typename std::conditional<is_segmented<const T>::value, segmented_scan, Otherwise>::type;
 
     namespace views {
         template<typename R>
@@ -116,7 +733,6 @@ namespace ranged {
         public:
             static_assert(std::is_object<R>::value, "Template parameter `R` must be an object type");
             static_assert(std::is_move_constructible<R>::value, "Template parameter `R` must be move constructible");
-            static_assert(std::is_default_constructible<R>::value, "Template parameter `R` must be default constructible");
 
             using iterator = typename std::decay<R>::type::iterator;
             using const_iterator = typename std::decay<R>::type::const_iterator;
@@ -124,17 +740,18 @@ namespace ranged {
 
             owning_view() noexcept : _r() {};
             ~owning_view() = default;
-            owning_view(owning_view&& other) noexcept : _r(exchange(other._r, R {})) {};
+            owning_view(owning_view&& other) noexcept : _r(std::move(other._r)) {};
             owning_view& operator=(owning_view&& other) = default;
 
             owning_view(const owning_view&) = delete;
             owning_view& operator=(const owning_view&) = delete;
 
-            explicit owning_view(R&& t) noexcept: _r {exchange(t, R {})} {}
+            explicit owning_view(R&& t) noexcept: _r(std::move(t)) {}
 
             R &base() & noexcept { return _r; }
             constexpr const R &base() const & noexcept { return this->_r; }
-            constexpr R &&base() && noexcept { return std::move(_r); }
+            // Not constexpr: that would make it a const member function in c++11
+            R &&base() && noexcept { return std::move(_r); }
 
             iterator begin() noexcept { return _r.begin(); }
             iterator end() noexcept { return _r.end(); }
@@ -148,23 +765,28 @@ namespace ranged {
             size_type size() noexcept (
                 sized<R>::value
             ) {
-                return std::distance(std::move(this->_r.begin()), std::move(this->_r.end()));
+                return size_of(this->_r, sized<R> {});
             }
             constexpr size_type size() const noexcept (
                 sized<R>::value
             ) {
-                return std::distance(std::move(this->_r.begin()), std::move(this->_r.end()));
+                return size_of(this->_r, sized<R> {});
             }
 
         protected:
             R _r;
+
+        private:
+            static constexpr size_type size_of(const R &r, std::true_type) noexcept { return r.size(); }
+            static size_type size_of(const R &r, std::false_type) { return std::distance(r.begin(), r.end()); }
         };
         template<typename R>
         class ref_view {
         public:
             static_assert(std::is_object<R>::value, "Template parameter `R` must be an object type");
 
-            using iterator = typename std::decay<R>::type::iterator;
+            // The const iterator when `R` is const
+            using iterator = decltype(std::declval<R &>().begin());
             using const_iterator = typename std::decay<R>::type::const_iterator;
             using size_type = typename std::decay<R>::type::size_type;
 
@@ -173,7 +795,7 @@ namespace ranged {
             template<typename T>
             constexpr explicit ref_view(T& t) noexcept(
                 std::is_convertible<T, R&>::value
-                ) : _r(std::addressof(static_cast<R&>(std::forward<T>(t)))) {}
+                ) : _r(std::addressof(static_cast<R&>(t))) {}
 
             constexpr explicit ref_view(R* t) noexcept : _r(t) {}
 
@@ -203,7 +825,8 @@ namespace ranged {
                 return _r->empty();
             }
 
-            size_type size() const noexcept {
+            template<typename T = R>
+            typename std::enable_if<sized<const T>::value, size_type>::type size() const noexcept {
                 assert(_r != nullptr);
                 return _r->size();
             }
@@ -213,68 +836,29 @@ namespace ranged {
         };
 
         template<typename Iter, typename Pred>
-        class filter_iterator {
+        class filter_iterator : private callable_box<callable_t<Pred>> {
         public:
 #if __cplusplus >= 201304L
             using base_iterator = std::decay_t<Iter>;
 #else
             using base_iterator = typename std::decay<Iter>::type;
 #endif
-            using iterator_category = std::forward_iterator_tag;
+            using iterator_category = typename std::common_type<std::forward_iterator_tag, typename std::iterator_traits<base_iterator>::iterator_category>::type;
             using value_type = typename std::iterator_traits<base_iterator>::value_type;
             using difference_type = typename std::iterator_traits<base_iterator>::difference_type;
             using pointer = typename std::iterator_traits<base_iterator>::pointer;
             using reference = typename std::iterator_traits<base_iterator>::reference;
-            using function_type = std::function<function_traits_s<Pred>>;
+            using function_type = callable_t<Pred>;
 
             filter_iterator() = default;
 
-            filter_iterator(const filter_iterator &other) noexcept(
-                std::is_nothrow_copy_constructible<base_iterator>::value
-                ): current_(other.current_), end_(other.end_), pred_(other.pred_) {}
-            filter_iterator& operator=(const filter_iterator &other) noexcept(
-                std::is_nothrow_copy_assignable<base_iterator>::value) {
-                if (&other != this) {
-                    current_ = other.current_;
-                    end_ = other.end_;
-                    pred_ = other.pred_;
-                }
-
-                return *this;
-            };
-
-            filter_iterator(filter_iterator &&rhs) noexcept(
-                std::is_nothrow_move_constructible<base_iterator>::value &&
-                std::is_default_constructible<base_iterator>::value
-                ):
-#if __cplusplus >= 201304L
-            current_(std::exchange(rhs.current_, base_iterator {})), end_(std::exchange(rhs.end_, base_iterator {})), pred_(std::exchange(rhs.pred_, function_type {})) {}
-#else
-            current_(exchange(rhs.current_, base_iterator {})), end_(exchange(rhs.end_, base_iterator {})), pred_(exchange(rhs.pred_, function_type {})) {}
-#endif
-
-            filter_iterator &operator=(filter_iterator &&rhs) noexcept(
-                std::is_nothrow_move_assignable<base_iterator>::value &&
-                std::is_default_constructible<base_iterator>::value
-                )
-            {
-                if (&rhs != this) {
-#if __cplusplus >= 201304L
-                    current_ = std::exchange(rhs.current_, base_iterator {});
-                    end_ = std::exchange(rhs.end_, base_iterator {});
-                    pred_ = std::exchange(rhs.pred_, function_type {});
-#else
-                    current_ = exchange(rhs.current_, base_iterator {});
-                    end_ = exchange(rhs.end_, base_iterator {});
-                    pred_ = exchange(rhs.pred_, function_type {});
-#endif
-                }
-
-                return *this;
-            }
+            filter_iterator(const filter_iterator &) = default;
+            filter_iterator& operator=(const filter_iterator &) = default;
+            filter_iterator(filter_iterator &&) = default;
+            filter_iterator &operator=(filter_iterator &&) = default;
 
             filter_iterator(base_iterator begin, base_iterator end, const function_type &pred) noexcept :
-            current_(begin), end_(end), pred_(pred) {
+            callable_box<function_type>(pred), current_(begin), end_(end) {
                 satisfy();
             }
 
@@ -303,18 +887,17 @@ namespace ranged {
 
         private:
             void satisfy() {
-                while (current_ != end_ && !pred_(*current_)) {
+                while (current_ != end_ && !this->get()(*current_)) {
                     ++current_;
                 }
             }
 
             base_iterator current_;
             base_iterator end_;
-            function_type pred_;
         };
 
         template<typename Range, typename Pred>
-        class filter_view : public owning_view<Range> {
+        class filter_view : public owning_view<Range>, private callable_box<callable_t<Pred>> {
         public:
             using range_iterator_type = typename std::decay<Range>::type::iterator;
             using range_const_iterator_type = typename std::decay<Range>::type::const_iterator;
@@ -324,18 +907,18 @@ namespace ranged {
             using difference_type = typename std::iterator_traits<iterator>::difference_type;
             using pointer = typename std::iterator_traits<iterator>::pointer;
             using reference = typename std::iterator_traits<iterator>::reference;
-            using function_type = std::function<function_traits_s<Pred>>;
+            using function_type = callable_t<Pred>;
 
-            filter_view() noexcept: owning_view<Range>(), _pred() {};
+            filter_view() noexcept: owning_view<Range>(), callable_box<function_type>() {};
 
-            filter_view(Range&& range, const Pred &pred) noexcept : owning_view<Range>(std::forward<Range>(range)), _pred(pred) {}
-            filter_view(Range& range, const Pred &pred) noexcept : owning_view<Range>(std::move(range)), _pred(pred) {}
+            filter_view(Range&& range, const Pred &pred) noexcept : owning_view<Range>(std::forward<Range>(range)), callable_box<function_type>(pred) {}
+            filter_view(Range& range, const Pred &pred) noexcept : owning_view<Range>(std::move(range)), callable_box<function_type>(pred) {}
 
-            filter_view(filter_view &&other) noexcept : owning_view<Range>(exchange(other._r, Range {})), _pred(exchange(other._pred, function_type {})) {}
+            filter_view(filter_view &&other) noexcept : owning_view<Range>(std::move(other)), callable_box<function_type>(other) {}
             filter_view &operator=(filter_view &&other) noexcept {
                 if (&other != this) {
-                    this->_r = exchange(other._r, Range {});
-                    this->_pred = exchange(other._pred, function_type {});
+                    owning_view<Range>::operator=(std::move(other));
+                    callable_box<function_type>::operator=(other);
                 }
 
                 return *this;
@@ -344,19 +927,25 @@ namespace ranged {
             filter_view(filter_view &) = delete;
             filter_view &operator=(filter_view &) = delete;
 
-            iterator begin() noexcept { return iterator{this->_r.begin(), this->_r.end(), _pred}; }
-            iterator end() noexcept { return iterator{this->_r.end(), this->_r.end(), _pred}; }
+            iterator begin() noexcept { return iterator{this->_r.begin(), this->_r.end(), this->get()}; }
+            iterator end() noexcept { return iterator{this->_r.end(), this->_r.end(), this->get()}; }
 
-            constexpr const_iterator begin() const noexcept { return const_iterator{this->_r.begin(), this->_r.end(), _pred}; }
-            constexpr const_iterator end() const noexcept { return const_iterator{this->_r.end(), this->_r.end(), _pred}; }
+            constexpr const_iterator begin() const noexcept { return const_iterator{this->_r.begin(), this->_r.end(), this->get()}; }
+            constexpr const_iterator end() const noexcept { return const_iterator{this->_r.end(), this->_r.end(), this->get()}; }
 
-        private:
-            function_type _pred;
+            constexpr const function_type &predicate() const noexcept { return this->get(); }
+
+            // The number of matching elements is unknown until the view is traversed
+            typename owning_view<Range>::size_type size() const = delete;
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, typename owning_view<Range>::size_type>::type size_hint() const noexcept {
+                return owning_view<Range>::size();
+            }
         };
         template<typename Range, typename Pred>
-        class filter_ref_view : public ref_view<Range> {
+        class filter_ref_view : public ref_view<Range>, private callable_box<callable_t<Pred>> {
             public:
-            using range_iterator_type = typename std::decay<Range>::type::iterator;
+            using range_iterator_type = typename ref_view<Range>::iterator;
             using range_const_iterator_type = typename std::decay<Range>::type::const_iterator;
             using iterator = filter_iterator<range_iterator_type, Pred>;
             using const_iterator = filter_iterator<range_const_iterator_type, Pred>;
@@ -364,52 +953,61 @@ namespace ranged {
             using difference_type = typename std::iterator_traits<iterator>::difference_type;
             using pointer = typename std::iterator_traits<iterator>::pointer;
             using reference = typename std::iterator_traits<iterator>::reference;
-            using function_type = std::function<function_traits_s<Pred>>;
+            using function_type = callable_t<Pred>;
 
-            filter_ref_view() noexcept: ref_view<Range>(), _pred() {}
-            filter_ref_view(Range&& range, const Pred &pred) noexcept : ref_view<Range>(std::forward<Range>(range)), _pred(pred) {}
-            filter_ref_view(Range& range, const Pred &pred) noexcept : ref_view<Range>(std::move(range)), _pred(pred) {}
+            filter_ref_view() noexcept: ref_view<Range>(), callable_box<function_type>() {}
+            filter_ref_view(Range&& range, const Pred &pred) noexcept : ref_view<Range>(std::forward<Range>(range)), callable_box<function_type>(pred) {}
+            filter_ref_view(Range& range, const Pred &pred) noexcept : ref_view<Range>(range), callable_box<function_type>(pred) {}
 
-            filter_ref_view(filter_ref_view &&other) noexcept : ref_view<Range>(exchange(other._r, nullptr)), _pred(exchange(other._pred, function_type {})) {}
+            filter_ref_view(filter_ref_view &&other) noexcept : ref_view<Range>(ranged::exchange(other._r, nullptr)), callable_box<function_type>(other) {}
             filter_ref_view &operator=(filter_ref_view &&other) noexcept {
                 if (&other != this) {
-                    this->_r = exchange(other._r, nullptr);
-                    this->_pred = exchange(other._pred, function_type {});
+                    this->_r = ranged::exchange(other._r, nullptr);
+                    callable_box<function_type>::operator=(other);
                 }
 
                 return *this;
             }
 
-            filter_ref_view(filter_ref_view &other) noexcept : ref_view<Range>(other._r), _pred(other._pred) {};
+            filter_ref_view(filter_ref_view &other) noexcept : ref_view<Range>(other._r), callable_box<function_type>(other) {};
             filter_ref_view &operator=(filter_ref_view &other) noexcept {
                 if (&other != this) {
                     this->_r = other._r;
-                    this->_pred = other._pred;
+                    callable_box<function_type>::operator=(other);
                 }
 
                 return *this;
             };
 
-            iterator begin() noexcept { return iterator{this->_r->begin(), this->_r->end(), _pred}; }
-            iterator end() noexcept { return iterator{this->_r->end(), this->_r->end(), _pred}; }
+            iterator begin() noexcept { return iterator{this->_r->begin(), this->_r->end(), this->get()}; }
+            iterator end() noexcept { return iterator{this->_r->end(), this->_r->end(), this->get()}; }
+
+            constexpr const_iterator begin() const noexcept { return const_iterator{as_const().begin(), as_const().end(), this->get()}; }
+            constexpr const_iterator end() const noexcept { return const_iterator{as_const().end(), as_const().end(), this->get()}; }
 
-            constexpr const_iterator begin() const noexcept { return const_iterator{this->_r->begin(), this->_r->end(), _pred}; }
-            constexpr const_iterator end() const noexcept { return const_iterator{this->_r->end(), this->_r->end(), _pred}; }
+            constexpr const function_type &predicate() const noexcept { return this->get(); }
 
+            // The number of matching elements is unknown until the view is traversed
+            typename ref_view<Range>::size_type size() const = delete;
+            template<typename R = Range>
+            typename std::enable_if<sized<const R>::value, typename ref_view<Range>::size_type>::type size_hint() const noexcept {
+                return ref_view<Range>::size();
+            }
 
         private:
-            function_type _pred;
+            constexpr const Range &as_const() const noexcept { return *this->_r; }
         };
 
 
         template<typename Iter, typename Pred>
-        class transform_iterator {
+        class transform_iterator : private callable_box<callable_t<Pred>> {
         public:
-            using iterator_category = std::forward_iterator_tag;
+            using function_type = callable_t<Pred>;
+            using iterator_category = common_iterator_category<Iter>;
 #if __cplusplus >= 201304L
-            using value_type = std::result_of_t<Pred(typename std::iterator_traits<Iter>::value_type)>;
+            using value_type = std::result_of_t<const function_type &(typename std::iterator_traits<Iter>::value_type)>;
 #else
-            using value_type = typename std::result_of<Pred(typename std::iterator_traits<Iter>::value_type)>::type;
+            using value_type = typename std::result_of<const function_type &(typename std::iterator_traits<Iter>::value_type)>::type;
 #endif
             using difference_type = typename std::iterator_traits<Iter>::difference_type;
             using pointer = value_type *;
@@ -419,64 +1017,20 @@ namespace ranged {
 #else
             using base_iterator = typename std::decay<Iter>::type;
 #endif
-            using function_type = std::function<function_traits_s<Pred>>;
 
             transform_iterator() = default;
 
-            transform_iterator(const transform_iterator &other) noexcept (
-                std::is_nothrow_copy_constructible<base_iterator>::value
-                ) : current_(other.current_), end_(other.end_), pred_(other.pred_) {};
-            transform_iterator &operator=(const transform_iterator &other) noexcept (
-                std::is_nothrow_copy_assignable<base_iterator>::value
-                ) {
-                if (&other != this) {
-                    current_ = other.current_;
-                    end_ = other.end_;
-                    pred_ = other.pred_;
-                }
-
-                return *this;
-            }
-
-            transform_iterator(transform_iterator &&other) noexcept (
-                std::is_nothrow_move_constructible<base_iterator>::value &&
-                std::is_default_constructible<base_iterator>::value
-                ) :
-#if __cplusplus >= 201304L
-            current_(std::exchange(other.current_, base_iterator {})), end_(std::exchange(other.end_, base_iterator {})), pred_(std::exchange(other.pred_, function_type {})) {};
-#else
-            current_(exchange(other.current_, base_iterator {})), end_(exchange(other.end_, base_iterator {})), pred_(exchange(other.pred_, function_type {})) {};
-#endif
-            transform_iterator &operator=(transform_iterator &&other) noexcept (
-                std::is_nothrow_move_assignable<base_iterator>::value &&
-                std::is_default_constructible<base_iterator>::value
-                ) {
-                if (&other != this) {
-#if __cplusplus >= 201304L
-                    current_ = std::exchange(other.current_, base_iterator {});
-                    end_ = std::exchange(other.end_, base_iterator {});
-                    pred_ = std::exchange(other.pred_, function_type {});
-#else
-
-                    current_ = exchange(other.current_, base_iterator {});
-                    end_ = exchange(other.end_, base_iterator {});
-                    pred_ = exchange(other.pred_, function_type {});
-#endif
-                }
-
-                return *this;
-            }
+            transform_iterator(const transform_iterator &) = default;
+            transform_iterator &operator=(const transform_iterator &) = default;
+            transform_iterator(transform_iterator &&) = default;
+            transform_iterator &operator=(transform_iterator &&) = default;
 
-            transform_iterator(Iter &&begin, Iter &&end, const Pred &pred) noexcept (
-                std::is_nothrow_constructible<Iter>::value
+            transform_iterator(base_iterator begin, base_iterator end, const function_type &pred) noexcept (
+                std::is_nothrow_move_constructible<base_iterator>::value
                 ) :
-#if __cplusplus >= 201304L
-                current_(std::exchange(begin, Iter {})), end_(std::exchange(end, Iter {})), pred_(pred) {}
-#else
-                current_(exchange(begin, Iter {})), end_(exchange(end, Iter {})), pred_(pred) {}
-#endif
+                callable_box<function_type>(pred), current_(std::move(begin)), end_(std::move(end)) {}
 
-            constexpr value_type operator*() const noexcept { return pred_(*current_); }
+            constexpr value_type operator*() const noexcept { return this->get()(*current_); }
             constexpr pointer operator->() const = delete;
 
             transform_iterator &operator++() {
@@ -490,6 +1044,37 @@ namespace ranged {
                 return tmp;
             }
 
+            transform_iterator &operator--() {
+                --current_;
+                return *this;
+            }
+
+            transform_iterator operator--(int) {
+                transform_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            transform_iterator &operator+=(difference_type n) {
+                current_ += n;
+                return *this;
+            }
+
+            transform_iterator &operator-=(difference_type n) {
+                current_ -= n;
+                return *this;
+            }
+
+            constexpr value_type operator[](difference_type n) const { return this->get()(current_[n]); }
+
+            friend transform_iterator operator+(transform_iterator it, difference_type n) { return it += n; }
+            friend transform_iterator operator+(difference_type n, transform_iterator it) { return it += n; }
+            friend transform_iterator operator-(transform_iterator it, difference_type n) { return it -= n; }
+
+            constexpr friend difference_type operator-(const transform_iterator &lhs, const transform_iterator &rhs) {
+                return lhs.current_ - rhs.current_;
+            }
+
             constexpr friend bool operator==(const transform_iterator &lhs, const transform_iterator &rhs) {
                 return lhs.current_ == rhs.current_;
             }
@@ -498,20 +1083,28 @@ namespace ranged {
                 return lhs.current_ != rhs.current_;
             }
 
+            constexpr friend bool operator<(const transform_iterator &lhs, const transform_iterator &rhs) {
+                return lhs.current_ < rhs.current_;
+            }
+            constexpr friend bool operator>(const transform_iterator &lhs, const transform_iterator &rhs) { return rhs < lhs; }
+            constexpr friend bool operator<=(const transform_iterator &lhs, const transform_iterator &rhs) { return !(rhs < lhs); }
+            constexpr friend bool operator>=(const transform_iterator &lhs, const transform_iterator &rhs) { return !(lhs < rhs); }
+
         private:
             base_iterator current_;
             base_iterator end_;
-            function_type pred_;
         };
         template<typename Range, typename Pred>
         class transform {
         public:
             using IteratorType = decltype(std::begin(std::declval<Range &>()));
             using iterator = transform_iterator<IteratorType, Pred>;
+            using const_iterator = iterator;
             using value_type = typename std::iterator_traits<iterator>::value_type;
             using difference_type = typename std::iterator_traits<iterator>::difference_type;
             using pointer = typename std::iterator_traits<iterator>::pointer;
             using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = std::size_t;
 
             transform() = default;
 
@@ -537,558 +1130,7282 @@ namespace ranged {
             iterator begin() const { return begin_it; }
             iterator end() const { return end_it; }
 
+            template<typename It = IteratorType>
+            constexpr typename std::enable_if<is_random_access_iterator<It>::value, std::size_t>::type size() const {
+                return static_cast<std::size_t>(end_it - begin_it);
+            }
+
         private:
             iterator begin_it;
             iterator end_it;
         };
 
-        template<typename I1, typename I2>
-        class zip_iterator {
+        // Owning counterpart of `transform`, produced by `operator|`. The range is moved in; lvalue ranges are held
+        // through a `ref_view`.
+        template<typename Range, typename Pred>
+        class transform_view : public owning_view<Range>, private callable_box<callable_t<Pred>> {
         public:
-            using iterator_category = std::forward_iterator_tag;
-            using first_type = typename std::iterator_traits<I1>::value_type;
-            using second_type = typename std::iterator_traits<I2>::value_type;
-            using first_type_ref = typename std::iterator_traits<I1>::reference;
-            using second_type_ref = typename std::iterator_traits<I2>::reference;
-            using value_type = std::tuple<first_type, second_type>;
-            using difference_type = std::ptrdiff_t;
-            using pointer = void;
-            using reference = std::tuple<first_type_ref, second_type_ref>;
-#if __cplusplus >= 201304L
-            using base_iterator1 = std::decay_t<I1>;
-            using base_iterator2 = std::decay_t<I2>;
-#else
-            using base_iterator1 = typename std::decay<I1>::type;
-            using base_iterator2 = typename std::decay<I2>::type;
-#endif
-
-            zip_iterator() = default;
+            using range_iterator_type = typename std::decay<Range>::type::iterator;
+            using range_const_iterator_type = typename std::decay<Range>::type::const_iterator;
+            using iterator = transform_iterator<range_iterator_type, Pred>;
+            using const_iterator = transform_iterator<range_const_iterator_type, Pred>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+            using function_type = callable_t<Pred>;
 
-            zip_iterator(I1 &&begin1, I2 &&begin2, I1 &&end1, I2 &&end2) noexcept (
-                std::is_nothrow_move_constructible<base_iterator1>::value && std::is_nothrow_move_constructible<base_iterator2>::value &&
-                std::is_default_constructible<base_iterator1>::value && std::is_default_constructible<base_iterator2>::value
-                ):
-#if __cplusplus >= 201304L
-                current_1(std::exchange(begin1, base_iterator1 {})), current_2(std::exchange(begin2, base_iterator2 {})), end_1(std::exchange(end1, base_iterator1 {})), end_2(std::exchange(end2, base_iterator2 {})) {
-#else
-                current_1(exchange(begin1, base_iterator1 {})), current_2(exchange(begin2, base_iterator2 {})), end_1(exchange(end1, base_iterator1 {})), end_2(exchange(end2, base_iterator2 {})) {
-#endif
-            }
+            transform_view(Range&& range, const Pred &pred) noexcept : owning_view<Range>(std::move(range)), callable_box<function_type>(pred) {}
 
-            constexpr reference operator*() const noexcept { return std::tie(*current_1, *current_2); }
-            constexpr pointer operator->() const = delete;
+            transform_view(transform_view &&other) noexcept : owning_view<Range>(std::move(other)), callable_box<function_type>(other) {}
+            transform_view &operator=(transform_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    callable_box<function_type>::operator=(other);
+                }
 
-            zip_iterator &operator++() {
-                ++current_1;
-                ++current_2;
                 return *this;
             }
 
-            zip_iterator operator++(int) {
-                zip_iterator tmp = *this;
-                ++*this;
-                return tmp;
-            }
+            transform_view(const transform_view &) = delete;
+            transform_view &operator=(const transform_view &) = delete;
 
-            constexpr friend bool operator==(const zip_iterator &lhs, const zip_iterator &rhs) {
-                return lhs.current_1 == rhs.current_1 || lhs.current_2 == rhs.current_2;
-            }
+            iterator begin() { return iterator{this->_r.begin(), this->_r.end(), this->get()}; }
+            iterator end() { return iterator{this->_r.end(), this->_r.end(), this->get()}; }
 
-            constexpr friend bool operator!=(const zip_iterator &lhs, const zip_iterator &rhs) {
-                return lhs.current_1 != rhs.current_1 && lhs.current_2 != rhs.current_2;
-            }
+            const_iterator begin() const { return const_iterator{this->_r.begin(), this->_r.end(), this->get()}; }
+            const_iterator end() const { return const_iterator{this->_r.end(), this->_r.end(), this->get()}; }
 
-        private:
-            base_iterator1 current_1;
-            base_iterator2 current_2;
-            base_iterator1 end_1;
-            base_iterator2 end_2;
+            constexpr const function_type &function() const noexcept { return this->get(); }
+
+            // Transforming keeps the number of elements, so the size (or its upper bound) is the one of the range
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size() const { return this->_r.size(); }
+            template<typename R = Range>
+            constexpr typename std::enable_if<has_size_hint<const R>::value, size_type>::type size_hint() const { return this->_r.size_hint(); }
         };
 
-        template<typename R1, typename R2>
-        class zip {
-        public:
-            using IteratorType1 = decltype(std::begin(std::declval<R1 &>()));
-            using IteratorType2 = decltype(std::begin(std::declval<R2 &>()));
-            using iterator = zip_iterator<IteratorType1, IteratorType2>;
-            using value_type = typename std::iterator_traits<iterator>::value_type;
-            using difference_type = typename std::iterator_traits<iterator>::difference_type;
-            using pointer = typename std::iterator_traits<iterator>::pointer;
-            using reference = typename std::iterator_traits<iterator>::reference;
+        // Base of the range adaptor closures returned by the single argument `filter` and `transform`
+        struct adaptor_closure {};
 
-            zip() = default;
+        template<typename T>
+        using is_adaptor_closure = std::is_base_of<adaptor_closure, typename std::decay<T>::type>;
 
-            zip(R1 &first_range, R2 &second_range) noexcept:
-                begin_it(std::begin(first_range), std::begin(second_range), std::end(first_range), std::end(second_range)), end_it(std::end(first_range), std::end(second_range), std::end(first_range), std::end(second_range)) {}
+        // `ref_view` over an lvalue range, or the range itself when it already is one
+        template<typename R>
+        using ref_view_of = typename std::conditional<is_specialization_of<typename std::remove_cv<R>::type, ref_view>::value,
+            typename std::remove_cv<R>::type, ref_view<R>>::type;
 
-            zip(R1 &&, R2 &&) = delete;
+        template<typename R>
+        constexpr ref_view<R> as_ref_view(R &range, std::false_type) noexcept { return ref_view<R>(range); }
+        template<typename R>
+        constexpr typename std::remove_cv<R>::type as_ref_view(R &range, std::true_type) noexcept { return range; }
+        template<typename R>
+        constexpr ref_view_of<R> as_ref_view(R &range) noexcept {
+            return as_ref_view(range, is_specialization_of<typename std::remove_cv<R>::type, ref_view> {});
+        }
+
+        // Applies `First`, then `Second`: `range | (first | second)` is `(range | first) | second`
+        template<typename First, typename Second>
+        class adaptor_pipeline : public adaptor_closure {
+        public:
+            adaptor_pipeline(const First &first, const Second &second) : first_(first), second_(second) {}
+
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const adaptor_pipeline &pipeline)
+                -> decltype(std::forward<Range>(range) | std::declval<const First &>() | std::declval<const Second &>()) {
+                return std::forward<Range>(range) | pipeline.first_ | pipeline.second_;
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<adaptor_pipeline, Next> operator|(const adaptor_pipeline &pipeline, const Next &next) {
+                return adaptor_pipeline<adaptor_pipeline, Next>{pipeline, next};
+            }
+
+        private:
+            First first_;
+            Second second_;
+        };
+
+        // `range | filter(pred)`. Lvalue ranges are referenced and rvalue ranges are moved into the view. Piped into
+        // another filter view, the predicates are fused so the result is still a single filter over the same range.
+        template<typename Pred>
+        class filter_adaptor : public adaptor_closure, private callable_storage<typename std::decay<Pred>::type> {
+        public:
+            using function_type = typename std::decay<Pred>::type;
+
+            constexpr explicit filter_adaptor(const function_type &pred) : callable_storage<function_type>(pred) {}
+
+            constexpr const function_type &predicate() const noexcept { return this->get(); }
+
+        private:
+            template<typename F>
+            using fused = fused_predicate<F, function_type>;
+            template<typename R>
+            using is_filter = std::integral_constant<bool,
+                is_specialization_of<typename std::decay<R>::type, filter_view>::value || is_specialization_of<typename std::decay<R>::type, filter_ref_view>::value>;
+
+            template<typename Range>
+            typename std::enable_if<!is_filter<Range>::value, filter_ref_view<Range, function_type>>::type apply(Range &range) const {
+                return filter_ref_view<Range, function_type>{range, predicate()};
+            }
+            template<typename Range>
+            typename std::enable_if<!is_filter<Range>::value && !std::is_lvalue_reference<Range>::value, filter_view<Range, function_type>>::type
+            apply(Range &&range) const {
+                return filter_view<Range, function_type>{std::move(range), predicate()};
+            }
+
+            template<typename R, typename P>
+            filter_view<R, fused<callable_t<P>>> apply(filter_view<R, P> &&view) const {
+                return filter_view<R, fused<callable_t<P>>>{std::move(view).base(), fused<callable_t<P>>{view.predicate(), predicate()}};
+            }
+            template<typename R, typename P>
+            filter_ref_view<R, fused<callable_t<P>>> apply(filter_view<R, P> &view) const {
+                return filter_ref_view<R, fused<callable_t<P>>>{view.base(), fused<callable_t<P>>{view.predicate(), predicate()}};
+            }
+            template<typename R, typename P>
+            filter_ref_view<const R, fused<callable_t<P>>> apply(const filter_view<R, P> &view) const {
+                return filter_ref_view<const R, fused<callable_t<P>>>{view.base(), fused<callable_t<P>>{view.predicate(), predicate()}};
+            }
+            template<typename R, typename P>
+            filter_ref_view<R, fused<callable_t<P>>> apply(const filter_ref_view<R, P> &view) const {
+                return filter_ref_view<R, fused<callable_t<P>>>{view.base(), fused<callable_t<P>>{view.predicate(), predicate()}};
+            }
+
+            // Declared after `apply`, which the return type refers to
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const filter_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<filter_adaptor, Next> operator|(const filter_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<filter_adaptor, Next>{adaptor, next};
+            }
+        };
+
+        // `range | transform(func)`. Like `filter_adaptor`, but adjacent transforms are composed into one function.
+        template<typename Pred>
+        class transform_adaptor : public adaptor_closure, private callable_storage<typename std::decay<Pred>::type> {
+        public:
+            using function_type = typename std::decay<Pred>::type;
+
+            constexpr explicit transform_adaptor(const function_type &func) : callable_storage<function_type>(func) {}
+
+            constexpr const function_type &function() const noexcept { return this->get(); }
+
+        private:
+            template<typename F>
+            using composed = composed_function<F, function_type>;
+            template<typename R>
+            using is_transform = is_specialization_of<typename std::decay<R>::type, transform_view>;
+
+            template<typename Range>
+            typename std::enable_if<!is_transform<Range>::value, transform_view<ref_view_of<Range>, function_type>>::type apply(Range &range) const {
+                return transform_view<ref_view_of<Range>, function_type>{as_ref_view(range), function()};
+            }
+            template<typename Range>
+            typename std::enable_if<!is_transform<Range>::value && !std::is_lvalue_reference<Range>::value, transform_view<Range, function_type>>::type
+            apply(Range &&range) const {
+                return transform_view<Range, function_type>{std::move(range), function()};
+            }
+
+            template<typename R, typename P>
+            transform_view<R, composed<callable_t<P>>> apply(transform_view<R, P> &&view) const {
+                return transform_view<R, composed<callable_t<P>>>{std::move(view).base(), composed<callable_t<P>>{view.function(), function()}};
+            }
+            template<typename R, typename P>
+            transform_view<ref_view_of<R>, composed<callable_t<P>>> apply(transform_view<R, P> &view) const {
+                return transform_view<ref_view_of<R>, composed<callable_t<P>>>{as_ref_view(view.base()), composed<callable_t<P>>{view.function(), function()}};
+            }
+            template<typename R, typename P>
+            transform_view<ref_view_of<const R>, composed<callable_t<P>>> apply(const transform_view<R, P> &view) const {
+                return transform_view<ref_view_of<const R>, composed<callable_t<P>>>{as_ref_view(view.base()), composed<callable_t<P>>{view.function(), function()}};
+            }
+
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const transform_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<transform_adaptor, Next> operator|(const transform_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<transform_adaptor, Next>{adaptor, next};
+            }
+        };
+
+        // The container a stored range refers to: the referenced one for a `ref_view`, the range itself otherwise
+        template<typename R>
+        R &underlying(R &range) noexcept { return range; }
+        template<typename R>
+        R &underlying(ref_view<R> &range) noexcept { return range.base(); }
+        template<typename R>
+        R &underlying(const ref_view<R> &range) noexcept { return range.base(); }
+
+        template<typename R>
+        using underlying_t = typename std::remove_reference<decltype(underlying(std::declval<R &>()))>::type;
+
+        // Chunks of a contiguous range, as spans into it. Random access: chunk `i` starts at element `i * n`.
+        template<typename T>
+        class contiguous_chunk_iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = span<T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = span<T>;
+
+            contiguous_chunk_iterator() noexcept : data_(nullptr), size_(0), chunk_(1), index_(0) {}
+            contiguous_chunk_iterator(T *data, std::size_t size, std::size_t chunk, std::size_t index) noexcept :
+                data_(data), size_(size), chunk_(chunk), index_(index) {}
+
+            reference operator*() const noexcept {
+                const std::size_t offset = index_ * chunk_;
+                return span<T>(data_ + offset, std::min(chunk_, size_ - offset));
+            }
+            reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+            contiguous_chunk_iterator &operator++() noexcept {
+                ++index_;
+                return *this;
+            }
+            contiguous_chunk_iterator operator++(int) noexcept {
+                contiguous_chunk_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            contiguous_chunk_iterator &operator--() noexcept {
+                --index_;
+                return *this;
+            }
+            contiguous_chunk_iterator operator--(int) noexcept {
+                contiguous_chunk_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            contiguous_chunk_iterator &operator+=(difference_type n) noexcept {
+                index_ = static_cast<std::size_t>(static_cast<difference_type>(index_) + n);
+                return *this;
+            }
+            contiguous_chunk_iterator &operator-=(difference_type n) noexcept { return *this += -n; }
+
+            friend contiguous_chunk_iterator operator+(contiguous_chunk_iterator it, difference_type n) noexcept { return it += n; }
+            friend contiguous_chunk_iterator operator+(difference_type n, contiguous_chunk_iterator it) noexcept { return it += n; }
+            friend contiguous_chunk_iterator operator-(contiguous_chunk_iterator it, difference_type n) noexcept { return it -= n; }
+            friend difference_type operator-(const contiguous_chunk_iterator &lhs, const contiguous_chunk_iterator &rhs) noexcept {
+                return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+            }
+
+            friend bool operator==(const contiguous_chunk_iterator &lhs, const contiguous_chunk_iterator &rhs) noexcept { return lhs.index_ == rhs.index_; }
+            friend bool operator!=(const contiguous_chunk_iterator &lhs, const contiguous_chunk_iterator &rhs) noexcept { return lhs.index_ != rhs.index_; }
+            friend bool operator<(const contiguous_chunk_iterator &lhs, const contiguous_chunk_iterator &rhs) noexcept { return lhs.index_ < rhs.index_; }
+            friend bool operator>(const contiguous_chunk_iterator &lhs, const contiguous_chunk_iterator &rhs) noexcept { return rhs < lhs; }
+            friend bool operator<=(const contiguous_chunk_iterator &lhs, const contiguous_chunk_iterator &rhs) noexcept { return !(rhs < lhs); }
+            friend bool operator>=(const contiguous_chunk_iterator &lhs, const contiguous_chunk_iterator &rhs) noexcept { return !(lhs < rhs); }
+
+        private:
+            T *data_;
+            std::size_t size_;
+            std::size_t chunk_;
+            std::size_t index_;
+        };
+
+        // Fixed capacity buffer of a `buffered_chunk_iterator`. Chunks of up to `inline_capacity` elements are stored in
+        // the buffer itself, larger ones in a heap block allocated once. Copies copy the elements present only.
+        template<typename T>
+        class chunk_buffer {
+        public:
+            static constexpr std::size_t inline_bytes = 256;
+            static constexpr std::size_t inline_capacity = sizeof(T) < inline_bytes ? inline_bytes / sizeof(T) : 1;
+
+            explicit chunk_buffer(std::size_t capacity = 0) :
+                heap_(capacity > inline_capacity ? std::allocator<T>().allocate(capacity) : nullptr), capacity_(capacity), size_(0) {}
+            chunk_buffer(const chunk_buffer &other) : chunk_buffer(other.capacity_) {
+                for (const T &element: other) {
+                    push_back(element);
+                }
+            }
+            chunk_buffer &operator=(const chunk_buffer &other) {
+                if (&other != this) {
+                    clear();
+                    if (other.capacity_ != capacity_) {
+                        release();
+                        heap_ = other.capacity_ > inline_capacity ? std::allocator<T>().allocate(other.capacity_) : nullptr;
+                        capacity_ = other.capacity_;
+                    }
+                    for (const T &element: other) {
+                        push_back(element);
+                    }
+                }
+
+                return *this;
+            }
+            ~chunk_buffer() {
+                clear();
+                release();
+            }
+
+            const T *begin() const noexcept { return data(); }
+            const T *end() const noexcept { return data() + size_; }
+            const T *data() const noexcept { return heap_ != nullptr ? heap_ : reinterpret_cast<const T *>(inline_); }
+            std::size_t size() const noexcept { return size_; }
+            bool empty() const noexcept { return size_ == 0; }
+            bool full() const noexcept { return size_ == capacity_; }
+
+            template<typename U>
+            void push_back(U &&element) {
+                assert(size_ < capacity_);
+                ::new (static_cast<void *>(data() + size_)) T(std::forward<U>(element));
+                ++size_;
+            }
+            void clear() noexcept {
+                for (; size_ != 0; --size_) {
+                    data()[size_ - 1].~T();
+                }
+            }
+
+        private:
+            T *data() noexcept { return heap_ != nullptr ? heap_ : reinterpret_cast<T *>(inline_); }
+
+            void release() noexcept {
+                if (heap_ != nullptr)
+                    std::allocator<T>().deallocate(heap_, capacity_);
+                heap_ = nullptr;
+            }
+
+            T *heap_;
+            std::size_t capacity_;
+            std::size_t size_;
+            alignas(T) unsigned char inline_[inline_capacity * sizeof(T)];
+        };
+
+        // Chunks of any other range (e.g. a `std::list` or a filter), copied into a fixed buffer of `n` elements which
+        // is refilled on increment. An input iterator: the span yielded by a chunk is invalidated by the next one.
+        template<typename Iter>
+        class buffered_chunk_iterator {
+        public:
+            using element_type = typename std::remove_cv<typename std::iterator_traits<Iter>::value_type>::type;
+            using iterator_category = std::input_iterator_tag;
+            using value_type = span<const element_type>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = span<const element_type>;
+
+            buffered_chunk_iterator() = default;
+            buffered_chunk_iterator(Iter current, Iter end, std::size_t chunk) :
+                current_(std::move(current)), end_(std::move(end)), buffer_(current_ != end_ ? chunk : 0) {
+                fill();
+            }
+
+            reference operator*() const noexcept { return reference(buffer_.data(), buffer_.size()); }
+
+            buffered_chunk_iterator &operator++() {
+                fill();
+                return *this;
+            }
+            buffered_chunk_iterator operator++(int) {
+                buffered_chunk_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            // The last chunk ends at the end of the range too, only the end iterator has no elements left
+            friend bool operator==(const buffered_chunk_iterator &lhs, const buffered_chunk_iterator &rhs) {
+                return lhs.current_ == rhs.current_ && lhs.buffer_.empty() == rhs.buffer_.empty();
+            }
+            friend bool operator!=(const buffered_chunk_iterator &lhs, const buffered_chunk_iterator &rhs) { return !(lhs == rhs); }
+
+        private:
+            void fill() {
+                buffer_.clear();
+                for (; !buffer_.full() && current_ != end_; ++current_) {
+                    buffer_.push_back(*current_);
+                }
+            }
+
+            Iter current_;
+            Iter end_;
+            chunk_buffer<element_type> buffer_;
+        };
+
+        template<typename R, bool = is_contiguous_range<underlying_t<R>>::value>
+        struct chunk_iterator_of {
+            using type = contiguous_chunk_iterator<typename std::remove_pointer<decltype(std::declval<underlying_t<R> &>().data())>::type>;
+        };
+        template<typename R>
+        struct chunk_iterator_of<R, false> {
+            using type = buffered_chunk_iterator<decltype(std::declval<R &>().begin())>;
+        };
+
+        // Consecutive chunks of `n` elements, the last one possibly shorter. Contiguous ranges yield spans into their
+        // storage (writable through a non-const view), other ranges yield buffered copies.
+        template<typename Range>
+        class chunk_view : public owning_view<Range> {
+            template<typename R>
+            using chunk_iterator_of = typename views::chunk_iterator_of<R>::type;
+
+        public:
+            using iterator = chunk_iterator_of<Range>;
+            using const_iterator = chunk_iterator_of<const Range>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            chunk_view(Range &&range, std::size_t chunk) : owning_view<Range>(std::move(range)), chunk_(chunk) {
+                if (chunk_ == 0)
+                    throw std::invalid_argument("Chunk size must be positive.");
+            }
+
+            chunk_view(chunk_view &&other) noexcept : owning_view<Range>(std::move(other)), chunk_(other.chunk_) {}
+            chunk_view &operator=(chunk_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    chunk_ = other.chunk_;
+                }
+
+                return *this;
+            }
+
+            chunk_view(const chunk_view &) = delete;
+            chunk_view &operator=(const chunk_view &) = delete;
+
+            iterator begin() { return make_begin<iterator>(this->_r, is_contiguous_range<underlying_t<Range>> {}); }
+            iterator end() { return make_end<iterator>(this->_r, is_contiguous_range<underlying_t<Range>> {}); }
+            const_iterator begin() const { return make_begin<const_iterator>(this->_r, is_contiguous_range<underlying_t<Range>> {}); }
+            const_iterator end() const { return make_end<const_iterator>(this->_r, is_contiguous_range<underlying_t<Range>> {}); }
+
+            constexpr std::size_t chunk_size() const noexcept { return chunk_; }
+
+            // Number of chunks
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size() const {
+                return (this->_r.size() + chunk_ - 1) / chunk_;
+            }
+
+        private:
+            template<typename It, typename R>
+            It make_begin(R &range, std::true_type) const {
+                return It(underlying(range).data(), underlying(range).size(), chunk_, 0);
+            }
+            template<typename It, typename R>
+            It make_end(R &range, std::true_type) const {
+                return It(underlying(range).data(), underlying(range).size(), chunk_, (underlying(range).size() + chunk_ - 1) / chunk_);
+            }
+            template<typename It, typename R>
+            It make_begin(R &range, std::false_type) const { return It(range.begin(), range.end(), chunk_); }
+            template<typename It, typename R>
+            It make_end(R &range, std::false_type) const { return It(range.end(), range.end(), chunk_); }
+
+            std::size_t chunk_;
+        };
+
+        // `range | chunk(n)`. Lvalue ranges are referenced and rvalue ranges are moved into the view.
+        class chunk_adaptor : public adaptor_closure {
+        public:
+            constexpr explicit chunk_adaptor(std::size_t chunk) noexcept : chunk_(chunk) {}
+
+            constexpr std::size_t chunk_size() const noexcept { return chunk_; }
+
+        private:
+            template<typename Range>
+            chunk_view<ref_view_of<Range>> apply(Range &range) const {
+                return chunk_view<ref_view_of<Range>>{as_ref_view(range), chunk_};
+            }
+            template<typename Range>
+            typename std::enable_if<!std::is_lvalue_reference<Range>::value, chunk_view<Range>>::type apply(Range &&range) const {
+                return chunk_view<Range>{std::move(range), chunk_};
+            }
+
+            std::size_t chunk_;
+
+        public:
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const chunk_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<chunk_adaptor, Next> operator|(const chunk_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<chunk_adaptor, Next>{adaptor, next};
+            }
+        };
+
+        // Elements computed by a `cached_transform_view`, constructed on first access into blocks that never move, so
+        // references to them stay valid while the cache grows. A range of known size gets one contiguous block, which
+        // threads may fill concurrently: each element is built by the first thread claiming it, the others wait for it.
+        // Other ranges get blocks of `block_size` elements, allocated as they are reached by a single thread. Indices
+        // from `capacity` on are not cached.
+        template<typename T>
+        class memo_cache {
+        public:
+            static constexpr std::size_t block_shift = 8;
+            static constexpr std::size_t block_size = std::size_t {1} << block_shift;
+
+            explicit memo_cache(std::size_t capacity, std::size_t first_block = 0) :
+                capacity_(capacity), first_(std::min(first_block, capacity)), head_(nullptr) {}
+            ~memo_cache() { delete head_.load(std::memory_order_relaxed); }
+
+            memo_cache(memo_cache &&other) noexcept :
+                capacity_(other.capacity_), first_(other.first_), head_(other.head_.exchange(nullptr)), blocks_(std::move(other.blocks_)) {}
+            memo_cache &operator=(memo_cache &&other) noexcept {
+                if (&other != this) {
+                    delete head_.exchange(other.head_.exchange(nullptr));
+                    capacity_ = other.capacity_;
+                    first_ = other.first_;
+                    blocks_ = std::move(other.blocks_);
+                }
+
+                return *this;
+            }
+
+            constexpr std::size_t capacity() const noexcept { return capacity_; }
+
+            // The element at `index`, constructed from `make()` on first access. Null past the capacity.
+            template<typename Make>
+            const T *get(std::size_t index, const Make &make) {
+                if (index >= capacity_)
+                    return nullptr;
+                if (index < first_)
+                    return head().get(index, make);
+
+                index -= first_;
+                const std::size_t b = index >> block_shift;
+                if (b >= blocks_.size())
+                    blocks_.resize(b + 1);
+                if (!blocks_[b])
+                    blocks_[b].reset(new block(block_size));
+                return blocks_[b]->get(index & (block_size - 1), make);
+            }
+
+        private:
+            // Uninitialized storage for `size` elements, and two bits per element telling whether it was claimed by a
+            // thread and whether it was constructed
+            class block {
+            public:
+                explicit block(std::size_t size) :
+                    size_(size), bits_(new std::atomic<std::uint64_t>[2 * words()]()), values_(std::allocator<T>().allocate(size)) {}
+                ~block() {
+                    for (std::size_t word = 0; word < words(); ++word) {
+                        for (std::uint64_t bits = ready(word).load(std::memory_order_relaxed); bits != 0; bits &= bits - 1) {
+                            values_[word * 64 + count_trailing_zeros(bits)].~T();
+                        }
+                    }
+                    std::allocator<T>().deallocate(values_, size_);
+                }
+
+                block(const block &) = delete;
+                block &operator=(const block &) = delete;
+
+                template<typename Make>
+                const T *get(std::size_t index, const Make &make) {
+                    const std::uint64_t bit = std::uint64_t {1} << (index % 64);
+                    std::atomic<std::uint64_t> &ready = this->ready(index / 64);
+                    std::atomic<std::uint64_t> &claimed = this->claimed(index / 64);
+                    while ((ready.load(std::memory_order_acquire) & bit) == 0) {
+                        if ((claimed.fetch_or(bit, std::memory_order_acquire) & bit) != 0) {
+                            std::this_thread::yield();
+                            continue;
+                        }
+
+                        try {
+                            ::new (static_cast<void *>(values_ + index)) T(make());
+                        } catch (...) {
+                            // Let another thread try again
+                            claimed.fetch_and(~bit, std::memory_order_release);
+                            throw;
+                        }
+                        ready.fetch_or(bit, std::memory_order_release);
+                    }
+                    return values_ + index;
+                }
+
+            private:
+                std::size_t words() const noexcept { return (size_ + 63) / 64; }
+                std::atomic<std::uint64_t> &ready(std::size_t word) const noexcept { return bits_[word]; }
+                std::atomic<std::uint64_t> &claimed(std::size_t word) const noexcept { return bits_[words() + word]; }
+
+                std::size_t size_;
+                std::unique_ptr<std::atomic<std::uint64_t>[]> bits_;
+                T *values_;
+            };
+
+            // The block of known size, allocated by the first access of any thread
+            block &head() {
+                block *current = head_.load(std::memory_order_acquire);
+                if (current == nullptr) {
+                    std::unique_ptr<block> fresh(new block(first_));
+                    if (head_.compare_exchange_strong(current, fresh.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+                        current = fresh.release();
+                }
+                return *current;
+            }
+
+            std::size_t capacity_;
+            std::size_t first_;
+            std::atomic<block *> head_;
+            std::vector<std::unique_ptr<block>> blocks_;
+        };
+
+        // Iterator of `cached_transform_view`: the element's index in the range locates its cache entry. A `Capped`
+        // cache doesn't hold the elements past its capacity, which are computed on every dereference: elements are then
+        // returned by value and the iterator is an input iterator.
+        template<typename Iter, typename Pred, typename T, bool Capped = false>
+        class cached_transform_iterator {
+        public:
+            using function_type = callable_t<Pred>;
+            using iterator_category = typename std::conditional<Capped, std::input_iterator_tag,
+                typename std::conditional<is_random_access_iterator<Iter>::value, std::random_access_iterator_tag, std::forward_iterator_tag>::type>::type;
+            using value_type = T;
+            using difference_type = typename std::iterator_traits<Iter>::difference_type;
+            using pointer = const T *;
+            using reference = typename std::conditional<Capped, T, const T &>::type;
+
+            cached_transform_iterator() : current_(), index_(0), func_(nullptr), cache_(nullptr) {}
+            cached_transform_iterator(Iter current, std::size_t index, const function_type &func, memo_cache<T> &cache) :
+                current_(std::move(current)), index_(index), func_(std::addressof(func)), cache_(std::addressof(cache)) {}
+
+            reference operator*() const {
+                const T *cached = cache_->get(index_, [this]() { return (*func_)(*current_); });
+                return dereference(cached, std::integral_constant<bool, Capped> {});
+            }
+            template<bool C = Capped, typename = typename std::enable_if<!C>::type>
+            pointer operator->() const { return std::addressof(**this); }
+
+            cached_transform_iterator &operator++() {
+                ++current_;
+                ++index_;
+                return *this;
+            }
+
+            cached_transform_iterator operator++(int) {
+                cached_transform_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            cached_transform_iterator &operator--() {
+                --current_;
+                --index_;
+                return *this;
+            }
+
+            cached_transform_iterator operator--(int) {
+                cached_transform_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            cached_transform_iterator &operator+=(difference_type n) {
+                current_ += n;
+                index_ += static_cast<std::size_t>(n);
+                return *this;
+            }
+
+            cached_transform_iterator &operator-=(difference_type n) { return *this += -n; }
+
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            friend cached_transform_iterator operator+(cached_transform_iterator it, difference_type n) { return it += n; }
+            friend cached_transform_iterator operator+(difference_type n, cached_transform_iterator it) { return it += n; }
+            friend cached_transform_iterator operator-(cached_transform_iterator it, difference_type n) { return it -= n; }
+
+            friend difference_type operator-(const cached_transform_iterator &lhs, const cached_transform_iterator &rhs) {
+                return lhs.current_ - rhs.current_;
+            }
+
+            friend bool operator==(const cached_transform_iterator &lhs, const cached_transform_iterator &rhs) { return lhs.current_ == rhs.current_; }
+            friend bool operator!=(const cached_transform_iterator &lhs, const cached_transform_iterator &rhs) { return lhs.current_ != rhs.current_; }
+            friend bool operator<(const cached_transform_iterator &lhs, const cached_transform_iterator &rhs) { return lhs.current_ < rhs.current_; }
+            friend bool operator>(const cached_transform_iterator &lhs, const cached_transform_iterator &rhs) { return rhs < lhs; }
+            friend bool operator<=(const cached_transform_iterator &lhs, const cached_transform_iterator &rhs) { return !(rhs < lhs); }
+            friend bool operator>=(const cached_transform_iterator &lhs, const cached_transform_iterator &rhs) { return !(lhs < rhs); }
+
+        private:
+            // An uncapped cache holds every element
+            const T &dereference(const T *cached, std::false_type) const noexcept { return *cached; }
+            T dereference(const T *cached, std::true_type) const { return cached != nullptr ? *cached : (*func_)(*current_); }
+
+            Iter current_;
+            std::size_t index_;
+            const function_type *func_;
+            memo_cache<T> *cache_;
+        };
+
+        // Transform evaluating the function at most once per element: the results are cached by the view, so a second
+        // dereference or a second traversal reads them back. A `Capped` view caches only the first `max_cached` ones.
+        // The cache is filled through const access as well; threads may share a view over a random access range, as
+        // parallel algorithms do, but not over other ranges. Iterators refer to the view and are invalidated by moving it.
+        template<typename Range, typename Pred, bool Capped = false>
+        class cached_transform_view : public owning_view<Range>, private callable_box<callable_t<Pred>> {
+            using base_reference = typename std::iterator_traits<typename std::decay<Range>::type::const_iterator>::reference;
+
+        public:
+            using function_type = callable_t<Pred>;
+            using range_iterator_type = typename std::decay<Range>::type::iterator;
+            using range_const_iterator_type = typename std::decay<Range>::type::const_iterator;
+            using value_type = typename std::decay<typename std::result_of<const function_type &(base_reference)>::type>::type;
+            using iterator = cached_transform_iterator<range_iterator_type, Pred, value_type, Capped>;
+            using const_iterator = cached_transform_iterator<range_const_iterator_type, Pred, value_type, Capped>;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            cached_transform_view(Range &&range, const Pred &pred, std::size_t max_cached) :
+                owning_view<Range>(std::move(range)), callable_box<function_type>(pred),
+                cache_(max_cached, known_size(is_random_access_iterator<range_iterator_type> {})) {}
+
+            cached_transform_view(cached_transform_view &&other) noexcept :
+                owning_view<Range>(std::move(other)), callable_box<function_type>(other), cache_(std::move(other.cache_)) {}
+            cached_transform_view &operator=(cached_transform_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    callable_box<function_type>::operator=(other);
+                    cache_ = std::move(other.cache_);
+                }
+
+                return *this;
+            }
+
+            cached_transform_view(const cached_transform_view &) = delete;
+            cached_transform_view &operator=(const cached_transform_view &) = delete;
+
+            iterator begin() { return iterator{this->_r.begin(), 0, this->get(), cache_}; }
+            iterator end() { return iterator{this->_r.end(), end_index(), this->get(), cache_}; }
+            const_iterator begin() const { return const_iterator{this->_r.begin(), 0, this->get(), cache_}; }
+            const_iterator end() const { return const_iterator{this->_r.end(), end_index(), this->get(), cache_}; }
+
+            constexpr const function_type &function() const noexcept { return this->get(); }
+            // Number of leading elements kept once computed
+            constexpr std::size_t max_cached() const noexcept { return cache_.capacity(); }
+
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size() const { return this->_r.size(); }
+            template<typename R = Range>
+            constexpr typename std::enable_if<has_size_hint<const R>::value, size_type>::type size_hint() const { return this->_r.size_hint(); }
+
+        private:
+            // Only random access ranges report their size without a traversal
+            std::size_t known_size(std::true_type) { return static_cast<std::size_t>(this->_r.end() - this->_r.begin()); }
+            std::size_t known_size(std::false_type) const noexcept { return 0; }
+            // Only random access iterators use the index of the end iterator
+            std::size_t end_index() const { return end_index(is_random_access_iterator<range_const_iterator_type> {}); }
+            std::size_t end_index(std::true_type) const { return static_cast<std::size_t>(this->_r.end() - this->_r.begin()); }
+            std::size_t end_index(std::false_type) const noexcept { return static_cast<std::size_t>(-1); }
+
+            mutable memo_cache<value_type> cache_;
+        };
+
+        // Function of `memoize`: the element itself, as a value
+        template<typename Reference>
+        struct element_copy {
+            typename std::decay<Reference>::type operator()(Reference element) const { return element; }
+        };
+
+        template<typename Range, bool Capped = false>
+        using memoized_view = cached_transform_view<Range,
+            element_copy<typename std::iterator_traits<typename std::decay<Range>::type::const_iterator>::reference>, Capped>;
+
+        // `range | transform_cached(func)`. Lvalue ranges are referenced and rvalue ranges are moved into the view.
+        template<typename Pred, bool Capped = false>
+        class cached_transform_adaptor : public adaptor_closure, private callable_storage<typename std::decay<Pred>::type> {
+        public:
+            using function_type = typename std::decay<Pred>::type;
+
+            cached_transform_adaptor(const function_type &func, std::size_t max_cached) : callable_storage<function_type>(func), max_cached_(max_cached) {}
+
+            constexpr const function_type &function() const noexcept { return this->get(); }
+            constexpr std::size_t max_cached() const noexcept { return max_cached_; }
+
+        private:
+            template<typename Range>
+            cached_transform_view<ref_view_of<Range>, function_type, Capped> apply(Range &range) const {
+                return cached_transform_view<ref_view_of<Range>, function_type, Capped>{as_ref_view(range), function(), max_cached_};
+            }
+            template<typename Range>
+            typename std::enable_if<!std::is_lvalue_reference<Range>::value, cached_transform_view<Range, function_type, Capped>>::type
+            apply(Range &&range) const {
+                return cached_transform_view<Range, function_type, Capped>{std::move(range), function(), max_cached_};
+            }
+
+            std::size_t max_cached_;
+
+        public:
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const cached_transform_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<cached_transform_adaptor, Next> operator|(const cached_transform_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<cached_transform_adaptor, Next>{adaptor, next};
+            }
+        };
+
+        // `range | memoize()`, e.g. after an expensive `transform`
+        template<bool Capped = false>
+        class memoize_adaptor : public adaptor_closure {
+        public:
+            constexpr explicit memoize_adaptor(std::size_t max_cached) noexcept : max_cached_(max_cached) {}
+
+            constexpr std::size_t max_cached() const noexcept { return max_cached_; }
+
+        private:
+            template<typename Range>
+            memoized_view<ref_view_of<Range>, Capped> apply(Range &range) const {
+                return memoized_view<ref_view_of<Range>, Capped>{as_ref_view(range), {}, max_cached_};
+            }
+            template<typename Range>
+            typename std::enable_if<!std::is_lvalue_reference<Range>::value, memoized_view<Range, Capped>>::type apply(Range &&range) const {
+                return memoized_view<Range, Capped>{std::move(range), {}, max_cached_};
+            }
+
+            std::size_t max_cached_;
+
+        public:
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const memoize_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<memoize_adaptor, Next> operator|(const memoize_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<memoize_adaptor, Next>{adaptor, next};
+            }
+        };
+
+        // Iterator over at most `count` elements of a range without random access. The increment consuming the last
+        // one leaves the base iterator in place, so a filter below doesn't search past the elements taken.
+        template<typename Iter>
+        class counted_iterator {
+        public:
+            using iterator_category = typename std::common_type<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>::type;
+            using value_type = typename std::iterator_traits<Iter>::value_type;
+            using difference_type = typename std::iterator_traits<Iter>::difference_type;
+            using pointer = typename std::iterator_traits<Iter>::pointer;
+            using reference = typename std::iterator_traits<Iter>::reference;
+
+            counted_iterator() : current_(), remaining_(0), sentinel_(false) {}
+            counted_iterator(Iter current, std::size_t remaining) : current_(std::move(current)), remaining_(remaining), sentinel_(false) {}
+
+            // The end of a range whose end is `end`
+            static counted_iterator sentinel(Iter end) {
+                counted_iterator it{std::move(end), 0};
+                it.sentinel_ = true;
+                return it;
+            }
+
+            reference operator*() const { return *current_; }
+
+            counted_iterator &operator++() {
+                if (--remaining_ != 0)
+                    ++current_;
+                return *this;
+            }
+            counted_iterator operator++(int) {
+                counted_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            // Iterators over the same range are at the same position when they have as many elements left. The sentinel is
+            // reached once `count` elements are consumed, or when the base range runs out first.
+            friend bool operator==(const counted_iterator &lhs, const counted_iterator &rhs) {
+                if (lhs.sentinel_ == rhs.sentinel_)
+                    return lhs.sentinel_ || lhs.remaining_ == rhs.remaining_;
+
+                const counted_iterator &it = lhs.sentinel_ ? rhs : lhs;
+                const counted_iterator &end = lhs.sentinel_ ? lhs : rhs;
+                return it.remaining_ == 0 || it.current_ == end.current_;
+            }
+            friend bool operator!=(const counted_iterator &lhs, const counted_iterator &rhs) { return !(lhs == rhs); }
+
+        private:
+            Iter current_;
+            std::size_t remaining_;
+            bool sentinel_;
+        };
+
+        template<typename R>
+        using base_iterator_of = decltype(std::declval<R &>().begin());
+
+        // The begin iterator of a view that has to walk its range to find it, found on the first `begin()` and returned
+        // by the next ones. Threads racing to fill it each walk the range and keep the first result. Moving the view
+        // drops it, since it may point into the moved range.
+        template<typename Iter>
+        class cached_position {
+        public:
+            cached_position() noexcept : iter_(nullptr) {}
+            ~cached_position() { delete iter_.load(std::memory_order_relaxed); }
+
+            cached_position(const cached_position &) = delete;
+            cached_position &operator=(const cached_position &) = delete;
+
+            template<typename Find>
+            Iter get(const Find &find) {
+                Iter *iter = iter_.load(std::memory_order_acquire);
+                if (iter == nullptr) {
+                    std::unique_ptr<Iter> found(new Iter(find()));
+                    if (iter_.compare_exchange_strong(iter, found.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+                        iter = found.release();
+                }
+                return *iter;
+            }
+
+            void reset() noexcept { delete iter_.exchange(nullptr, std::memory_order_acq_rel); }
+
+        private:
+            std::atomic<Iter *> iter_;
+        };
+
+        // The first `n` elements of a range. A random access range keeps its own iterators and finds the end in O(1),
+        // other ranges are walked by a `counted_iterator`.
+        template<typename Range>
+        class take_view : public owning_view<Range> {
+            template<typename R>
+            using iterator_of = typename std::conditional<is_random_access_iterator<base_iterator_of<R>>::value,
+                base_iterator_of<R>, counted_iterator<base_iterator_of<R>>>::type;
+
+        public:
+            using iterator = iterator_of<Range>;
+            using const_iterator = iterator_of<const Range>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            take_view(Range &&range, std::size_t count) noexcept : owning_view<Range>(std::move(range)), count_(count) {}
+
+            take_view(take_view &&other) noexcept : owning_view<Range>(std::move(other)), count_(other.count_) {}
+            take_view &operator=(take_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    count_ = other.count_;
+                }
+
+                return *this;
+            }
+
+            take_view(const take_view &) = delete;
+            take_view &operator=(const take_view &) = delete;
+
+            iterator begin() { return make_begin(this->_r, is_random_access_iterator<base_iterator_of<Range>> {}); }
+            iterator end() { return make_end(this->_r, is_random_access_iterator<base_iterator_of<Range>> {}); }
+            const_iterator begin() const { return make_begin(this->_r, is_random_access_iterator<base_iterator_of<const Range>> {}); }
+            const_iterator end() const { return make_end(this->_r, is_random_access_iterator<base_iterator_of<const Range>> {}); }
+
+            constexpr std::size_t count() const noexcept { return count_; }
+
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size() const {
+                return std::min<size_type>(this->_r.size(), count_);
+            }
+            template<typename R = Range>
+            constexpr typename std::enable_if<has_size_hint<const R>::value, size_type>::type size_hint() const {
+                return std::min<size_type>(this->_r.size_hint(), count_);
+            }
+
+        private:
+            template<typename R>
+            base_iterator_of<R> make_begin(R &range, std::true_type) const { return range.begin(); }
+            template<typename R>
+            base_iterator_of<R> make_end(R &range, std::true_type) const {
+                auto first = range.begin();
+                return first + static_cast<difference_type>(std::min<std::size_t>(static_cast<std::size_t>(range.end() - first), count_));
+            }
+            template<typename R>
+            counted_iterator<base_iterator_of<R>> make_begin(R &range, std::false_type) const {
+                return counted_iterator<base_iterator_of<R>>{range.begin(), count_};
+            }
+            template<typename R>
+            counted_iterator<base_iterator_of<R>> make_end(R &range, std::false_type) const {
+                return counted_iterator<base_iterator_of<R>>::sentinel(range.end());
+            }
+
+            std::size_t count_;
+        };
+
+        // The elements after the first `n`. A random access range jumps there in O(1), other ranges step over them on
+        // the first `begin()`, whose result is cached for the next ones.
+        template<typename Range>
+        class drop_view : public owning_view<Range> {
+        public:
+            using iterator = base_iterator_of<Range>;
+            using const_iterator = base_iterator_of<const Range>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            drop_view(Range &&range, std::size_t count) noexcept : owning_view<Range>(std::move(range)), count_(count) {}
+
+            drop_view(drop_view &&other) noexcept : owning_view<Range>(std::move(other)), count_(other.count_) {}
+            drop_view &operator=(drop_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    count_ = other.count_;
+                    begin_.reset();
+                    const_begin_.reset();
+                }
+
+                return *this;
+            }
+
+            drop_view(const drop_view &) = delete;
+            drop_view &operator=(const drop_view &) = delete;
+
+            iterator begin() { return find_begin(this->_r, begin_, is_random_access_iterator<iterator> {}); }
+            iterator end() { return this->_r.end(); }
+            const_iterator begin() const { return find_begin(this->_r, const_begin_, is_random_access_iterator<const_iterator> {}); }
+            const_iterator end() const { return this->_r.end(); }
+
+            constexpr std::size_t count() const noexcept { return count_; }
+
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size() const {
+                return this->_r.size() - std::min<size_type>(this->_r.size(), count_);
+            }
+            template<typename R = Range>
+            constexpr typename std::enable_if<has_size_hint<const R>::value, size_type>::type size_hint() const {
+                return this->_r.size_hint() - std::min<size_type>(this->_r.size_hint(), count_);
+            }
+
+        private:
+            template<typename R, typename It>
+            It find_begin(R &range, cached_position<It> &, std::true_type) const {
+                const It first = range.begin();
+                return first + static_cast<difference_type>(std::min<std::size_t>(static_cast<std::size_t>(range.end() - first), count_));
+            }
+            template<typename R, typename It>
+            It find_begin(R &range, cached_position<It> &cache, std::false_type) const {
+                return cache.get([this, &range] {
+                    It first = range.begin();
+                    const It last = range.end();
+                    for (std::size_t n = count_; n != 0 && first != last; --n) {
+                        ++first;
+                    }
+                    return first;
+                });
+            }
+
+            std::size_t count_;
+            cached_position<iterator> begin_;
+            mutable cached_position<const_iterator> const_begin_;
+        };
+
+        // Every `stride`th element, from the first. Random access iterators step in O(1), clamped to the end.
+        template<typename Iter>
+        class stride_iterator {
+        public:
+            using iterator_category = typename std::common_type<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>::type;
+            using value_type = typename std::iterator_traits<Iter>::value_type;
+            using difference_type = typename std::iterator_traits<Iter>::difference_type;
+            using pointer = typename std::iterator_traits<Iter>::pointer;
+            using reference = typename std::iterator_traits<Iter>::reference;
+
+            stride_iterator() : current_(), end_(), stride_(1) {}
+            stride_iterator(Iter current, Iter end, std::size_t stride) : current_(std::move(current)), end_(std::move(end)), stride_(stride) {}
+
+            reference operator*() const { return *current_; }
+
+            stride_iterator &operator++() {
+                advance(is_random_access_iterator<Iter> {});
+                return *this;
+            }
+            stride_iterator operator++(int) {
+                stride_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(const stride_iterator &lhs, const stride_iterator &rhs) { return lhs.current_ == rhs.current_; }
+            friend bool operator!=(const stride_iterator &lhs, const stride_iterator &rhs) { return !(lhs == rhs); }
+
+        private:
+            void advance(std::true_type) {
+                current_ += static_cast<difference_type>(std::min<std::size_t>(static_cast<std::size_t>(end_ - current_), stride_));
+            }
+            void advance(std::false_type) {
+                for (std::size_t n = stride_; n != 0 && current_ != end_; --n) {
+                    ++current_;
+                }
+            }
+
+            Iter current_;
+            Iter end_;
+            std::size_t stride_;
+        };
+
+        template<typename Range>
+        class stride_view : public owning_view<Range> {
+        public:
+            using iterator = stride_iterator<base_iterator_of<Range>>;
+            using const_iterator = stride_iterator<base_iterator_of<const Range>>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            stride_view(Range &&range, std::size_t stride) : owning_view<Range>(std::move(range)), stride_(stride) {
+                if (stride_ == 0)
+                    throw std::invalid_argument("Stride must be positive.");
+            }
+
+            stride_view(stride_view &&other) noexcept : owning_view<Range>(std::move(other)), stride_(other.stride_) {}
+            stride_view &operator=(stride_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    stride_ = other.stride_;
+                }
+
+                return *this;
+            }
+
+            stride_view(const stride_view &) = delete;
+            stride_view &operator=(const stride_view &) = delete;
+
+            iterator begin() { return iterator{this->_r.begin(), this->_r.end(), stride_}; }
+            iterator end() { return iterator{this->_r.end(), this->_r.end(), stride_}; }
+            const_iterator begin() const { return const_iterator{this->_r.begin(), this->_r.end(), stride_}; }
+            const_iterator end() const { return const_iterator{this->_r.end(), this->_r.end(), stride_}; }
+
+            constexpr std::size_t stride() const noexcept { return stride_; }
+
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size() const {
+                return (this->_r.size() + stride_ - 1) / stride_;
+            }
+
+        private:
+            std::size_t stride_;
+        };
+
+        // Iterator of `take_while_view`: the first element failing the predicate jumps straight to the end, without
+        // reading the rest of the range
+        template<typename Iter, typename Pred>
+        class take_while_iterator : private callable_box<callable_t<Pred>> {
+        public:
+            using iterator_category = typename std::common_type<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>::type;
+            using value_type = typename std::iterator_traits<Iter>::value_type;
+            using difference_type = typename std::iterator_traits<Iter>::difference_type;
+            using pointer = typename std::iterator_traits<Iter>::pointer;
+            using reference = typename std::iterator_traits<Iter>::reference;
+            using function_type = callable_t<Pred>;
+
+            take_while_iterator() = default;
+            take_while_iterator(Iter current, Iter end, const function_type &pred) :
+                callable_box<function_type>(pred), current_(std::move(current)), end_(std::move(end)) {
+                satisfy();
+            }
+
+            reference operator*() const { return *current_; }
+
+            take_while_iterator &operator++() {
+                ++current_;
+                satisfy();
+                return *this;
+            }
+            take_while_iterator operator++(int) {
+                take_while_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(const take_while_iterator &lhs, const take_while_iterator &rhs) { return lhs.current_ == rhs.current_; }
+            friend bool operator!=(const take_while_iterator &lhs, const take_while_iterator &rhs) { return !(lhs == rhs); }
+
+        private:
+            void satisfy() {
+                if (current_ != end_ && !this->get()(*current_))
+                    current_ = end_;
+            }
+
+            Iter current_;
+            Iter end_;
+        };
+
+        // The leading elements satisfying a predicate
+        template<typename Range, typename Pred>
+        class take_while_view : public owning_view<Range>, private callable_box<callable_t<Pred>> {
+        public:
+            using function_type = callable_t<Pred>;
+            using iterator = take_while_iterator<base_iterator_of<Range>, Pred>;
+            using const_iterator = take_while_iterator<base_iterator_of<const Range>, Pred>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            take_while_view(Range &&range, const Pred &pred) : owning_view<Range>(std::move(range)), callable_box<function_type>(pred) {}
+
+            take_while_view(take_while_view &&other) noexcept : owning_view<Range>(std::move(other)), callable_box<function_type>(other) {}
+            take_while_view &operator=(take_while_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    callable_box<function_type>::operator=(other);
+                }
+
+                return *this;
+            }
+
+            take_while_view(const take_while_view &) = delete;
+            take_while_view &operator=(const take_while_view &) = delete;
+
+            iterator begin() { return iterator{this->_r.begin(), this->_r.end(), this->get()}; }
+            iterator end() { return iterator{this->_r.end(), this->_r.end(), this->get()}; }
+            const_iterator begin() const { return const_iterator{this->_r.begin(), this->_r.end(), this->get()}; }
+            const_iterator end() const { return const_iterator{this->_r.end(), this->_r.end(), this->get()}; }
+
+            constexpr const function_type &predicate() const noexcept { return this->get(); }
+
+            // Unknown until the view is traversed
+            size_type size() const = delete;
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size_hint() const { return this->_r.size(); }
+        };
+
+        // The elements from the first one failing a predicate, which the first `begin()` searches for and caches
+        template<typename Range, typename Pred>
+        class drop_while_view : public owning_view<Range>, private callable_box<callable_t<Pred>> {
+        public:
+            using function_type = callable_t<Pred>;
+            using iterator = base_iterator_of<Range>;
+            using const_iterator = base_iterator_of<const Range>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            drop_while_view(Range &&range, const Pred &pred) : owning_view<Range>(std::move(range)), callable_box<function_type>(pred) {}
+
+            drop_while_view(drop_while_view &&other) noexcept : owning_view<Range>(std::move(other)), callable_box<function_type>(other) {}
+            drop_while_view &operator=(drop_while_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    callable_box<function_type>::operator=(other);
+                    begin_.reset();
+                    const_begin_.reset();
+                }
+
+                return *this;
+            }
+
+            drop_while_view(const drop_while_view &) = delete;
+            drop_while_view &operator=(const drop_while_view &) = delete;
+
+            iterator begin() { return begin_.get([this] { return skip(this->_r.begin(), this->_r.end()); }); }
+            iterator end() { return this->_r.end(); }
+            const_iterator begin() const { return const_begin_.get([this] { return skip(this->_r.begin(), this->_r.end()); }); }
+            const_iterator end() const { return this->_r.end(); }
+
+            constexpr const function_type &predicate() const noexcept { return this->get(); }
+
+            // Unknown until the view is traversed
+            size_type size() const = delete;
+            template<typename R = Range>
+            constexpr typename std::enable_if<sized<const R>::value, size_type>::type size_hint() const { return this->_r.size(); }
+
+        private:
+            template<typename It>
+            It skip(It first, It last) const {
+                while (first != last && this->get()(*first)) {
+                    ++first;
+                }
+                return first;
+            }
+
+            cached_position<iterator> begin_;
+            mutable cached_position<const_iterator> const_begin_;
+        };
+
+        // `range | take(n)`, `range | drop(n)`, `range | slice(first, last)` and `range | stride(n)`, and the window views
+        // `range | sliding(n)` and `range | tumbling(n)`. Lvalue ranges are referenced and rvalue ranges are moved into
+        // the view.
+        template<template<typename> class View>
+        class count_adaptor : public adaptor_closure {
+        public:
+            constexpr explicit count_adaptor(std::size_t count) noexcept : count_(count) {}
+
+            constexpr std::size_t count() const noexcept { return count_; }
+
+        private:
+            template<typename Range>
+            View<ref_view_of<Range>> apply(Range &range) const {
+                return View<ref_view_of<Range>>{as_ref_view(range), count_};
+            }
+            template<typename Range>
+            typename std::enable_if<!std::is_lvalue_reference<Range>::value, View<Range>>::type apply(Range &&range) const {
+                return View<Range>{std::move(range), count_};
+            }
+
+            std::size_t count_;
+
+        public:
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const count_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<count_adaptor, Next> operator|(const count_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<count_adaptor, Next>{adaptor, next};
+            }
+        };
+        using take_adaptor = count_adaptor<take_view>;
+        using drop_adaptor = count_adaptor<drop_view>;
+        using stride_adaptor = count_adaptor<stride_view>;
+        using slice_adaptor = adaptor_pipeline<drop_adaptor, take_adaptor>;
+
+        // `range | take_while(pred)` and `range | drop_while(pred)`
+        template<template<typename, typename> class View, typename Pred>
+        class predicate_adaptor : public adaptor_closure, private callable_storage<typename std::decay<Pred>::type> {
+        public:
+            using function_type = typename std::decay<Pred>::type;
+
+            constexpr explicit predicate_adaptor(const function_type &pred) : callable_storage<function_type>(pred) {}
+
+            constexpr const function_type &predicate() const noexcept { return this->get(); }
+
+        private:
+            template<typename Range>
+            View<ref_view_of<Range>, function_type> apply(Range &range) const {
+                return View<ref_view_of<Range>, function_type>{as_ref_view(range), predicate()};
+            }
+            template<typename Range>
+            typename std::enable_if<!std::is_lvalue_reference<Range>::value, View<Range, function_type>>::type apply(Range &&range) const {
+                return View<Range, function_type>{std::move(range), predicate()};
+            }
+
+        public:
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const predicate_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<predicate_adaptor, Next> operator|(const predicate_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<predicate_adaptor, Next>{adaptor, next};
+            }
+        };
+        template<typename Pred>
+        using take_while_adaptor = predicate_adaptor<take_while_view, Pred>;
+        template<typename Pred>
+        using drop_while_adaptor = predicate_adaptor<drop_while_view, Pred>;
+
+        // Positions of the set bits of a selection bitmask, lowest first: bit `j` of word `w` selects element `64 * w + j`
+        template<typename T>
+        class selection_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename std::remove_cv<T>::type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T *;
+            using reference = T &;
+
+            selection_iterator() noexcept : data_(nullptr), first_(nullptr), word_(nullptr), last_(nullptr), bits_(0) {}
+            selection_iterator(T *data, const std::uint64_t *first, const std::uint64_t *word, const std::uint64_t *last) noexcept :
+                data_(data), first_(first), word_(word), last_(last), bits_(word != last ? *word : 0) {
+                skip_empty_words();
+            }
+
+            reference operator*() const noexcept {
+                return data_[static_cast<std::size_t>(word_ - first_) * 64 + count_trailing_zeros(bits_)];
+            }
+            pointer operator->() const noexcept { return std::addressof(**this); }
+
+            selection_iterator &operator++() noexcept {
+                bits_ &= bits_ - 1;
+                skip_empty_words();
+                return *this;
+            }
+            selection_iterator operator++(int) noexcept {
+                selection_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(const selection_iterator &lhs, const selection_iterator &rhs) noexcept {
+                return lhs.word_ == rhs.word_ && lhs.bits_ == rhs.bits_;
+            }
+            friend bool operator!=(const selection_iterator &lhs, const selection_iterator &rhs) noexcept { return !(lhs == rhs); }
+
+        private:
+            void skip_empty_words() noexcept {
+                while (bits_ == 0 && word_ != last_) {
+                    ++word_;
+                    bits_ = word_ != last_ ? *word_ : 0;
+                }
+            }
+
+            T *data_;
+            const std::uint64_t *first_;
+            const std::uint64_t *word_;
+            const std::uint64_t *last_;
+            std::uint64_t bits_;
+        };
+
+        // Filter over a contiguous range that evaluates the predicate once, when the view is created, in a branch-free
+        // pass storing one bit per element. Iteration then jumps between the selected elements and the number of
+        // matches is known up front, so `to<>` reserves exactly. Modifying the range afterwards does not update it.
+        template<typename Range, typename Pred>
+        class selection_view : public owning_view<Range> {
+            static_assert(is_contiguous_range<underlying_t<Range>>::value, "Selection filtering needs a contiguous range");
+
+            template<typename R>
+            using element_of = typename std::remove_pointer<decltype(std::declval<underlying_t<R> &>().data())>::type;
+
+        public:
+            using iterator = selection_iterator<element_of<Range>>;
+            using const_iterator = selection_iterator<element_of<const Range>>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+            using size_type = typename owning_view<Range>::size_type;
+
+            selection_view(Range &&range, const Pred &pred) : owning_view<Range>(std::move(range)), count_(0) {
+                const auto &base = underlying(this->_r);
+                const std::size_t size = base.size();
+                const auto *data = base.data();
+                mask_.resize((size + 63) / 64);
+                // The predicate results of a word are stored as bytes first, a loop the compiler can vectorize, then
+                // packed eight at a time: multiplying eight 0/1 bytes by 0x0102040810204080 gathers them in the top byte
+                unsigned char flags[64];
+                for (std::size_t word = 0; word < mask_.size(); ++word) {
+                    const std::size_t first = word * 64;
+                    const std::size_t count = std::min<std::size_t>(64, size - first);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        flags[i] = static_cast<bool>(pred(data[first + i]));
+                    }
+                    std::fill(flags + count, flags + 64, static_cast<unsigned char>(0));
+
+                    std::uint64_t bits = 0;
+                    for (std::size_t byte = 0; byte < 8; ++byte) {
+                        std::uint64_t packed;
+                        std::memcpy(&packed, flags + byte * 8, sizeof(packed));
+                        bits |= ((packed * 0x0102040810204080ull) >> 56) << (byte * 8);
+                    }
+                    mask_[word] = bits;
+                    count_ += popcount(bits);
+                }
+            }
+
+            selection_view(selection_view &&other) noexcept :
+                owning_view<Range>(std::move(other)), mask_(std::move(other.mask_)), count_(other.count_) {}
+            selection_view &operator=(selection_view &&other) noexcept {
+                if (&other != this) {
+                    owning_view<Range>::operator=(std::move(other));
+                    mask_ = std::move(other.mask_);
+                    count_ = other.count_;
+                }
+
+                return *this;
+            }
+
+            selection_view(const selection_view &) = delete;
+            selection_view &operator=(const selection_view &) = delete;
+
+            iterator begin() { return iterator(underlying(this->_r).data(), mask_.data(), mask_.data(), mask_.data() + mask_.size()); }
+            iterator end() { return iterator(underlying(this->_r).data(), mask_.data(), mask_.data() + mask_.size(), mask_.data() + mask_.size()); }
+            const_iterator begin() const { return const_iterator(underlying(this->_r).data(), mask_.data(), mask_.data(), mask_.data() + mask_.size()); }
+            const_iterator end() const { return const_iterator(underlying(this->_r).data(), mask_.data(), mask_.data() + mask_.size(), mask_.data() + mask_.size()); }
+
+            // Number of selected elements
+            constexpr size_type size() const noexcept { return count_; }
+            constexpr bool empty() const noexcept { return count_ == 0; }
+
+            // One bit per element of the range, 64 elements per word
+            constexpr const std::vector<std::uint64_t> &mask() const noexcept { return mask_; }
+
+        private:
+            std::vector<std::uint64_t> mask_;
+            size_type count_;
+        };
+
+        // `range | filter(selection, pred)`
+        template<typename Pred>
+        class selection_adaptor : public adaptor_closure, private callable_storage<typename std::decay<Pred>::type> {
+        public:
+            using function_type = typename std::decay<Pred>::type;
+
+            constexpr explicit selection_adaptor(const function_type &pred) : callable_storage<function_type>(pred) {}
+
+            constexpr const function_type &predicate() const noexcept { return this->get(); }
+
+        private:
+            template<typename Range>
+            selection_view<ref_view_of<Range>, function_type> apply(Range &range) const {
+                return selection_view<ref_view_of<Range>, function_type>{as_ref_view(range), predicate()};
+            }
+            template<typename Range>
+            typename std::enable_if<!std::is_lvalue_reference<Range>::value, selection_view<Range, function_type>>::type
+            apply(Range &&range) const {
+                return selection_view<Range, function_type>{std::move(range), predicate()};
+            }
+
+        public:
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const selection_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<selection_adaptor, Next> operator|(const selection_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<selection_adaptor, Next>{adaptor, next};
+            }
+        };
+
+        // Lines of a text buffer without their `\n` (nor a `\r` before it), as `std::getline` splits them but without
+        // copying. A last line without a newline is yielded too, a trailing newline does not start an empty line.
+        class lines_view {
+        public:
+            class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = string_view;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const string_view *;
+                using reference = string_view;
+
+                iterator() noexcept : line_(nullptr), line_end_(nullptr), end_(nullptr) {}
+                iterator(const char *position, const char *end) noexcept : line_(position), line_end_(find_end(position, end)), end_(end) {}
+
+                reference operator*() const noexcept {
+                    const char *last = line_end_ != line_ && line_end_[-1] == '\r' ? line_end_ - 1 : line_end_;
+                    return string_view(line_, static_cast<std::size_t>(last - line_));
+                }
+
+                iterator &operator++() noexcept {
+                    line_ = line_end_ == end_ ? end_ : line_end_ + 1;
+                    line_end_ = find_end(line_, end_);
+                    return *this;
+                }
+                iterator operator++(int) noexcept {
+                    iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) noexcept { return lhs.line_ == rhs.line_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) noexcept { return lhs.line_ != rhs.line_; }
+
+            private:
+                static const char *find_end(const char *position, const char *end) noexcept {
+                    const void *newline = position == end ? nullptr : std::memchr(position, '\n', static_cast<std::size_t>(end - position));
+                    return newline != nullptr ? static_cast<const char *>(newline) : end;
+                }
+
+                const char *line_;
+                const char *line_end_;
+                const char *end_;
+            };
+            using const_iterator = iterator;
+            using value_type = string_view;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const string_view *;
+            using reference = string_view;
+
+            lines_view() noexcept = default;
+            explicit lines_view(string_view text) noexcept : text_(text) {}
+
+            iterator begin() const noexcept { return iterator(text_.data(), text_.data() + text_.size()); }
+            iterator end() const noexcept { return iterator(text_.data() + text_.size(), text_.data() + text_.size()); }
+            bool empty() const noexcept { return text_.empty(); }
+
+            string_view base() const noexcept { return text_; }
+
+        private:
+            string_view text_;
+        };
+
+        // Fixed-size binary records of a trivially copyable `T` stored back to back in a byte buffer. Records are copied
+        // out with `memcpy`, so the buffer needs no particular alignment. A trailing partial record is ignored.
+        template<typename T>
+        class records_view {
+            static_assert(std::is_trivially_copyable<T>::value, "Records must be trivially copyable");
+
+        public:
+            class iterator {
+            public:
+                using iterator_category = std::random_access_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = T;
+
+                iterator() noexcept : position_(nullptr) {}
+                explicit iterator(const char *position) noexcept : position_(position) {}
+
+                reference operator*() const noexcept {
+                    T record;
+                    std::memcpy(&record, position_, sizeof(T));
+                    return record;
+                }
+                reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+                iterator &operator++() noexcept {
+                    position_ += sizeof(T);
+                    return *this;
+                }
+                iterator operator++(int) noexcept {
+                    iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+                iterator &operator--() noexcept {
+                    position_ -= sizeof(T);
+                    return *this;
+                }
+                iterator operator--(int) noexcept {
+                    iterator tmp = *this;
+                    --*this;
+                    return tmp;
+                }
+                iterator &operator+=(difference_type n) noexcept {
+                    position_ += n * static_cast<difference_type>(sizeof(T));
+                    return *this;
+                }
+                iterator &operator-=(difference_type n) noexcept { return *this += -n; }
+
+                friend iterator operator+(iterator it, difference_type n) noexcept { return it += n; }
+                friend iterator operator+(difference_type n, iterator it) noexcept { return it += n; }
+                friend iterator operator-(iterator it, difference_type n) noexcept { return it -= n; }
+                friend difference_type operator-(const iterator &lhs, const iterator &rhs) noexcept {
+                    return (lhs.position_ - rhs.position_) / static_cast<difference_type>(sizeof(T));
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) noexcept { return lhs.position_ == rhs.position_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) noexcept { return lhs.position_ != rhs.position_; }
+                friend bool operator<(const iterator &lhs, const iterator &rhs) noexcept { return lhs.position_ < rhs.position_; }
+                friend bool operator>(const iterator &lhs, const iterator &rhs) noexcept { return rhs < lhs; }
+                friend bool operator<=(const iterator &lhs, const iterator &rhs) noexcept { return !(rhs < lhs); }
+                friend bool operator>=(const iterator &lhs, const iterator &rhs) noexcept { return !(lhs < rhs); }
+
+            private:
+                const char *position_;
+            };
+            using const_iterator = iterator;
+            using value_type = T;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = T;
+
+            records_view() noexcept = default;
+            explicit records_view(string_view bytes) noexcept : bytes_(bytes) {}
+
+            iterator begin() const noexcept { return iterator(bytes_.data()); }
+            iterator end() const noexcept { return iterator(bytes_.data() + size() * sizeof(T)); }
+            size_type size() const noexcept { return bytes_.size() / sizeof(T); }
+            bool empty() const noexcept { return size() == 0; }
+            T operator[](size_type i) const noexcept { return begin()[static_cast<difference_type>(i)]; }
+
+        private:
+            string_view bytes_;
+        };
+
+        // Tuple of references returned by `zip_iterator`. Assignment writes through to the zipped elements and `swap`
+        // exchanges them, so algorithms that permute elements (`std::sort`, `std::nth_element`) work on zipped ranges.
+        template<typename... Refs>
+        class zip_reference : public std::tuple<Refs...> {
+        public:
+            using base_type = std::tuple<Refs...>;
+
+            explicit zip_reference(Refs... refs) : base_type(std::forward<Refs>(refs)...) {}
+            zip_reference(const zip_reference &) = default;
+
+            zip_reference &operator=(const zip_reference &other) {
+                base_type::operator=(static_cast<const base_type &>(other));
+                return *this;
+            }
+            template<typename... Ts>
+            zip_reference &operator=(const std::tuple<Ts...> &values) {
+                base_type::operator=(values);
+                return *this;
+            }
+            template<typename... Ts>
+            zip_reference &operator=(std::tuple<Ts...> &&values) {
+                base_type::operator=(std::move(values));
+                return *this;
+            }
+
+            friend void swap(zip_reference &&lhs, zip_reference &&rhs) {
+                lhs.swap_elements(rhs, make_index_sequence<sizeof...(Refs)> {});
+            }
+            friend void swap(zip_reference &lhs, zip_reference &rhs) {
+                lhs.swap_elements(rhs, make_index_sequence<sizeof...(Refs)> {});
+            }
+
+        private:
+            template<std::size_t... Is>
+            void swap_elements(zip_reference &other, index_sequence<Is...>) {
+                using std::swap;
+                using swallow = int[];
+                (void) swallow {0, (swap(std::get<Is>(*this), std::get<Is>(other)), 0)...};
+            }
+        };
+
+        // Iterates any number of ranges in lockstep. When every iterator is random access the enclosing `zip` moves its
+        // end to the length of the shortest range, so comparing the first iterator is enough; otherwise two iterators
+        // compare equal as soon as one of their positions does, which stops iteration at the shortest range. Such an end
+        // cannot be decremented, so without random access a zip is a forward range, as finding the end of the shortest
+        // range would take a pass over it up front.
+        template<typename... Iters>
+        class zip_iterator {
+        public:
+            using iterator_category = typename std::conditional<
+                std::is_same<common_iterator_category<Iters...>, std::random_access_iterator_tag>::value, std::random_access_iterator_tag,
+                typename std::common_type<std::forward_iterator_tag, common_iterator_category<Iters...>>::type>::type;
+            using value_type = std::tuple<typename std::iterator_traits<Iters>::value_type...>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = zip_reference<typename std::iterator_traits<Iters>::reference...>;
+            using base_type = std::tuple<Iters...>;
+
+            zip_iterator() = default;
+
+            explicit zip_iterator(Iters... iters) : current_(std::move(iters)...) {}
+
+            reference operator*() const { return dereference(indices {}); }
+            pointer operator->() const = delete;
+
+            // Underlying iterators, one per zipped range
+            constexpr const base_type &base() const noexcept { return current_; }
+
+            zip_iterator &operator++() {
+                advance(1, indices {});
+                return *this;
+            }
+
+            zip_iterator operator++(int) {
+                zip_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            zip_iterator &operator--() {
+                advance(-1, indices {});
+                return *this;
+            }
+
+            zip_iterator operator--(int) {
+                zip_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            zip_iterator &operator+=(difference_type n) {
+                advance(n, indices {});
+                return *this;
+            }
+
+            zip_iterator &operator-=(difference_type n) {
+                advance(-n, indices {});
+                return *this;
+            }
+
+            reference operator[](difference_type n) const { return subscript(n, indices {}); }
+
+            friend zip_iterator operator+(zip_iterator it, difference_type n) { return it += n; }
+            friend zip_iterator operator+(difference_type n, zip_iterator it) { return it += n; }
+            friend zip_iterator operator-(zip_iterator it, difference_type n) { return it -= n; }
+
+            constexpr friend difference_type operator-(const zip_iterator &lhs, const zip_iterator &rhs) {
+                return std::get<0>(lhs.current_) - std::get<0>(rhs.current_);
+            }
+
+            friend bool operator==(const zip_iterator &lhs, const zip_iterator &rhs) {
+                return lhs.equals(rhs, std::is_same<std::random_access_iterator_tag, iterator_category> {});
+            }
+
+            friend bool operator!=(const zip_iterator &lhs, const zip_iterator &rhs) { return !(lhs == rhs); }
+
+            constexpr friend bool operator<(const zip_iterator &lhs, const zip_iterator &rhs) {
+                return std::get<0>(lhs.current_) < std::get<0>(rhs.current_);
+            }
+            constexpr friend bool operator>(const zip_iterator &lhs, const zip_iterator &rhs) { return rhs < lhs; }
+            constexpr friend bool operator<=(const zip_iterator &lhs, const zip_iterator &rhs) { return !(rhs < lhs); }
+            constexpr friend bool operator>=(const zip_iterator &lhs, const zip_iterator &rhs) { return !(lhs < rhs); }
+
+        private:
+            using indices = make_index_sequence<sizeof...(Iters)>;
+
+            template<std::size_t... Is>
+            reference dereference(index_sequence<Is...>) const {
+                return reference(*std::get<Is>(current_)...);
+            }
+            template<std::size_t... Is>
+            reference subscript(difference_type n, index_sequence<Is...>) const {
+                return reference(std::get<Is>(current_)[n]...);
+            }
+
+            template<std::size_t... Is>
+            void advance(difference_type n, index_sequence<Is...>) {
+                using swallow = int[];
+                (void) swallow {0, (std::advance(std::get<Is>(current_), n), 0)...};
+            }
+
+            bool equals(const zip_iterator &other, std::true_type) const {
+                return std::get<0>(current_) == std::get<0>(other.current_);
+            }
+            bool equals(const zip_iterator &other, std::false_type) const {
+                return any_equal(other, std::integral_constant<std::size_t, 0> {});
+            }
+
+            bool any_equal(const zip_iterator &, std::integral_constant<std::size_t, sizeof...(Iters)>) const { return false; }
+            template<std::size_t I>
+            bool any_equal(const zip_iterator &other, std::integral_constant<std::size_t, I>) const {
+                return std::get<I>(current_) == std::get<I>(other.current_) ||
+                       any_equal(other, std::integral_constant<std::size_t, I + 1> {});
+            }
+
+            base_type current_;
+        };
+
+        // Zips any number of ranges, stopping at the shortest one. Sized and random access when every range is.
+        template<typename... Ranges>
+        class zip {
+            static_assert(sizeof...(Ranges) > 0, "zip needs at least one range");
+
+        public:
+            using iterator = zip_iterator<decltype(std::begin(std::declval<Ranges &>()))...>;
+            using value_type = typename std::iterator_traits<iterator>::value_type;
+            using difference_type = typename std::iterator_traits<iterator>::difference_type;
+            using pointer = typename std::iterator_traits<iterator>::pointer;
+            using reference = typename std::iterator_traits<iterator>::reference;
+
+            zip() = default;
+
+            explicit zip(Ranges &... ranges) :
+                begin_it(std::begin(ranges)...), end_it(end_of(is_random_access_iterator<iterator> {}, ranges...)) {}
+
+            zip(Ranges &&...) = delete;
+
+            iterator& begin() { return begin_it; }
+            iterator& end() { return end_it; }
+            iterator begin() const { return begin_it; }
+            iterator end() const { return end_it; }
+
+            template<typename It = iterator>
+            constexpr typename std::enable_if<is_random_access_iterator<It>::value, std::size_t>::type size() const {
+                return static_cast<std::size_t>(end_it - begin_it);
+            }
+
+        private:
+            static iterator end_of(std::true_type, Ranges &... ranges) {
+                const difference_type length = std::min({static_cast<difference_type>(std::distance(std::begin(ranges), std::end(ranges)))...});
+                return iterator(std::next(std::begin(ranges), length)...);
+            }
+            // Other ranges keep their own ends, reached when the shortest one is
+            static iterator end_of(std::false_type, Ranges &... ranges) {
+                return iterator(std::end(ranges)...);
+            }
+
+            iterator begin_it;
+            iterator end_it;
+        };
+
+    } // namespace _decl
+
+    namespace execution {
+        struct sequenced_policy {};
+
+        // `concurrency` caps the number of threads used, the calling one included; 0 means one per hardware thread.
+        // It is itself capped at one per hardware thread, since the pool never grows past that, e.g. `par(256)` on 8
+        // hardware threads runs on 8 of them.
+        // `deterministic` makes `reduce`, `transform_reduce` and the scans split the input into blocks of a fixed size
+        // instead of a few per thread, so floating point results are bit for bit the same whatever the concurrency.
+        struct parallel_policy {
+            std::size_t concurrency;
+            bool deterministic;
+
+            constexpr parallel_policy operator()(std::size_t threads) const noexcept { return parallel_policy {threads, deterministic}; }
+        };
+        // Like `parallel_policy`, but chunks only check for cancellation between chunks, so their loops can vectorize
+        struct parallel_unsequenced_policy {
+            std::size_t concurrency;
+            bool deterministic;
+
+            constexpr parallel_unsequenced_policy operator()(std::size_t threads) const noexcept {
+                return parallel_unsequenced_policy {threads, deterministic};
+            }
+        };
+
+        constexpr sequenced_policy seq {};
+        constexpr parallel_policy par {0, false};
+        constexpr parallel_unsequenced_policy par_unseq {0, false};
+
+        // `policy` with reproducible reductions, e.g. `deterministic(par(8))`; sequential ones always are
+        constexpr sequenced_policy deterministic(sequenced_policy policy) noexcept { return policy; }
+        constexpr parallel_policy deterministic(parallel_policy policy) noexcept { return parallel_policy {policy.concurrency, true}; }
+        constexpr parallel_unsequenced_policy deterministic(parallel_unsequenced_policy policy) noexcept {
+            return parallel_unsequenced_policy {policy.concurrency, true};
+        }
+
+        template<typename T>
+        struct is_execution_policy : std::false_type {};
+        template<>
+        struct is_execution_policy<sequenced_policy> : std::true_type {};
+        template<>
+        struct is_execution_policy<parallel_policy> : std::true_type {};
+        template<>
+        struct is_execution_policy<parallel_unsequenced_policy> : std::true_type {};
+    } // namespace execution
+
+    template<typename Policy, typename R>
+    using enable_if_execution_policy = typename std::enable_if<execution::is_execution_policy<typename std::decay<Policy>::type>::value, R>::type;
+    // Keeps the sequential overloads whose parameters have defaults out of the calls with a policy
+    template<typename T, typename R>
+    using enable_if_not_execution_policy = typename std::enable_if<!execution::is_execution_policy<typename std::decay<T>::type>::value, R>::type;
+
+    class thread_pool {
+    public:
+        // `reserve` may later grow the pool up to one thread per hardware thread, or to `workers + 1` if that is more
+        explicit thread_pool(std::size_t workers = 0) :
+            max_concurrency_(std::max<std::size_t>(workers + 1, std::thread::hardware_concurrency())), stopping_(false) {
+            reserve(workers + 1);
+        }
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (auto &worker: workers_) {
+                worker.join();
+            }
+        }
+
+        thread_pool(const thread_pool &) = delete;
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        // Process-wide pool used by the parallel algorithms, with one thread per hardware thread
+        static thread_pool &instance() {
+            static thread_pool pool(std::max<std::size_t>(std::thread::hardware_concurrency(), 1) - 1);
+            return pool;
+        }
+
+        // Threads available to a `parallel_for`: the workers plus the calling thread
+        std::size_t concurrency() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return workers_.size() + 1;
+        }
+
+        // Adds workers until `concurrency` threads are available, but never past the size the pool was configured with.
+        // Workers are never removed, so asking for more threads than the hardware has would keep them idle for good.
+        void reserve(std::size_t concurrency) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (workers_.size() + 1 < std::min(concurrency, max_concurrency_)) {
+                workers_.emplace_back([this] { run(); });
+            }
+        }
+
+        // Calls `task(i)` for every `i` in [0, count) on at most `concurrency` threads (0 - all of them), the calling one
+        // included, and returns when every call finished. A `concurrency` past the size of the pool is capped to it.
+        // The first exception thrown by a task is rethrown here. Workers that pick the job up after the caller ran out
+        // of work leave immediately, so nesting cannot deadlock.
+        template<typename Task>
+        void parallel_for(std::size_t count, std::size_t concurrency, const Task &task) {
+            if (concurrency != 0)
+                reserve(concurrency);
+            concurrency = concurrency == 0 ? this->concurrency() : std::min(concurrency, this->concurrency());
+
+            const std::size_t helpers = std::min(concurrency, count) - (count != 0);
+            if (helpers == 0) {
+                for (std::size_t i{0}; i < count; ++i) {
+                    task(i);
+                }
+                return;
+            }
+
+            const std::shared_ptr<job> shared = std::make_shared<job>(count, &task, &invoke<Task>);
+            for (std::size_t i{0}; i < helpers; ++i) {
+                submit([shared] {
+                    {
+                        std::lock_guard<std::mutex> lock(shared->mutex);
+                        if (shared->closed)
+                            return;
+                        ++shared->running;
+                    }
+                    shared->drain();
+                    {
+                        std::lock_guard<std::mutex> lock(shared->mutex);
+                        --shared->running;
+                    }
+                    shared->finished.notify_all();
+                });
+            }
+
+            shared->drain();
+            std::unique_lock<std::mutex> lock(shared->mutex);
+            shared->closed = true;
+            shared->finished.wait(lock, [&shared] { return shared->running == 0; });
+            if (shared->error)
+                std::rethrow_exception(shared->error);
+        }
+
+    private:
+        struct job {
+            job(std::size_t count, const void *task, void (*call)(const void *, std::size_t)) noexcept :
+                next(0), count(count), task(task), call(call), running(0), closed(false) {}
+
+            void drain() noexcept {
+                try {
+                    for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+                        call(task, i);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                    next.store(count, std::memory_order_relaxed);
+                }
+            }
+
+            std::atomic<std::size_t> next;
+            const std::size_t count;
+            const void *task;
+            void (*call)(const void *, std::size_t);
+
+            std::mutex mutex;
+            std::condition_variable finished;
+            std::size_t running;
+            bool closed;
+            std::exception_ptr error;
+        };
+
+        template<typename Task>
+        static void invoke(const void *task, std::size_t i) {
+            (*static_cast<const Task *>(task))(i);
+        }
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            wake_.notify_one();
+        }
+
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                    if (tasks_.empty())
+                        return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::deque<std::function<void()>> tasks_;
+        std::vector<std::thread> workers_;
+        const std::size_t max_concurrency_;
+        bool stopping_;
+    };
+
+    // Bounded lock-free ring buffer for one producer thread and one consumer thread, as between the stages of a
+    // `pipeline`. The capacity is rounded up to a power of two. Each side caches the other's index, so the shared
+    // cache lines are only touched when the queue looks full or empty. Elements must be default constructible.
+    template<typename T>
+    class spsc_queue {
+    public:
+        explicit spsc_queue(std::size_t capacity) :
+            slots_(ring_capacity(capacity)), mask_(slots_.size() - 1), head_(0), cached_tail_(0), tail_(0), cached_head_(0) {}
+
+        spsc_queue(const spsc_queue &) = delete;
+        spsc_queue &operator=(const spsc_queue &) = delete;
+
+        // Producer side; returns false, leaving `value` untouched, when the queue is full
+        bool try_push(T &&value) {
+            const std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cached_head_ == slots_.size()) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail - cached_head_ == slots_.size())
+                    return false;
+            }
+            slots_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+        // Consumer side; returns false when the queue is empty
+        bool try_pop(T &value) {
+            const std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cached_tail_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head == cached_tail_)
+                    return false;
+            }
+            value = std::move(slots_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Approximate while both sides are running
+        std::size_t size() const noexcept {
+            const std::size_t head = head_.load(std::memory_order_acquire);
+            return tail_.load(std::memory_order_acquire) - head;
+        }
+        std::size_t capacity() const noexcept { return slots_.size(); }
+
+        static std::size_t ring_capacity(std::size_t capacity) noexcept {
+            std::size_t result = 2;
+            while (result < capacity) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+    private:
+        std::vector<T> slots_;
+        std::size_t mask_;
+        // Consumer and producer indices on separate cache lines
+        char pad0_[64];
+        std::atomic<std::size_t> head_;
+        std::size_t cached_tail_;
+        char pad1_[64];
+        std::atomic<std::size_t> tail_;
+        std::size_t cached_head_;
+        char pad2_[64];
+    };
+
+    // Bounded lock-free ring buffer for any number of producer and consumer threads (Vyukov's queue): every slot
+    // carries a sequence number telling which lap of the ring may write or read it next, so producers and consumers
+    // only contend on their own index. The capacity is rounded up to a power of two.
+    template<typename T>
+    class mpmc_queue {
+    public:
+        explicit mpmc_queue(std::size_t capacity) :
+            cells_(new cell[spsc_queue<T>::ring_capacity(capacity)]), mask_(spsc_queue<T>::ring_capacity(capacity) - 1), enqueue_(0), dequeue_(0) {
+            for (std::size_t i{0}; i <= mask_; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpmc_queue(const mpmc_queue &) = delete;
+        mpmc_queue &operator=(const mpmc_queue &) = delete;
+
+        // Returns false, leaving `value` untouched, when the queue is full
+        bool try_push(T &&value) {
+            std::size_t position = enqueue_.load(std::memory_order_relaxed);
+            for (;;) {
+                cell &slot = cells_[position & mask_];
+                const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t lap = static_cast<std::ptrdiff_t>(sequence - position);
+                if (lap == 0) {
+                    if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        slot.value = std::move(value);
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (lap < 0) {
+                    return false;
+                } else {
+                    position = enqueue_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+        // Returns false when the queue is empty
+        bool try_pop(T &value) {
+            std::size_t position = dequeue_.load(std::memory_order_relaxed);
+            for (;;) {
+                cell &slot = cells_[position & mask_];
+                const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t lap = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+                if (lap == 0) {
+                    if (dequeue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        value = std::move(slot.value);
+                        slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (lap < 0) {
+                    return false;
+                } else {
+                    position = dequeue_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Approximate while producers or consumers are running
+        std::size_t size() const noexcept {
+            const std::size_t dequeued = dequeue_.load(std::memory_order_acquire);
+            const std::size_t enqueued = enqueue_.load(std::memory_order_acquire);
+            return enqueued > dequeued ? std::min(enqueued - dequeued, mask_ + 1) : 0;
+        }
+        std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    private:
+        struct cell {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<cell[]> cells_;
+        std::size_t mask_;
+        char pad0_[64];
+        std::atomic<std::size_t> enqueue_;
+        char pad1_[64];
+        std::atomic<std::size_t> dequeue_;
+        char pad2_[64];
+    };
+
+#if RANGED_HAS_MMAP
+    // Read-only memory mapping of a whole file, e.g. the source of `lines` or `records`. Pages are read on first access
+    // and, being clean, can be dropped by the kernel under memory pressure, so files larger than RAM can be scanned.
+    // Throws `std::system_error` when the file cannot be opened or mapped.
+    class mapped_file {
+    public:
+        enum class access { normal, sequential, random };
+
+        explicit mapped_file(const std::string &path, access pattern = access::sequential) : data_(nullptr), size_(0) {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                const int error = errno;
+                throw std::system_error(error, std::generic_category(), "Cannot open " + path);
+            }
+
+            try {
+                map(fd, path);
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+            // The mapping keeps the file alive
+            ::close(fd);
+            advise(pattern);
+        }
+        // Maps the file open as `fd`, which stays open and owned by the caller, e.g. an already unlinked temporary file
+        explicit mapped_file(int fd, access pattern = access::sequential) : data_(nullptr), size_(0) {
+            map(fd, "descriptor " + std::to_string(fd));
+            advise(pattern);
+        }
+        mapped_file() noexcept : data_(nullptr), size_(0) {}
+        ~mapped_file() {
+            if (data_ != nullptr)
+                ::munmap(const_cast<char *>(data_), size_);
+        }
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        mapped_file(mapped_file &&other) noexcept : data_(other.data_), size_(other.size_) {
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        mapped_file &operator=(mapped_file &&other) noexcept {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            return *this;
+        }
+
+        const char *data() const noexcept { return data_; }
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+        const char *begin() const noexcept { return data_; }
+        const char *end() const noexcept { return data_ + size_; }
+
+        string_view view() const & noexcept { return string_view(data_, size_); }
+        string_view view() && = delete;
+        // Lets a mapped file be passed to `lines` and `records`. Not for temporaries, whose mapping is gone as soon as
+        // the view is returned.
+        operator string_view() const & noexcept { return view(); }
+        operator string_view() && = delete;
+
+        // Read-ahead hint: `sequential` reads ahead aggressively and lets the kernel free pages behind the reader
+        void advise(access pattern) const noexcept {
+            if (data_ != nullptr)
+                ::madvise(const_cast<char *>(data_), size_,
+                          pattern == access::sequential ? MADV_SEQUENTIAL : pattern == access::random ? MADV_RANDOM : MADV_NORMAL);
+        }
+
+        // Drops the whole pages before `position`, keeping the resident memory of a long scan bounded. Reading them
+        // again is still valid, it faults them back in from the file.
+        void release(const char *position) const noexcept {
+            const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            const std::size_t bytes = static_cast<std::size_t>(position - data_) / page * page;
+            if (bytes != 0)
+                ::madvise(const_cast<char *>(data_), bytes, MADV_DONTNEED);
+        }
+
+    private:
+        void map(int fd, const std::string &name) {
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                const int error = errno;
+                throw std::system_error(error, std::generic_category(), "Cannot stat " + name);
+            }
+            size_ = static_cast<std::size_t>(info.st_size);
+            // `mmap` rejects empty mappings, an empty file is an empty buffer
+            if (size_ != 0) {
+                void *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED) {
+                    const int error = errno;
+                    size_ = 0;
+                    throw std::system_error(error, std::generic_category(), "Cannot map " + name);
+                }
+                data_ = static_cast<const char *>(data);
+            }
+        }
+
+        const char *data_;
+        std::size_t size_;
+    };
+
+    // Scratch file in `directory` (`$TMPDIR` or `/tmp` when empty), unlinked as soon as it is created: its space is
+    // reclaimed when the descriptor is closed, even if the process is killed. Throws `std::system_error`, which names
+    // the file when it could not be unlinked and is left behind.
+    class temporary_file {
+    public:
+        explicit temporary_file(const std::string &directory = std::string()) : fd_(-1), size_(0) {
+            std::string path = (directory.empty() ? default_directory() : directory) + "/ranged-XXXXXX";
+            fd_ = ::mkstemp(&path[0]);
+            if (fd_ < 0) {
+                const int error = errno;
+                throw std::system_error(error, std::generic_category(), "Cannot create a temporary file in " + path);
+            }
+            if (::unlink(path.c_str()) != 0) {
+                const int error = errno;
+                ::close(fd_);
+                throw std::system_error(error, std::generic_category(), "Cannot unlink the temporary file " + path);
+            }
+            if (::fcntl(fd_, F_SETFD, FD_CLOEXEC) != 0) {
+                const int error = errno;
+                ::close(fd_);
+                throw std::system_error(error, std::generic_category(), "Cannot set close-on-exec on a temporary file");
+            }
+        }
+        ~temporary_file() {
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        temporary_file(const temporary_file &) = delete;
+        temporary_file &operator=(const temporary_file &) = delete;
+
+        temporary_file(temporary_file &&other) noexcept : fd_(exchange(other.fd_, -1)), size_(exchange(other.size_, 0)) {}
+        temporary_file &operator=(temporary_file &&other) noexcept {
+            std::swap(fd_, other.fd_);
+            std::swap(size_, other.size_);
+            return *this;
+        }
+
+        int descriptor() const noexcept { return fd_; }
+        // Bytes written so far
+        std::size_t size() const noexcept { return size_; }
+
+        void write(const void *data, std::size_t size) {
+            const char *position = static_cast<const char *>(data);
+            while (size != 0) {
+                const ::ssize_t written = ::write(fd_, position, size);
+                if (written < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "Cannot write a temporary file");
+                }
+                position += written;
+                size -= static_cast<std::size_t>(written);
+                size_ += static_cast<std::size_t>(written);
+            }
+        }
+
+        static std::string default_directory() {
+            const char *directory = std::getenv("TMPDIR");
+            return directory != nullptr && *directory != '\0' ? directory : "/tmp";
+        }
+
+    private:
+        int fd_;
+        std::size_t size_;
+    };
+#endif
+
+    // Bump allocator for short-lived intermediates, e.g. everything materialized while handling one request.
+    // Deallocation is a no-op and `reset` frees everything at once. Memory comes from an optional caller-provided
+    // buffer, then from blocks of growing size obtained from `operator new`. Not thread safe.
+    // With c++17 it is a `std::pmr::memory_resource`, so it can back `std::pmr` containers as well.
+    class monotonic_arena
+#if __cplusplus >= 201703L
+        : public std::pmr::memory_resource
+#endif
+    {
+    public:
+        explicit monotonic_arena(std::size_t block_size = 4096) noexcept :
+            buffer_(nullptr), buffer_size_(0), current_(nullptr), end_(nullptr), blocks_(nullptr), block_size_(std::max<std::size_t>(block_size, 64)), used_(0) {}
+        // Allocates from `buffer` (e.g. on the stack) until it is exhausted; the buffer is not owned
+        monotonic_arena(void *buffer, std::size_t size, std::size_t block_size = 4096) noexcept :
+            buffer_(static_cast<char *>(buffer)), buffer_size_(size), current_(buffer_), end_(buffer_ + size), blocks_(nullptr),
+            block_size_(std::max<std::size_t>(block_size, 64)), used_(0) {}
+        ~monotonic_arena() { release_blocks(nullptr); }
+
+        monotonic_arena(const monotonic_arena &) = delete;
+        monotonic_arena &operator=(const monotonic_arena &) = delete;
+
+        void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+            // The padding is checked against the space left before moving past it, which may be beyond `end_`
+            std::size_t padding = padding_for(current_, alignment);
+            const std::size_t available = static_cast<std::size_t>(end_ - current_);
+            if (current_ == nullptr || padding > available || bytes > available - padding) {
+                grow(bytes, alignment);
+                padding = padding_for(current_, alignment);
+            }
+            char *aligned = current_ + padding;
+            current_ = aligned + bytes;
+            used_ += bytes;
+            return aligned;
+        }
+        void deallocate(void *, std::size_t, std::size_t = alignof(std::max_align_t)) noexcept {}
+
+        // Frees every allocation. The most recent (largest) block is kept for the next round.
+        void reset() noexcept {
+            release_blocks(blocks_);
+            if (blocks_ != nullptr) {
+                current_ = blocks_->data;
+                end_ = reinterpret_cast<char *>(blocks_) + blocks_->size;
+            } else {
+                current_ = buffer_;
+                end_ = buffer_ + buffer_size_;
+            }
+            used_ = 0;
+        }
+
+        // Bytes handed out since construction or the last `reset`
+        std::size_t used() const noexcept { return used_; }
+
+    private:
+        struct block {
+            block *previous;
+            std::size_t size;
+            // Keeps the memory following the header aligned for any type
+            alignas(std::max_align_t) char data[1];
+        };
+
+        // Bytes to skip from `position` to the next multiple of `alignment`
+        static std::size_t padding_for(const char *position, std::size_t alignment) noexcept {
+            const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(position);
+            return static_cast<std::size_t>((alignment - address % alignment) % alignment);
+        }
+
+        void grow(std::size_t bytes, std::size_t alignment) {
+            if (bytes > std::numeric_limits<std::size_t>::max() / 2 - alignment)
+                throw std::bad_alloc {};
+            while (block_size_ < bytes + alignment + sizeof(block)) {
+                block_size_ *= 2;
+            }
+            block *next = static_cast<block *>(::operator new(block_size_));
+            next->previous = blocks_;
+            next->size = block_size_;
+            blocks_ = next;
+            current_ = next->data;
+            end_ = reinterpret_cast<char *>(next) + block_size_;
+            block_size_ *= 2;
+        }
+
+        // Frees every block older than `keep`, or all of them
+        void release_blocks(block *keep) noexcept {
+            block *current = keep != nullptr ? keep->previous : blocks_;
+            while (current != nullptr) {
+                block *previous = current->previous;
+                ::operator delete(current);
+                current = previous;
+            }
+            if (keep != nullptr) {
+                keep->previous = nullptr;
+            } else {
+                blocks_ = nullptr;
+            }
+        }
+
+#if __cplusplus >= 201703L
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override { return allocate(bytes, alignment); }
+        void do_deallocate(void *, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+#endif
+
+        char *buffer_;
+        std::size_t buffer_size_;
+        char *current_;
+        char *end_;
+        block *blocks_;
+        std::size_t block_size_;
+        std::size_t used_;
+    };
+
+    // Standard allocator drawing from a `monotonic_arena`, for containers and the materializing functions (`to<>`,
+    // `filter` over a `std::array`, `to_soa`)
+    template<typename T>
+    class arena_allocator {
+    public:
+        using value_type = T;
+
+        explicit arena_allocator(monotonic_arena &arena) noexcept : arena_(&arena) {}
+        template<typename U>
+        arena_allocator(const arena_allocator<U> &other) noexcept : arena_(other.arena()) {}
+
+        T *allocate(std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_alloc {};
+            return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *pointer, std::size_t n) noexcept { arena_->deallocate(pointer, n * sizeof(T), alignof(T)); }
+
+        monotonic_arena *arena() const noexcept { return arena_; }
+
+        template<typename U>
+        friend bool operator==(const arena_allocator &lhs, const arena_allocator<U> &rhs) noexcept { return lhs.arena_ == rhs.arena(); }
+        template<typename U>
+        friend bool operator!=(const arena_allocator &lhs, const arena_allocator<U> &rhs) noexcept { return !(lhs == rhs); }
+
+    private:
+        monotonic_arena *arena_;
+    };
+
+#if RANGED_HAS_COROUTINES
+    // Coroutine producing a single-pass sequence, usable as the source of any view or materializing function:
+    //     ranged::generator<int> squares(int n) { for (int i = 0; i < n; ++i) co_yield i * i; }
+    //     auto even = ranged::to<std::vector>(ranged::filter(squares(100), is_even));
+    // Iterators refer to the value in the suspended coroutine frame, so no element is copied until a consumer asks.
+    // The frame comes from `operator new`, which the compiler may elide when the generator does not outlive its
+    // caller; a coroutine taking `std::allocator_arg_t, monotonic_arena &` as its first parameters allocates the
+    // frame from that arena instead. A second traversal does not restart: it continues where the first one stopped.
+    template<typename T>
+    class generator {
+    public:
+        using value_type = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+        using reference = const value_type &;
+        using pointer = const value_type *;
+        using difference_type = std::ptrdiff_t;
+        using size_type = std::size_t;
+
+        class promise_type {
+        public:
+            generator get_return_object() noexcept { return generator {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+            std::suspend_always yield_value(const value_type &value) noexcept {
+                current_ = std::addressof(value);
+                return {};
+            }
+            // The temporary lives until the end of the `co_yield` full-expression, which spans the suspension
+            std::suspend_always yield_value(value_type &&value) noexcept {
+                current_ = std::addressof(value);
+                return {};
+            }
+            void return_void() const noexcept {}
+            void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+            // A generator only suspends to yield
+            template<typename U>
+            std::suspend_never await_transform(U &&) = delete;
+
+            static void *operator new(std::size_t size) { return allocate(size, nullptr); }
+            template<typename... Args>
+            static void *operator new(std::size_t size, std::allocator_arg_t, monotonic_arena &arena, Args &...) {
+                return allocate(size, &arena);
+            }
+            static void operator delete(void *frame, std::size_t size) noexcept {
+                char *block = static_cast<char *>(frame) - header_size;
+                monotonic_arena *arena;
+                std::memcpy(&arena, block, sizeof(arena));
+                if (arena == nullptr)
+                    ::operator delete(block);
+                else
+                    arena->deallocate(block, size + header_size);
+            }
+
+            pointer current() const noexcept { return current_; }
+            void rethrow() {
+                if (exception_)
+                    std::rethrow_exception(std::exchange(exception_, nullptr));
+            }
+
+        private:
+            // Each frame is prefixed with the arena it came from (null for the heap), so `operator delete` can tell
+            static constexpr std::size_t header_size = alignof(std::max_align_t);
+
+            static void *allocate(std::size_t size, monotonic_arena *arena) {
+                char *block = static_cast<char *>(arena == nullptr ? ::operator new(size + header_size) : arena->allocate(size + header_size));
+                std::memcpy(block, &arena, sizeof(arena));
+                return block + header_size;
+            }
+
+            pointer current_ = nullptr;
+            std::exception_ptr exception_;
+        };
+
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = generator::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = generator::pointer;
+            using reference = generator::reference;
+
+            iterator() noexcept = default;
+
+            reference operator*() const noexcept { return *coroutine_.promise().current(); }
+            pointer operator->() const noexcept { return coroutine_.promise().current(); }
+            iterator &operator++() {
+                coroutine_.resume();
+                coroutine_.promise().rethrow();
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+
+            // Any iterator over a finished coroutine equals the default constructed end iterator
+            friend bool operator==(const iterator &lhs, const iterator &rhs) noexcept { return lhs.done() == rhs.done(); }
+            friend bool operator!=(const iterator &lhs, const iterator &rhs) noexcept { return !(lhs == rhs); }
+
+        private:
+            friend class generator;
+            explicit iterator(std::coroutine_handle<promise_type> coroutine) noexcept : coroutine_(coroutine) {}
+            bool done() const noexcept { return !coroutine_ || coroutine_.done(); }
+
+            std::coroutine_handle<promise_type> coroutine_;
+        };
+        using const_iterator = iterator;
+
+        generator(generator &&other) noexcept : coroutine_(std::exchange(other.coroutine_, nullptr)), started_(other.started_) {}
+        generator &operator=(generator other) noexcept {
+            std::swap(coroutine_, other.coroutine_);
+            std::swap(started_, other.started_);
+            return *this;
+        }
+        ~generator() {
+            if (coroutine_)
+                coroutine_.destroy();
+        }
+
+        // Runs the coroutine to its first `co_yield`, or on from where the previous traversal stopped. `const` so that
+        // the functions taking ranges by const reference accept a generator; it is single pass all the same.
+        iterator begin() const {
+            if (coroutine_ && !started_) {
+                started_ = true;
+                coroutine_.resume();
+                coroutine_.promise().rethrow();
+            }
+            return iterator {coroutine_};
+        }
+        iterator end() const noexcept { return iterator {}; }
+
+    private:
+        explicit generator(std::coroutine_handle<promise_type> coroutine) noexcept : coroutine_(coroutine) {}
+
+        std::coroutine_handle<promise_type> coroutine_;
+        mutable bool started_ = false;
+    };
+#endif
+
+    // Hash used by `flat_hash_map`: `std::hash`, plus `string_view` before c++17
+    template<typename T>
+    struct hash : std::hash<T> {};
+#if __cplusplus < 201703L
+    template<>
+    struct hash<string_view> {
+        std::size_t operator()(string_view str) const noexcept {
+            // Eight bytes at a time; `flat_hash_map` mixes the result again, so a multiply per word is enough
+            std::uint64_t result = 0xcbf29ce484222325ull ^ str.size();
+            const char *data = str.data();
+            std::size_t size = str.size();
+            for (; size >= 8; data += 8, size -= 8) {
+                std::uint64_t word;
+                std::memcpy(&word, data, 8);
+                result = (result ^ word) * 0x100000001b3ull;
+                result ^= result >> 29;
+            }
+            std::uint64_t tail = 0;
+            std::memcpy(&tail, data, size);
+            result = (result ^ tail) * 0x100000001b3ull;
+            return static_cast<std::size_t>(result ^ (result >> 32));
+        }
+    };
+#endif
+
+    // Open addressing hash map, as used by `group_by` and `aggregate_by`. Entries are stored contiguously in insertion
+    // order, and a linear probing table of 8-byte slots indexes them: iteration is a plain vector walk and a lookup
+    // touches the slot table and then the matching entry only. Elements cannot be erased, and references are
+    // invalidated by insertions, as with `std::vector`. Keys must not be modified through the iterators.
+    template<typename Key, typename T, typename Hash = hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class flat_hash_map {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using pointer = value_type *;
+        using const_pointer = const value_type *;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        explicit flat_hash_map(size_type capacity = 0, const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual()) :
+            hash_(hash), equal_(equal), bits_(0) {
+            reserve(capacity);
+        }
+
+        iterator begin() noexcept { return entries_.begin(); }
+        iterator end() noexcept { return entries_.end(); }
+        const_iterator begin() const noexcept { return entries_.begin(); }
+        const_iterator end() const noexcept { return entries_.end(); }
+
+        size_type size() const noexcept { return entries_.size(); }
+        bool empty() const noexcept { return entries_.empty(); }
+
+        // Makes room for `count` entries without rehashing
+        void reserve(size_type count) {
+            if (count > max_size())
+                throw std::length_error("flat_hash_map: too many entries");
+            entries_.reserve(count);
+            unsigned bits = bits_ == 0 ? 4 : bits_;
+            while ((std::size_t {1} << bits) / 2 < count) {
+                ++bits;
+            }
+            if (bits != bits_)
+                rehash(bits);
+        }
+        void clear() noexcept {
+            entries_.clear();
+            std::fill(slots_.begin(), slots_.end(), 0);
+        }
+
+        iterator find(const Key &key) {
+            const std::size_t index = lookup(key, fragment_of(key));
+            return index == npos ? end() : begin() + static_cast<difference_type>(index);
+        }
+        const_iterator find(const Key &key) const {
+            const std::size_t index = lookup(key, fragment_of(key));
+            return index == npos ? end() : begin() + static_cast<difference_type>(index);
+        }
+        size_type count(const Key &key) const { return find(key) != end(); }
+        bool contains(const Key &key) const { return find(key) != end(); }
+
+        T &at(const Key &key) {
+            const iterator it = find(key);
+            if (it == end())
+                throw std::out_of_range("flat_hash_map::at");
+            return it->second;
+        }
+        const T &at(const Key &key) const {
+            const const_iterator it = find(key);
+            if (it == end())
+                throw std::out_of_range("flat_hash_map::at");
+            return it->second;
+        }
+        T &operator[](const Key &key) { return try_emplace(key).first->second; }
+
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace(K &&key, Args &&... args) {
+            return lazy_emplace(std::forward<K>(key), [&] { return T(std::forward<Args>(args)...); });
+        }
+        // Inserts the mapped value returned by `make()` when `key` is missing; `make` is not called otherwise
+        template<typename K, typename Make>
+        std::pair<iterator, bool> lazy_emplace(K &&key, const Make &make) {
+            const std::uint32_t fragment = fragment_of(key);
+            const std::size_t mask = (std::size_t {1} << bits_) - 1;
+            std::size_t slot = fragment >> (32 - bits_);
+            for (; slots_[slot] != 0; slot = (slot + 1) & mask) {
+                const std::uint64_t value = slots_[slot];
+                if (static_cast<std::uint32_t>(value >> 32) == fragment && equal_(entries_[(value & 0xffffffffu) - 1].first, key))
+                    return std::make_pair(begin() + static_cast<difference_type>((value & 0xffffffffu) - 1), false);
+            }
+
+            if (entries_.size() + 1 > (mask + 1) / 2) {
+                if (entries_.size() >= max_size())
+                    throw std::length_error("flat_hash_map: too many entries");
+                rehash(bits_ + 1);
+                slot = fragment >> (32 - bits_);
+                while (slots_[slot] != 0) {
+                    slot = (slot + 1) & ((std::size_t {1} << bits_) - 1);
+                }
+            }
+            entries_.emplace_back(std::forward<K>(key), make());
+            slots_[slot] = static_cast<std::uint64_t>(fragment) << 32 | entries_.size();
+            return std::make_pair(end() - 1, true);
+        }
+
+        size_type max_size() const noexcept { return std::size_t {1} << 31; }
+        hasher hash_function() const { return hash_; }
+        key_equal key_eq() const { return equal_; }
+
+    private:
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        // The top 32 bits of the Fibonacci-mixed hash: its top `bits_` bits pick the home slot, so growing the table
+        // never calls the hash function again
+        std::uint32_t fragment_of(const Key &key) const {
+            return static_cast<std::uint32_t>((static_cast<std::uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ull) >> 32);
+        }
+
+        std::size_t lookup(const Key &key, std::uint32_t fragment) const {
+            if (entries_.empty())
+                return npos;
+            const std::size_t mask = (std::size_t {1} << bits_) - 1;
+            for (std::size_t slot = fragment >> (32 - bits_); slots_[slot] != 0; slot = (slot + 1) & mask) {
+                const std::uint64_t value = slots_[slot];
+                if (static_cast<std::uint32_t>(value >> 32) == fragment && equal_(entries_[(value & 0xffffffffu) - 1].first, key))
+                    return (value & 0xffffffffu) - 1;
+            }
+            return npos;
+        }
+
+        void rehash(unsigned bits) {
+            std::vector<std::uint64_t> slots(std::size_t {1} << bits, 0);
+            const std::size_t mask = slots.size() - 1;
+            for (const std::uint64_t value: slots_) {
+                if (value == 0)
+                    continue;
+                std::size_t slot = static_cast<std::uint32_t>(value >> 32) >> (32 - bits);
+                while (slots[slot] != 0) {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = value;
+            }
+            slots_.swap(slots);
+            bits_ = bits;
+        }
+
+        std::vector<value_type> entries_;
+        // 0 for an empty slot, otherwise the hash fragment in the high half and the entry index + 1 in the low one
+        std::vector<std::uint64_t> slots_;
+        Hash hash_;
+        KeyEqual equal_;
+        unsigned bits_;
+    };
+
+    // Aggregators computed per group by `aggregate_by`. An aggregator is any type with these const members, where
+    // `Element` is the range's reference type:
+    //  - `State start(Element)`, the state of a group after its first element,
+    //  - `void add(State &, Element)`, which folds in the following ones,
+    //  - `void merge(State &, const State &)`, which combines two partial groups (only the parallel version needs it),
+    //  - `Result finish(State &&)`, the value stored in the result.
+    namespace agg {
+        struct identity {
+            template<typename T>
+            constexpr T &&operator()(T &&value) const noexcept { return std::forward<T>(value); }
+        };
+
+        struct count_aggregator {
+            template<typename E>
+            std::size_t start(const E &) const noexcept { return 1; }
+            template<typename E>
+            void add(std::size_t &state, const E &) const noexcept { ++state; }
+            void merge(std::size_t &state, std::size_t other) const noexcept { state += other; }
+            std::size_t finish(std::size_t state) const noexcept { return state; }
+        };
+
+        template<typename Proj>
+        struct sum_aggregator {
+            Proj projection;
+
+            template<typename E>
+            typename std::decay<decltype(std::declval<const Proj &>()(std::declval<const E &>()))>::type start(const E &element) const {
+                return projection(element);
+            }
+            template<typename S, typename E>
+            void add(S &state, const E &element) const { state += projection(element); }
+            template<typename S>
+            void merge(S &state, const S &other) const { state += other; }
+            template<typename S>
+            typename std::decay<S>::type finish(S &&state) const { return std::forward<S>(state); }
+        };
+
+        // Keeps the first of equivalent extrema, like `ranged::max` and `ranged::min`
+        template<typename Proj, typename Compare>
+        struct extremum_aggregator {
+            Proj projection;
+            Compare compare;
+
+            template<typename E>
+            typename std::decay<decltype(std::declval<const Proj &>()(std::declval<const E &>()))>::type start(const E &element) const {
+                return projection(element);
+            }
+            template<typename S, typename E>
+            void add(S &state, const E &element) const {
+                auto &&value = projection(element);
+                if (compare(value, state))
+                    state = std::forward<decltype(value)>(value);
+            }
+            template<typename S>
+            void merge(S &state, const S &other) const {
+                if (compare(other, state))
+                    state = other;
+            }
+            template<typename S>
+            typename std::decay<S>::type finish(S &&state) const { return std::forward<S>(state); }
+        };
+
+        struct mean_state {
+            double sum;
+            std::size_t count;
+        };
+        template<typename Proj>
+        struct mean_aggregator {
+            Proj projection;
+
+            template<typename E>
+            mean_state start(const E &element) const { return mean_state {static_cast<double>(projection(element)), 1}; }
+            template<typename E>
+            void add(mean_state &state, const E &element) const {
+                state.sum += static_cast<double>(projection(element));
+                ++state.count;
+            }
+            void merge(mean_state &state, const mean_state &other) const noexcept {
+                state.sum += other.sum;
+                state.count += other.count;
+            }
+            double finish(const mean_state &state) const noexcept { return state.sum / static_cast<double>(state.count); }
+        };
+
+        // `state = op(state, element)` from `init`; `combine(state, other)` merges partial states
+        template<typename S, typename Op, typename Combine>
+        struct fold_aggregator {
+            S init;
+            Op op;
+            Combine combine;
+
+            template<typename E>
+            S start(const E &element) const { return op(S(init), element); }
+            template<typename E>
+            void add(S &state, const E &element) const { state = op(std::move(state), element); }
+            void merge(S &state, const S &other) const { state = combine(std::move(state), other); }
+            S finish(S &&state) const { return std::move(state); }
+        };
+
+        // The elements of each group, in range order
+        struct collect_aggregator {
+            template<typename E>
+            std::vector<typename std::decay<E>::type> start(const E &element) const {
+                return std::vector<typename std::decay<E>::type>(1, element);
+            }
+            template<typename S, typename E>
+            void add(S &state, const E &element) const { state.push_back(element); }
+            template<typename S>
+            void merge(S &state, const S &other) const {
+                state.reserve(state.size() + other.size());
+                for (const auto &element: other) {
+                    state.push_back(element);
+                }
+            }
+            template<typename S>
+            typename std::decay<S>::type finish(S &&state) const { return std::forward<S>(state); }
+        };
+
+        constexpr count_aggregator count() noexcept { return count_aggregator {}; }
+        template<typename Proj = identity>
+        constexpr sum_aggregator<Proj> sum(const Proj &projection = Proj()) { return sum_aggregator<Proj> {projection}; }
+        template<typename Proj = identity, typename Compare = transparent_less>
+        constexpr extremum_aggregator<Proj, Compare> min(const Proj &projection = Proj(), const Compare &compare = Compare()) {
+            return extremum_aggregator<Proj, Compare> {projection, compare};
+        }
+        template<typename Proj = identity, typename Compare = transparent_greater>
+        constexpr extremum_aggregator<Proj, Compare> max(const Proj &projection = Proj(), const Compare &compare = Compare()) {
+            return extremum_aggregator<Proj, Compare> {projection, compare};
+        }
+        template<typename Proj = identity>
+        constexpr mean_aggregator<Proj> mean(const Proj &projection = Proj()) { return mean_aggregator<Proj> {projection}; }
+        template<typename S, typename Op, typename Combine>
+        constexpr fold_aggregator<S, Op, Combine> fold(const S &init, const Op &op, const Combine &combine) {
+            return fold_aggregator<S, Op, Combine> {init, op, combine};
+        }
+        constexpr collect_aggregator collect() noexcept { return collect_aggregator {}; }
+    } // namespace agg
+
+    // Rows produced by `hash_join` and `merge_join`, for every probe element:
+    //  - inner: one row per matching build element,
+    //  - left: the same, or a single row with a null build element when nothing matches,
+    //  - semi: the probe element once when something matches,
+    //  - anti: the probe element when nothing matches.
+    enum class join_kind { inner, left, semi, anti };
+
+    // Tags selecting the kind of `hash_join(left_join, ...)` and `merge_join(left_join, ...)`
+    template<join_kind Kind>
+    struct join_tag { explicit join_tag() = default; };
+    using left_join_t = join_tag<join_kind::left>;
+    using semi_join_t = join_tag<join_kind::semi>;
+    using anti_join_t = join_tag<join_kind::anti>;
+    constexpr left_join_t left_join {};
+    constexpr semi_join_t semi_join {};
+    constexpr anti_join_t anti_join {};
+
+    // Tags selecting the mode of `distinct`. `sorted_input` promises that equal keys are adjacent. `approximate` bounds
+    // the memory to a Bloom filter of `bytes` (1 MiB by default, e.g. `approximate(64 << 10)`), at the cost of
+    // dropping some distinct elements.
+    struct sorted_input_t { explicit sorted_input_t() = default; };
+    constexpr sorted_input_t sorted_input {};
+    struct approximate_t {
+        std::size_t bytes;
+
+        constexpr approximate_t operator()(std::size_t size) const noexcept { return approximate_t {size}; }
+    };
+    constexpr approximate_t approximate {std::size_t {1} << 20};
+
+    namespace views {
+        // How a range is kept by a view taking it by forwarding reference: lvalues by reference, rvalues moved in
+        template<typename R>
+        using stored_range_t = typename std::conditional<std::is_lvalue_reference<R>::value,
+            ref_view_of<const typename std::remove_reference<R>::type>, typename std::decay<R>::type>::type;
+
+        template<typename R>
+        ref_view_of<const R> store_range(const R &range) noexcept { return as_ref_view(range); }
+        template<typename R>
+        typename std::enable_if<!std::is_lvalue_reference<R>::value, typename std::decay<R>::type>::type store_range(R &&range) {
+            return std::move(range);
+        }
+
+        // Rows of a join: a `zip_reference` to the build and probe elements for inner joins, to a pointer to the build
+        // element (null when nothing matches) and the probe element for left joins, the probe element for semi and anti
+        // joins
+        template<typename BuildIter, typename ProbeIter, join_kind Kind>
+        struct join_row {
+            using reference = zip_reference<typename std::iterator_traits<BuildIter>::reference, typename std::iterator_traits<ProbeIter>::reference>;
+            using value_type = std::tuple<typename std::iterator_traits<BuildIter>::value_type, typename std::iterator_traits<ProbeIter>::value_type>;
+
+            static reference make(const BuildIter &build, const ProbeIter &probe, bool) { return reference(*build, *probe); }
+        };
+        template<typename BuildIter, typename ProbeIter>
+        struct join_row<BuildIter, ProbeIter, join_kind::left> {
+            static_assert(std::is_lvalue_reference<typename std::iterator_traits<BuildIter>::reference>::value,
+                          "Left joins point to build elements, which must be lvalues");
+            using pointer = typename std::add_pointer<typename std::iterator_traits<BuildIter>::reference>::type;
+            using reference = zip_reference<pointer, typename std::iterator_traits<ProbeIter>::reference>;
+            using value_type = std::tuple<pointer, typename std::iterator_traits<ProbeIter>::value_type>;
+
+            static reference make(const BuildIter &build, const ProbeIter &probe, bool matched) {
+                return reference(matched ? std::addressof(*build) : nullptr, *probe);
+            }
+        };
+        template<typename BuildIter, typename ProbeIter>
+        struct join_row<BuildIter, ProbeIter, join_kind::semi> {
+            using reference = typename std::iterator_traits<ProbeIter>::reference;
+            using value_type = typename std::iterator_traits<ProbeIter>::value_type;
+
+            static reference make(const BuildIter &, const ProbeIter &probe, bool) { return *probe; }
+        };
+        template<typename BuildIter, typename ProbeIter>
+        struct join_row<BuildIter, ProbeIter, join_kind::anti> : join_row<BuildIter, ProbeIter, join_kind::semi> {};
+
+        // Whether a probe element with or without matches yields rows
+        constexpr bool join_yields(join_kind kind, bool matched) noexcept {
+            return kind == join_kind::left || (matched ? kind != join_kind::anti : kind == join_kind::anti);
+        }
+
+        // Hash join: the constructor indexes the build range by key, which takes memory in proportion to it, then
+        // iteration streams the probe range and looks every element up. The index is a `flat_hash_map` from each key
+        // to its first build iterator, stored inline so unique keys cost a single lookup, and to a slice of one vector
+        // holding the other build iterators of the key. Matches of a key come in build order and rows in probe order.
+        template<typename Build, typename Probe, typename BuildKey, typename ProbeKey, join_kind Kind>
+        class hash_join_view {
+        public:
+            using build_iterator = decltype(std::declval<const Build &>().begin());
+            using probe_iterator = decltype(std::declval<const Probe &>().begin());
+            using key_type = typename std::decay<decltype(std::declval<const BuildKey &>()(*std::declval<build_iterator>()))>::type;
+
+        private:
+            struct group {
+                build_iterator first;
+                // Index in `rest_` of the second match, and number of matches
+                std::size_t rest;
+                std::size_t count;
+            };
+
+        public:
+            class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename join_row<build_iterator, probe_iterator, Kind>::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = typename join_row<build_iterator, probe_iterator, Kind>::reference;
+
+                iterator() : view_(nullptr), group_(nullptr), match_(0), last_(0) {}
+                iterator(const hash_join_view *view, probe_iterator probe) :
+                    view_(view), probe_(std::move(probe)), group_(nullptr), match_(0), last_(0) {
+                    satisfy();
+                }
+
+                reference operator*() const {
+                    const bool matched = match_ != last_;
+                    const build_iterator build = !matched ? build_iterator() : match_ == 0 ? group_->first : view_->rest_[group_->rest + match_ - 1];
+                    return join_row<build_iterator, probe_iterator, Kind>::make(build, probe_, matched);
+                }
+
+                iterator &operator++() {
+                    if (match_ != last_ && ++match_ != last_)
+                        return *this;
+                    ++probe_;
+                    satisfy();
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.probe_ == rhs.probe_ && lhs.match_ == rhs.match_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                // Moves to the first probe element, from the current one, that yields rows
+                void satisfy() {
+                    const probe_iterator end = view_->probe_.end();
+                    for (; probe_ != end; ++probe_) {
+                        const auto found = view_->groups_.find(view_->probe_key_(*probe_));
+                        const bool matched = found != view_->groups_.end();
+                        if (join_yields(Kind, matched)) {
+                            group_ = matched ? &found->second : nullptr;
+                            match_ = 0;
+                            last_ = matched && (Kind == join_kind::inner || Kind == join_kind::left) ? found->second.count : 0;
+                            return;
+                        }
+                    }
+                    group_ = nullptr;
+                    match_ = last_ = 0;
+                }
+
+                const hash_join_view *view_;
+                probe_iterator probe_;
+                const group *group_;
+                // Current and past-the-last match of `group_`
+                std::size_t match_;
+                std::size_t last_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = typename iterator::reference;
+
+            hash_join_view(Build build, Probe probe, const BuildKey &build_key, const ProbeKey &probe_key) :
+                build_(std::move(build)), probe_(std::move(probe)), build_key_(build_key), probe_key_(probe_key) {
+                index();
+            }
+
+            iterator begin() const { return iterator(this, probe_.begin()); }
+            iterator end() const { return iterator(this, probe_.end()); }
+
+            // Distinct keys of the build range
+            std::size_t key_count() const noexcept { return groups_.size(); }
+
+        private:
+            void index() {
+                const bool keep_rows = Kind == join_kind::inner || Kind == join_kind::left;
+                // Repeated matches with the index of their group, then counting sort by group
+                std::vector<std::pair<build_iterator, std::size_t>> rest;
+                for (build_iterator it = build_.begin(), end = build_.end(); it != end; ++it) {
+                    const auto found = groups_.lazy_emplace(build_key_(*it), [&it] { return group {it, 0, 0}; }).first;
+                    if (++found->second.count > 1 && keep_rows)
+                        rest.emplace_back(it, static_cast<std::size_t>(found - groups_.begin()));
+                }
+                if (rest.empty())
+                    return;
+
+                // `rest` of each group points past its slice first, and is moved back while filling it in reverse
+                std::size_t offset = 0;
+                for (auto &entry: groups_) {
+                    offset += entry.second.count - 1;
+                    entry.second.rest = offset;
+                }
+                rest_.resize(rest.size());
+                for (auto row = rest.rbegin(); row != rest.rend(); ++row) {
+                    rest_[--(groups_.begin() + static_cast<std::ptrdiff_t>(row->second))->second.rest] = row->first;
+                }
+            }
+
+            Build build_;
+            Probe probe_;
+            callable_t<BuildKey> build_key_;
+            callable_t<ProbeKey> probe_key_;
+            flat_hash_map<key_type, group> groups_;
+            // Build iterators after the first one of every key, grouped by key
+            std::vector<build_iterator> rest_;
+        };
+
+        // Merge join of two ranges sorted by key with `Compare`, in a single pass without allocating. Build elements
+        // with equal keys are visited again for every probe element of the same key. Rows come in probe order.
+        template<typename Build, typename Probe, typename BuildKey, typename ProbeKey, typename Compare, join_kind Kind>
+        class merge_join_view {
+        public:
+            using build_iterator = decltype(std::declval<const Build &>().begin());
+            using probe_iterator = decltype(std::declval<const Probe &>().begin());
+
+            class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename join_row<build_iterator, probe_iterator, Kind>::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = typename join_row<build_iterator, probe_iterator, Kind>::reference;
+
+                iterator() : view_(nullptr) {}
+                iterator(const merge_join_view *view, build_iterator build, probe_iterator probe) :
+                    view_(view), run_(build), match_(build), last_(build), probe_(std::move(probe)) {
+                    satisfy();
+                }
+
+                reference operator*() const { return join_row<build_iterator, probe_iterator, Kind>::make(match_, probe_, match_ != last_); }
+
+                iterator &operator++() {
+                    if (match_ != last_ && ++match_ != last_)
+                        return *this;
+                    ++probe_;
+                    satisfy();
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.probe_ == rhs.probe_ && lhs.match_ == rhs.match_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                // Moves to the first probe element, from the current one, that yields rows. `run_` only moves forward,
+                // to the first build element not ordered before the probe key.
+                void satisfy() {
+                    const build_iterator build_end = view_->build_.end();
+                    const probe_iterator probe_end = view_->probe_.end();
+                    for (; probe_ != probe_end; ++probe_) {
+                        const auto key = view_->probe_key_(*probe_);
+                        while (run_ != build_end && view_->compare_(view_->build_key_(*run_), key)) {
+                            ++run_;
+                        }
+                        const bool matched = run_ != build_end && !view_->compare_(key, view_->build_key_(*run_));
+                        if (!join_yields(Kind, matched))
+                            continue;
+                        match_ = last_ = run_;
+                        if (matched && (Kind == join_kind::inner || Kind == join_kind::left)) {
+                            do {
+                                ++last_;
+                            } while (last_ != build_end && !view_->compare_(key, view_->build_key_(*last_)));
+                        }
+                        return;
+                    }
+                    match_ = last_ = build_end;
+                }
+
+                const merge_join_view *view_;
+                build_iterator run_;
+                build_iterator match_;
+                build_iterator last_;
+                probe_iterator probe_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = typename iterator::reference;
+
+            merge_join_view(Build build, Probe probe, const BuildKey &build_key, const ProbeKey &probe_key, const Compare &compare) :
+                build_(std::move(build)), probe_(std::move(probe)), build_key_(build_key), probe_key_(probe_key), compare_(compare) {}
+
+            iterator begin() const { return iterator(this, build_.begin(), probe_.begin()); }
+            iterator end() const { return iterator(this, build_.end(), probe_.end()); }
+
+        private:
+            Build build_;
+            Probe probe_;
+            callable_t<BuildKey> build_key_;
+            callable_t<ProbeKey> probe_key_;
+            Compare compare_;
+        };
+
+        // Elements of several ranges sorted by `compare`, in one sorted sequence. A loser tree over the ranges holds,
+        // at every inner node, the range that lost the match played there; the overall winner is the next element.
+        // After it is consumed, its range replays the matches on its path to the root only: log2(ranges) comparisons
+        // per element. Ties go to the earlier range, so equivalent elements come in range order. With `Unique`,
+        // elements equivalent to the previous one are skipped.
+        template<typename Range, typename Compare, bool Unique>
+        class merge_view {
+        public:
+            using range_iterator = decltype(std::declval<const Range &>().begin());
+
+            class iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename std::iterator_traits<range_iterator>::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = typename std::iterator_traits<range_iterator>::reference;
+
+                iterator() : view_(nullptr), leaves_(1), winner_(0) {}
+                // The end iterator has no ranges left
+                explicit iterator(const merge_view *view) : view_(view), leaves_(1), winner_(0) {}
+                iterator(const merge_view *view, const std::vector<Range> &ranges) : view_(view), leaves_(1), winner_(0) {
+                    current_.reserve(ranges.size());
+                    ends_.reserve(ranges.size());
+                    for (const Range &range: ranges) {
+                        current_.push_back(range.begin());
+                        ends_.push_back(range.end());
+                    }
+                    while (leaves_ < ranges.size()) {
+                        leaves_ *= 2;
+                    }
+                    losers_.resize(leaves_);
+                    winner_ = leaves_ > 1 ? play(1) : 0;
+                }
+
+                reference operator*() const { return *current_[winner_]; }
+
+                iterator &operator++() {
+                    advance(std::integral_constant<bool, Unique> {});
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) {
+                    return lhs.done() == rhs.done() && (lhs.done() || lhs.current_ == rhs.current_);
+                }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                // Leaves past the last range stand for empty ranges
+                bool exhausted(std::size_t range) const { return range >= current_.size() || current_[range] == ends_[range]; }
+                bool done() const { return exhausted(winner_); }
+
+                // Whether the current element of range `a` comes before the one of range `b`
+                bool precedes(std::size_t a, std::size_t b) const {
+                    if (exhausted(a))
+                        return false;
+                    if (exhausted(b))
+                        return true;
+                    return a < b ? !view_->compare_(*current_[b], *current_[a]) : view_->compare_(*current_[a], *current_[b]);
+                }
+
+                // Fills the subtree under `node` and returns the range winning it
+                std::size_t play(std::size_t node) {
+                    if (node >= leaves_)
+                        return node - leaves_;
+                    const std::size_t left = play(2 * node);
+                    const std::size_t right = play(2 * node + 1);
+                    if (precedes(right, left)) {
+                        losers_[node] = left;
+                        return right;
+                    }
+                    losers_[node] = right;
+                    return left;
+                }
+
+                void replay() {
+                    std::size_t winner = winner_;
+                    for (std::size_t node = (winner + leaves_) / 2; node != 0; node /= 2) {
+                        if (precedes(losers_[node], winner))
+                            std::swap(losers_[node], winner);
+                    }
+                    winner_ = winner;
+                }
+
+                void advance(std::false_type) {
+                    ++current_[winner_];
+                    replay();
+                }
+                void advance(std::true_type) {
+                    const range_iterator previous = current_[winner_];
+                    do {
+                        ++current_[winner_];
+                        replay();
+                    } while (!done() && !view_->compare_(*previous, *current_[winner_]));
+                }
+
+                const merge_view *view_;
+                std::vector<range_iterator> current_;
+                std::vector<range_iterator> ends_;
+                std::vector<std::size_t> losers_;
+                std::size_t leaves_;
+                std::size_t winner_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = typename iterator::reference;
+
+            merge_view(std::vector<Range> &&ranges, const Compare &compare) : ranges_(std::move(ranges)), compare_(compare) {}
+
+            iterator begin() const { return iterator(this, ranges_); }
+            iterator end() const { return iterator(this); }
+
+            // Without deduplication, every element of every range is yielded
+            template<typename R = Range, bool U = Unique>
+            typename std::enable_if<sized<const R>::value && !U, size_type>::type size() const {
+                size_type total = 0;
+                for (const Range &range: ranges_) {
+                    total += static_cast<size_type>(range.size());
+                }
+                return total;
+            }
+
+        private:
+            std::vector<Range> ranges_;
+            Compare compare_;
+        };
+
+        // Keys already yielded by an exact `distinct_view`: a `flat_hash_map` with nothing mapped. It is reserved for the
+        // base size up to `reserve_limit` keys only: inputs that large usually repeat keys, and a table sized for every
+        // element would mostly miss the cache.
+        template<typename Key>
+        class exact_seen {
+        public:
+            struct mark {};
+            static constexpr std::size_t reserve_limit = std::size_t {1} << 16;
+
+            void reset(std::size_t expected) {
+                keys_.clear();
+                keys_.reserve(expected < reserve_limit ? expected : reserve_limit);
+            }
+            // True when `key` was not seen yet
+            template<typename K>
+            bool insert(K &&key) { return keys_.lazy_emplace(std::forward<K>(key), [] { return mark {}; }).second; }
+
+        private:
+            flat_hash_map<Key, mark> keys_;
+        };
+
+        // Bloom filter of the keys yielded by an approximate `distinct_view`, of a fixed number of bits. A key whose bits
+        // are all set is taken as seen: duplicates are always dropped, and new keys are too with a probability that
+        // grows with the number of keys per bit.
+        template<typename Key>
+        class bloom_seen {
+        public:
+            explicit bloom_seen(std::size_t bytes) : words_(std::max<std::size_t>(bytes / 8, 1)), probes_(4) {}
+
+            // The number of probes minimizing false positives for `expected` keys (0 - unknown)
+            void reset(std::size_t expected) {
+                std::fill(words_.begin(), words_.end(), 0);
+                const std::size_t bits = words_.size() * 64;
+                if (expected != 0)
+                    probes_ = static_cast<unsigned>(std::min<std::size_t>(std::max<std::size_t>(bits * 7 / (expected * 10), 1), 8));
+            }
+            template<typename K>
+            bool insert(const K &key) {
+                // Double hashing: probe `i` is `first + i * step`, both taken from one mixed hash
+                const std::uint64_t mixed = static_cast<std::uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ull;
+                const std::uint64_t step = (mixed >> 32 | mixed << 32) | 1;
+                const std::uint64_t bits = words_.size() * 64;
+                bool fresh = false;
+                std::uint64_t position = mixed;
+                for (unsigned i = 0; i < probes_; ++i, position += step) {
+                    const std::uint64_t bit = position % bits;
+                    std::uint64_t &word = words_[bit / 64];
+                    const std::uint64_t mask = std::uint64_t {1} << (bit % 64);
+                    fresh |= (word & mask) == 0;
+                    word |= mask;
+                }
+                return fresh;
+            }
+
+        private:
+            std::vector<std::uint64_t> words_;
+            unsigned probes_;
+            hash<Key> hash_;
+        };
+
+        // Result of `distinct`: the elements of `Range` whose key was not yielded before, in order. `Seen` remembers the
+        // keys; it is reset by `begin`, sized from the base size when known, so the view supports one traversal at a
+        // time, and its iterators are input iterators.
+        template<typename Range, typename KeyFn, typename Seen>
+        class distinct_view {
+        public:
+            using base_iterator = decltype(std::begin(std::declval<const Range &>()));
+
+            class iterator {
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = typename std::iterator_traits<base_iterator>::value_type;
+                using difference_type = typename std::iterator_traits<base_iterator>::difference_type;
+                using pointer = typename std::iterator_traits<base_iterator>::pointer;
+                using reference = typename std::iterator_traits<base_iterator>::reference;
+
+                iterator() : view_(nullptr) {}
+                iterator(const distinct_view *view, base_iterator current, base_iterator end) : view_(view), current_(current), end_(end) {}
+
+                reference operator*() const { return *current_; }
+                iterator &operator++() {
+                    while (++current_ != end_ && !view_->seen_.insert(view_->key_(*current_))) {}
+                    return *this;
+                }
+                void operator++(int) { ++*this; }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.current_ == rhs.current_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                const distinct_view *view_;
+                base_iterator current_;
+                base_iterator end_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            distinct_view(Range &&range, const KeyFn &key, Seen &&seen) : range_(std::move(range)), key_(key), seen_(std::move(seen)) {}
+
+            // Starts over with no key seen
+            iterator begin() const {
+                seen_.reset(known_size(is_random_access_iterator<base_iterator> {}));
+                const base_iterator first = std::begin(range_);
+                if (first != std::end(range_))
+                    seen_.insert(key_(*first));
+                return iterator(this, first, std::end(range_));
+            }
+            iterator end() const { return iterator(this, std::end(range_), std::end(range_)); }
+
+            // The number of distinct elements is unknown until the view is traversed
+            template<typename R = Range>
+            typename std::enable_if<is_random_access_iterator<decltype(std::begin(std::declval<const R &>()))>::value || has_size_hint<const R>::value,
+                                    size_type>::type size_hint() const {
+                return known_size(is_random_access_iterator<base_iterator> {});
+            }
+
+        private:
+            size_type known_size(std::true_type) const { return static_cast<size_type>(std::end(range_) - std::begin(range_)); }
+            size_type known_size(std::false_type) const { return size_hint_of(range_, has_size_hint<const Range> {}); }
+            template<typename R>
+            static size_type size_hint_of(const R &range, std::true_type) { return range.size_hint(); }
+            template<typename R>
+            static size_type size_hint_of(const R &, std::false_type) noexcept { return 0; }
+
+            Range range_;
+            KeyFn key_;
+            mutable Seen seen_;
+        };
+
+        // Result of `distinct(sorted_input, ...)`: the first element of every run of elements with equal keys, found by
+        // comparing neighbours, without memory
+        template<typename Range, typename KeyFn>
+        class adjacent_distinct_view {
+        public:
+            using base_iterator = decltype(std::begin(std::declval<const Range &>()));
+
+            class iterator {
+            public:
+                using iterator_category = typename std::common_type<std::forward_iterator_tag,
+                    typename std::iterator_traits<base_iterator>::iterator_category>::type;
+                using value_type = typename std::iterator_traits<base_iterator>::value_type;
+                using difference_type = typename std::iterator_traits<base_iterator>::difference_type;
+                using pointer = typename std::iterator_traits<base_iterator>::pointer;
+                using reference = typename std::iterator_traits<base_iterator>::reference;
+
+                iterator() : key_(nullptr) {}
+                iterator(const KeyFn *key, base_iterator current, base_iterator end) : key_(key), current_(current), end_(end) {}
+
+                reference operator*() const { return *current_; }
+                iterator &operator++() {
+                    const base_iterator previous = current_;
+                    while (++current_ != end_ && (*key_)(*previous) == (*key_)(*current_)) {}
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator result = *this;
+                    ++*this;
+                    return result;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.current_ == rhs.current_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                const KeyFn *key_;
+                base_iterator current_;
+                base_iterator end_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            adjacent_distinct_view(Range &&range, const KeyFn &key) : range_(std::move(range)), key_(key) {}
+
+            iterator begin() const { return iterator(&key_, std::begin(range_), std::end(range_)); }
+            iterator end() const { return iterator(&key_, std::end(range_), std::end(range_)); }
+
+        private:
+            Range range_;
+            KeyFn key_;
+        };
+
+        // Span over a contiguous range, the unit of segment-wise scans
+        template<typename R>
+        using segment_of_t = typename std::enable_if<is_contiguous_range<underlying_t<R>>::value,
+            span<typename std::remove_pointer<decltype(underlying(std::declval<R &>()).data())>::type>>::type;
+
+        // The ranges of a range of contiguous ranges, as spans
+        template<typename Iter, typename Segment>
+        class segment_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Segment;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Segment;
+
+            segment_iterator() = default;
+            explicit segment_iterator(Iter current) : current_(current) {}
+
+            Segment operator*() const { return Segment(underlying(*current_).data(), underlying(*current_).size()); }
+            segment_iterator &operator++() {
+                ++current_;
+                return *this;
+            }
+            segment_iterator operator++(int) {
+                segment_iterator result = *this;
+                ++*this;
+                return result;
+            }
+
+            friend bool operator==(const segment_iterator &lhs, const segment_iterator &rhs) { return lhs.current_ == rhs.current_; }
+            friend bool operator!=(const segment_iterator &lhs, const segment_iterator &rhs) { return !(lhs == rhs); }
+
+        private:
+            Iter current_;
+        };
+        template<typename Iter, typename Segment>
+        class segment_range {
+        public:
+            using iterator = segment_iterator<Iter, Segment>;
+            using const_iterator = iterator;
+            using value_type = Segment;
+
+            segment_range(Iter first, Iter last) : first_(first), last_(last) {}
+
+            iterator begin() const { return iterator(first_); }
+            iterator end() const { return iterator(last_); }
+
+        private:
+            Iter first_;
+            Iter last_;
+        };
+
+        // Result of `flatten`: the elements of each range of a range of ranges in turn, e.g. of per-partition buffers,
+        // without copies. Empty inner ranges are skipped. Contiguous inner ranges are also listed by `segments()`.
+        template<typename Range>
+        class flatten_view {
+        public:
+            using outer_iterator = decltype(std::begin(std::declval<const Range &>()));
+            static_assert(std::is_lvalue_reference<typename std::iterator_traits<outer_iterator>::reference>::value,
+                          "The inner ranges must be stored by the outer range");
+            using inner_range = typename std::remove_reference<typename std::iterator_traits<outer_iterator>::reference>::type;
+            using inner_iterator = decltype(std::begin(std::declval<inner_range &>()));
+
+            class iterator {
+            public:
+                using iterator_category = typename std::common_type<std::forward_iterator_tag,
+                    typename std::iterator_traits<outer_iterator>::iterator_category, typename std::iterator_traits<inner_iterator>::iterator_category>::type;
+                using value_type = typename std::iterator_traits<inner_iterator>::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = typename std::iterator_traits<inner_iterator>::pointer;
+                using reference = typename std::iterator_traits<inner_iterator>::reference;
+
+                iterator() = default;
+                iterator(outer_iterator outer, outer_iterator end) : outer_(outer), end_(end), inner_() {
+                    if (outer_ != end_) {
+                        inner_ = std::begin(*outer_);
+                        settle();
+                    }
+                }
+
+                reference operator*() const { return *inner_; }
+                iterator &operator++() {
+                    ++inner_;
+                    settle();
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator result = *this;
+                    ++*this;
+                    return result;
+                }
+
+                // Past the end, the inner iterators are left over from the last range and not compared
+                friend bool operator==(const iterator &lhs, const iterator &rhs) {
+                    return lhs.outer_ == rhs.outer_ && (lhs.outer_ == lhs.end_ || lhs.inner_ == rhs.inner_);
+                }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                // Moves past exhausted inner ranges
+                void settle() {
+                    while (inner_ == std::end(*outer_)) {
+                        if (++outer_ == end_)
+                            return;
+                        inner_ = std::begin(*outer_);
+                    }
+                }
+
+                outer_iterator outer_;
+                outer_iterator end_;
+                inner_iterator inner_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            explicit flatten_view(Range &&range) : range_(std::move(range)) {}
+
+            iterator begin() const { return iterator(std::begin(range_), std::end(range_)); }
+            iterator end() const { return iterator(std::end(range_), std::end(range_)); }
+            bool empty() const { return begin() == end(); }
+
+            // Sum of the inner sizes, one step per inner range
+            template<typename R = inner_range>
+            typename std::enable_if<sized<const R>::value, size_type>::type size() const {
+                size_type size = 0;
+                for (const R &inner: range_) {
+                    size += inner.size();
+                }
+                return size;
+            }
+
+            template<typename R = inner_range>
+            segment_range<outer_iterator, segment_of_t<R>> segments() const {
+                return segment_range<outer_iterator, segment_of_t<R>>(std::begin(range_), std::end(range_));
+            }
+
+        private:
+            Range range_;
+        };
+
+        // Reference type of `concat`: the ranges' own when they agree, values of their common type otherwise
+        template<typename... Refs>
+        struct concat_reference : std::common_type<Refs...> {};
+        template<typename Ref, typename... Refs>
+        struct concat_reference<Ref, Ref, Refs...> : concat_reference<Ref, Refs...> {};
+        template<typename Ref>
+        struct concat_reference<Ref> {
+            using type = Ref;
+        };
+
+        // The one segment type of a list of segment types, if they are all the same
+        template<typename Segments, typename = void>
+        struct same_segment {};
+        template<typename Segment, typename... Segments>
+        struct same_segment<std::tuple<Segment, Segments...>,
+            typename std::enable_if<std::is_same<std::tuple<Segment, Segments...>, std::tuple<Segments..., Segment>>::value>::type> {
+            using type = Segment;
+        };
+
+        // Result of `concat`: the elements of several ranges, one range after the other, without copies. The ranges
+        // may differ in type, as long as their elements share a common type. When they are all contiguous with the
+        // same element type, `segments()` lists them, as for `flatten_view`.
+        template<typename... Ranges>
+        class concat_view {
+            static constexpr std::size_t count = sizeof...(Ranges);
+            template<std::size_t I>
+            using index = std::integral_constant<std::size_t, I>;
+            // Depends on `B` so that members using it are only formed when called
+            template<bool B, typename T>
+            using dependent = typename std::conditional<B, T, T>::type;
+            template<bool B>
+            using segment_type = typename same_segment<std::tuple<segment_of_t<const dependent<B, Ranges>>...>>::type;
+
+        public:
+            using base_iterators = std::tuple<decltype(std::begin(std::declval<const Ranges &>()))...>;
+
+            class iterator {
+            public:
+                using iterator_category = typename std::common_type<std::forward_iterator_tag,
+                    typename std::iterator_traits<decltype(std::begin(std::declval<const Ranges &>()))>::iterator_category...>::type;
+                using reference = typename concat_reference<
+                    typename std::iterator_traits<decltype(std::begin(std::declval<const Ranges &>()))>::reference...>::type;
+                using value_type = typename std::remove_cv<typename std::remove_reference<reference>::type>::type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+
+                iterator() : index_(count) {}
+                iterator(base_iterators current, base_iterators ends, std::size_t position) :
+                    current_(std::move(current)), ends_(std::move(ends)), index_(position) {
+                    settle(index<0> {});
+                }
+
+                reference operator*() const { return dereference(index<0> {}); }
+                iterator &operator++() {
+                    increment(index<0> {});
+                    settle(index<0> {});
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator result = *this;
+                    ++*this;
+                    return result;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) {
+                    return lhs.index_ == rhs.index_ && lhs.equal(rhs, index<0> {});
+                }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                // Each operation tests the ranges in order for the current one, unrolled at compile time
+                template<std::size_t I>
+                reference dereference(index<I>) const {
+                    if (index_ == I)
+                        return *std::get<I>(current_);
+                    return dereference(index<I + 1> {});
+                }
+                reference dereference(index<count - 1>) const { return *std::get<count - 1>(current_); }
+
+                template<std::size_t I>
+                void increment(index<I>) {
+                    if (index_ == I)
+                        ++std::get<I>(current_);
+                    else
+                        increment(index<I + 1> {});
+                }
+                void increment(index<count - 1>) { ++std::get<count - 1>(current_); }
+
+                // Moves past exhausted ranges; the end iterator has the index `count`
+                template<std::size_t I>
+                void settle(index<I>) {
+                    if (index_ == I && std::get<I>(current_) == std::get<I>(ends_))
+                        ++index_;
+                    settle(index<I + 1> {});
+                }
+                void settle(index<count>) {}
+
+                template<std::size_t I>
+                bool equal(const iterator &other, index<I>) const {
+                    return index_ == I ? std::get<I>(current_) == std::get<I>(other.current_) : equal(other, index<I + 1> {});
+                }
+                bool equal(const iterator &, index<count>) const { return true; }
+
+                base_iterators current_;
+                base_iterators ends_;
+                std::size_t index_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            explicit concat_view(Ranges &&... ranges) : ranges_(std::move(ranges)...) {}
+
+            iterator begin() const { return iterator(begins(make_index_sequence<count> {}), ends(make_index_sequence<count> {}), 0); }
+            iterator end() const { return iterator(ends(make_index_sequence<count> {}), ends(make_index_sequence<count> {}), count); }
+            bool empty() const { return begin() == end(); }
+
+            template<bool B = true>
+            typename std::enable_if<all_true<sized<const dependent<B, Ranges>>::value...>::value, size_type>::type size() const {
+                return sum_sizes(make_index_sequence<count> {});
+            }
+
+            template<bool B = true>
+            std::array<segment_type<B>, count> segments() const {
+                return segments_of<segment_type<B>>(make_index_sequence<count> {});
+            }
+
+        private:
+            template<std::size_t... Is>
+            base_iterators begins(index_sequence<Is...>) const { return base_iterators(std::begin(std::get<Is>(ranges_))...); }
+            template<std::size_t... Is>
+            base_iterators ends(index_sequence<Is...>) const { return base_iterators(std::end(std::get<Is>(ranges_))...); }
+            template<typename Segment, std::size_t... Is>
+            std::array<Segment, count> segments_of(index_sequence<Is...>) const {
+                return {{Segment(underlying(std::get<Is>(ranges_)).data(), underlying(std::get<Is>(ranges_)).size())...}};
+            }
+            template<std::size_t... Is>
+            size_type sum_sizes(index_sequence<Is...>) const {
+                size_type size = 0;
+                for (const size_type s: {static_cast<size_type>(std::get<Is>(ranges_).size())...}) {
+                    size += s;
+                }
+                return size;
+            }
+
+            std::tuple<Ranges...> ranges_;
+        };
+
+        // A window of `sliding` or `tumbling`: a range of base iterators, the elements are not copied
+        template<typename Iter>
+        class window {
+        public:
+            using iterator = Iter;
+            using const_iterator = Iter;
+            using value_type = typename std::iterator_traits<Iter>::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename std::iterator_traits<Iter>::difference_type;
+            using pointer = typename std::iterator_traits<Iter>::pointer;
+            using reference = typename std::iterator_traits<Iter>::reference;
+
+            window(Iter first, Iter last, std::size_t size) : first_(first), last_(last), size_(size) {}
+
+            Iter begin() const { return first_; }
+            Iter end() const { return last_; }
+            constexpr std::size_t size() const noexcept { return size_; }
+            constexpr bool empty() const noexcept { return size_ == 0; }
+
+        private:
+            Iter first_;
+            Iter last_;
+            std::size_t size_;
+        };
+
+        // Moves `first` up to `n` positions, not past `last`, and returns the number of positions moved
+        template<typename Iter>
+        std::size_t advance_bounded(Iter &first, const Iter &last, std::size_t n, std::true_type) {
+            const std::size_t moved = std::min<std::size_t>(static_cast<std::size_t>(last - first), n);
+            first += static_cast<typename std::iterator_traits<Iter>::difference_type>(moved);
+            return moved;
+        }
+        template<typename Iter>
+        std::size_t advance_bounded(Iter &first, const Iter &last, std::size_t n, std::false_type) {
+            std::size_t moved = 0;
+            for (; moved < n && first != last; ++moved) {
+                ++first;
+            }
+            return moved;
+        }
+
+        // Result of `sliding`: every run of `n` consecutive elements, advancing by one element
+        template<typename Range>
+        class sliding_view {
+        public:
+            using base_iterator = decltype(std::begin(std::declval<const Range &>()));
+
+            class iterator {
+            public:
+                using iterator_category = typename std::common_type<std::forward_iterator_tag,
+                    typename std::iterator_traits<base_iterator>::iterator_category>::type;
+                using value_type = window<base_iterator>;
+                using difference_type = typename std::iterator_traits<base_iterator>::difference_type;
+                using pointer = void;
+                using reference = value_type;
+
+                iterator() : size_(0) {}
+                iterator(base_iterator first, base_iterator last, base_iterator end, std::size_t size) : first_(first), last_(last), end_(end), size_(size) {}
+
+                reference operator*() const { return value_type(first_, last_, size_); }
+                // Past the last window, `first` joins `last` at the end of the range
+                iterator &operator++() {
+                    if (last_ == end_) {
+                        first_ = last_;
+                    } else {
+                        ++first_;
+                        ++last_;
+                    }
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator result = *this;
+                    ++*this;
+                    return result;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.first_ == rhs.first_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                base_iterator first_;
+                base_iterator last_;
+                base_iterator end_;
+                std::size_t size_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            sliding_view(Range &&range, std::size_t size) : range_(std::move(range)), size_(size) {
+                if (size_ == 0)
+                    throw std::invalid_argument("Window size must be positive.");
+            }
+
+            // A range shorter than a window has none
+            iterator begin() const {
+                base_iterator last = std::begin(range_);
+                if (advance_bounded(last, std::end(range_), size_, is_random_access_iterator<base_iterator> {}) < size_)
+                    return end();
+                return iterator(std::begin(range_), last, std::end(range_), size_);
+            }
+            iterator end() const { return iterator(std::end(range_), std::end(range_), std::end(range_), size_); }
+            bool empty() const { return begin() == end(); }
+
+            constexpr std::size_t window_size() const noexcept { return size_; }
+
+            // Number of windows
+            template<typename R = Range>
+            typename std::enable_if<sized<const R>::value, size_type>::type size() const {
+                return range_.size() >= size_ ? range_.size() - size_ + 1 : 0;
+            }
+
+        private:
+            Range range_;
+            std::size_t size_;
+        };
+
+        // Result of `tumbling`: consecutive windows of `n` elements that don't overlap, the last one possibly shorter
+        template<typename Range>
+        class tumbling_view {
+        public:
+            using base_iterator = decltype(std::begin(std::declval<const Range &>()));
+
+            class iterator {
+            public:
+                using iterator_category = typename std::common_type<std::forward_iterator_tag,
+                    typename std::iterator_traits<base_iterator>::iterator_category>::type;
+                using value_type = window<base_iterator>;
+                using difference_type = typename std::iterator_traits<base_iterator>::difference_type;
+                using pointer = void;
+                using reference = value_type;
+
+                iterator() : size_(0), count_(0) {}
+                iterator(base_iterator first, base_iterator end, std::size_t size) : first_(first), last_(first), end_(end), size_(size), count_(0) {
+                    fill();
+                }
+
+                reference operator*() const { return value_type(first_, last_, count_); }
+                iterator &operator++() {
+                    first_ = last_;
+                    fill();
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator result = *this;
+                    ++*this;
+                    return result;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.first_ == rhs.first_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                void fill() { count_ = advance_bounded(last_, end_, size_, is_random_access_iterator<base_iterator> {}); }
+
+                base_iterator first_;
+                base_iterator last_;
+                base_iterator end_;
+                std::size_t size_;
+                std::size_t count_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            tumbling_view(Range &&range, std::size_t size) : range_(std::move(range)), size_(size) {
+                if (size_ == 0)
+                    throw std::invalid_argument("Window size must be positive.");
+            }
+
+            iterator begin() const { return iterator(std::begin(range_), std::end(range_), size_); }
+            iterator end() const { return iterator(std::end(range_), std::end(range_), size_); }
+            bool empty() const { return begin() == end(); }
+
+            constexpr std::size_t window_size() const noexcept { return size_; }
+
+            // Number of windows
+            template<typename R = Range>
+            typename std::enable_if<sized<const R>::value, size_type>::type size() const { return (range_.size() + size_ - 1) / size_; }
+
+        private:
+            Range range_;
+            std::size_t size_;
+        };
+
+        // Fixed capacity FIFO, which can also drop its newest entry: the buffer of the window states
+        template<typename T>
+        class window_ring {
+        public:
+            explicit window_ring(std::size_t capacity) : slots_(capacity), head_(0), size_(0) {}
+
+            bool empty() const noexcept { return size_ == 0; }
+            std::size_t size() const noexcept { return size_; }
+            const T &front() const noexcept { return slots_[head_]; }
+            const T &back() const noexcept { return slots_[slot(size_ - 1)]; }
+
+            void push_back(T value) {
+                assert(size_ < slots_.size());
+                slots_[slot(size_)] = std::move(value);
+                ++size_;
+            }
+            void pop_front() noexcept {
+                head_ = slot(1);
+                --size_;
+            }
+            void pop_back() noexcept { --size_; }
+            void clear() noexcept {
+                head_ = 0;
+                size_ = 0;
+            }
+
+        private:
+            std::size_t slot(std::size_t offset) const noexcept {
+                const std::size_t index = head_ + offset;
+                return index < slots_.size() ? index : index - slots_.size();
+            }
+
+            std::vector<T> slots_;
+            std::size_t head_;
+            std::size_t size_;
+        };
+
+        // Incremental aggregate of a sliding window of `Element`s: `push` enters the newest element, `pop` removes the
+        // oldest, `value` is the aggregate of the elements in between. Specialized for the aggregators supporting it.
+        template<typename Aggregator, typename Element>
+        class window_state {
+            static_assert(sizeof(Aggregator) == 0, "Sliding windows support agg::count, agg::sum, agg::mean, agg::min and agg::max");
+        };
+
+        template<typename Element>
+        class window_state<agg::count_aggregator, Element> {
+        public:
+            window_state(const agg::count_aggregator &, std::size_t) noexcept : count_(0) {}
+
+            void reset() noexcept { count_ = 0; }
+            void push(const Element &) noexcept { ++count_; }
+            void pop() noexcept { --count_; }
+            std::size_t value() const noexcept { return count_; }
+
+        private:
+            std::size_t count_;
+        };
+
+        // The projected elements are kept so they can be subtracted when they leave. Floating point sums accumulate
+        // the rounding of every subtraction.
+        template<typename Proj, typename Element>
+        class window_state<agg::sum_aggregator<Proj>, Element> {
+        public:
+            using value_type = typename std::decay<decltype(std::declval<const Proj &>()(std::declval<const Element &>()))>::type;
+
+            window_state(const agg::sum_aggregator<Proj> &aggregator, std::size_t size) : aggregator_(aggregator), values_(size), sum_() {}
+
+            void reset() {
+                values_.clear();
+                sum_ = value_type();
+            }
+            void push(const Element &element) {
+                value_type value = aggregator_.projection(element);
+                sum_ += value;
+                values_.push_back(std::move(value));
+            }
+            void pop() {
+                sum_ -= values_.front();
+                values_.pop_front();
+            }
+            const value_type &value() const noexcept { return sum_; }
+
+        private:
+            agg::sum_aggregator<Proj> aggregator_;
+            window_ring<value_type> values_;
+            value_type sum_;
+        };
+
+        template<typename Proj, typename Element>
+        class window_state<agg::mean_aggregator<Proj>, Element> {
+        public:
+            window_state(const agg::mean_aggregator<Proj> &aggregator, std::size_t size) : aggregator_(aggregator), values_(size), sum_(0) {}
+
+            void reset() {
+                values_.clear();
+                sum_ = 0;
+            }
+            void push(const Element &element) {
+                const double value = static_cast<double>(aggregator_.projection(element));
+                sum_ += value;
+                values_.push_back(value);
+            }
+            void pop() {
+                sum_ -= values_.front();
+                values_.pop_front();
+            }
+            double value() const noexcept { return sum_ / static_cast<double>(values_.size()); }
+
+        private:
+            agg::mean_aggregator<Proj> aggregator_;
+            window_ring<double> values_;
+            double sum_;
+        };
+
+        // Monotonic deque: the elements of the window that no later element beats, best first. An element entering
+        // drops the ones it beats from the back, so each element is pushed and dropped at most once. Ties keep the
+        // earlier element, which is the first of equivalent extrema, as with `agg::min` and `agg::max`.
+        template<typename Proj, typename Compare, typename Element>
+        class window_state<agg::extremum_aggregator<Proj, Compare>, Element> {
+        public:
+            using value_type = typename std::decay<decltype(std::declval<const Proj &>()(std::declval<const Element &>()))>::type;
+
+            window_state(const agg::extremum_aggregator<Proj, Compare> &aggregator, std::size_t size) :
+                aggregator_(aggregator), candidates_(size), pushed_(0), popped_(0) {}
+
+            void reset() {
+                candidates_.clear();
+                pushed_ = 0;
+                popped_ = 0;
+            }
+            void push(const Element &element) {
+                value_type value = aggregator_.projection(element);
+                while (!candidates_.empty() && aggregator_.compare(value, candidates_.back().value)) {
+                    candidates_.pop_back();
+                }
+                candidates_.push_back(candidate {std::move(value), pushed_++});
+            }
+            // The oldest element is still a candidate only if it is the best one
+            void pop() {
+                if (candidates_.front().index == popped_)
+                    candidates_.pop_front();
+                ++popped_;
+            }
+            const value_type &value() const noexcept { return candidates_.front().value; }
+
+        private:
+            struct candidate {
+                value_type value;
+                std::size_t index;
+            };
+
+            agg::extremum_aggregator<Proj, Compare> aggregator_;
+            window_ring<candidate> candidates_;
+            std::size_t pushed_;
+            std::size_t popped_;
+        };
+
+        // Result of `sliding(n, aggregator)`: the aggregate of every window of `sliding(n)`, updated in O(1) amortized
+        // as the window moves by one element. The window state is kept by the view and reset by `begin`, so the view
+        // supports one traversal at a time, and its iterators are input iterators. Each element is read once.
+        template<typename Range, typename Aggregator>
+        class sliding_aggregate_view {
+        public:
+            using base_iterator = decltype(std::begin(std::declval<const Range &>()));
+            using state_type = window_state<Aggregator, typename std::iterator_traits<base_iterator>::value_type>;
+
+            class iterator {
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = typename std::decay<decltype(std::declval<const state_type &>().value())>::type;
+                using difference_type = typename std::iterator_traits<base_iterator>::difference_type;
+                using pointer = void;
+                using reference = value_type;
+
+                iterator() : view_(nullptr), done_(true) {}
+                iterator(const sliding_aggregate_view *view, base_iterator current, base_iterator end, bool done) :
+                    view_(view), current_(current), end_(end), done_(done) {}
+
+                reference operator*() const { return view_->state_.value(); }
+                iterator &operator++() {
+                    if (current_ == end_) {
+                        done_ = true;
+                    } else {
+                        view_->state_.pop();
+                        view_->state_.push(*current_);
+                        ++current_;
+                    }
+                    return *this;
+                }
+                void operator++(int) { ++*this; }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) {
+                    return lhs.done_ == rhs.done_ && (lhs.done_ || lhs.current_ == rhs.current_);
+                }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                const sliding_aggregate_view *view_;
+                base_iterator current_;
+                base_iterator end_;
+                bool done_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            sliding_aggregate_view(Range &&range, std::size_t size, const Aggregator &aggregator) :
+                range_(std::move(range)), size_(size), state_(aggregator, size) {
+                if (size_ == 0)
+                    throw std::invalid_argument("Window size must be positive.");
+            }
+
+            // Starts over from the first window
+            iterator begin() const {
+                state_.reset();
+                base_iterator current = std::begin(range_);
+                for (std::size_t i = 0; i < size_; ++i, ++current) {
+                    if (current == std::end(range_))
+                        return end();
+                    state_.push(*current);
+                }
+                return iterator(this, current, std::end(range_), false);
+            }
+            iterator end() const { return iterator(this, std::end(range_), std::end(range_), true); }
+
+            constexpr std::size_t window_size() const noexcept { return size_; }
+
+            // Number of windows
+            template<typename R = Range>
+            typename std::enable_if<sized<const R>::value, size_type>::type size() const {
+                return range_.size() >= size_ ? range_.size() - size_ + 1 : 0;
+            }
+
+        private:
+            Range range_;
+            std::size_t size_;
+            mutable state_type state_;
+        };
+
+        // Result of `tumbling(n, aggregator)`: the aggregate of every window of `tumbling(n)`, computed from scratch
+        // when dereferenced, since the windows don't share elements. Any aggregator of `aggregate_by` works.
+        template<typename Range, typename Aggregator>
+        class tumbling_aggregate_view {
+        public:
+            using base_iterator = decltype(std::begin(std::declval<const Range &>()));
+            using window_iterator = typename tumbling_view<Range>::iterator;
+
+            class iterator {
+            public:
+                using iterator_category = typename window_iterator::iterator_category;
+                using value_type = typename std::decay<decltype(std::declval<const Aggregator &>().finish(
+                    std::declval<const Aggregator &>().start(*std::declval<base_iterator>())))>::type;
+                using difference_type = typename window_iterator::difference_type;
+                using pointer = void;
+                using reference = value_type;
+
+                iterator() : aggregator_(nullptr) {}
+                iterator(const Aggregator *aggregator, window_iterator current) : aggregator_(aggregator), current_(current) {}
+
+                // Windows are never empty
+                reference operator*() const {
+                    const auto elements = *current_;
+                    auto it = elements.begin();
+                    auto state = aggregator_->start(*it);
+                    for (++it; it != elements.end(); ++it) {
+                        aggregator_->add(state, *it);
+                    }
+                    return aggregator_->finish(std::move(state));
+                }
+                iterator &operator++() {
+                    ++current_;
+                    return *this;
+                }
+                iterator operator++(int) {
+                    iterator result = *this;
+                    ++*this;
+                    return result;
+                }
+
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.current_ == rhs.current_; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+                const Aggregator *aggregator_;
+                window_iterator current_;
+            };
+
+            using const_iterator = iterator;
+            using value_type = typename iterator::value_type;
+            using size_type = std::size_t;
+            using difference_type = typename iterator::difference_type;
+            using pointer = typename iterator::pointer;
+            using reference = typename iterator::reference;
+
+            tumbling_aggregate_view(Range &&range, std::size_t size, const Aggregator &aggregator) :
+                range_(std::move(range)), size_(size), aggregator_(aggregator) {
+                if (size_ == 0)
+                    throw std::invalid_argument("Window size must be positive.");
+            }
+
+            iterator begin() const { return iterator(&aggregator_, window_iterator(std::begin(range_), std::end(range_), size_)); }
+            iterator end() const { return iterator(&aggregator_, window_iterator(std::end(range_), std::end(range_), size_)); }
+            bool empty() const { return begin() == end(); }
+
+            constexpr std::size_t window_size() const noexcept { return size_; }
+
+            // Number of windows
+            template<typename R = Range>
+            typename std::enable_if<sized<const R>::value, size_type>::type size() const { return (range_.size() + size_ - 1) / size_; }
+
+        private:
+            Range range_;
+            std::size_t size_;
+            Aggregator aggregator_;
+        };
+
+        using sliding_adaptor = count_adaptor<sliding_view>;
+        using tumbling_adaptor = count_adaptor<tumbling_view>;
+
+        // `range | sliding(n, aggregator)` and `range | tumbling(n, aggregator)`. Lvalue ranges are referenced and
+        // rvalue ranges are moved into the view.
+        template<template<typename, typename> class View, typename Aggregator>
+        class window_aggregate_adaptor : public adaptor_closure {
+        public:
+            window_aggregate_adaptor(std::size_t size, const Aggregator &aggregator) : size_(size), aggregator_(aggregator) {}
+
+        private:
+            template<typename Range>
+            View<stored_range_t<Range>, Aggregator> apply(Range &&range) const {
+                return View<stored_range_t<Range>, Aggregator>{store_range(std::forward<Range>(range)), size_, aggregator_};
+            }
+
+            std::size_t size_;
+            Aggregator aggregator_;
+
+        public:
+            template<typename Range, typename = typename std::enable_if<!is_adaptor_closure<Range>::value>::type>
+            friend auto operator|(Range &&range, const window_aggregate_adaptor &adaptor) -> decltype(adaptor.apply(std::forward<Range>(range))) {
+                return adaptor.apply(std::forward<Range>(range));
+            }
+            template<typename Next, typename = typename std::enable_if<is_adaptor_closure<Next>::value>::type>
+            friend adaptor_pipeline<window_aggregate_adaptor, Next> operator|(const window_aggregate_adaptor &adaptor, const Next &next) {
+                return adaptor_pipeline<window_aggregate_adaptor, Next>{adaptor, next};
+            }
+        };
+
+#if RANGED_HAS_MMAP
+        // Result of `external_sort`: the sorted runs, merged as they are read. Spilled runs are read through a mapping
+        // of the spill file, whose clean pages the kernel drops under memory pressure; the last run stays in memory.
+        template<typename T, typename Compare>
+        class external_sort_view {
+            static_assert(std::is_trivially_copyable<T>::value, "Spilled elements must be trivially copyable");
+
+        public:
+            // Offset and number of elements of a sorted run
+            using run = std::pair<std::size_t, std::size_t>;
+            using merge_type = merge_view<span<const T>, Compare, false>;
+            using iterator = typename merge_type::iterator;
+            using const_iterator = iterator;
+            using value_type = T;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = const T &;
+
+            external_sort_view(mapped_file &&spill, const std::vector<run> &spilled, std::vector<T> &&memory, const std::vector<run> &resident,
+                               const Compare &compare) :
+                spill_(std::move(spill)), memory_(std::move(memory)), merged_(runs(spill_, spilled, memory_, resident), compare) {}
+
+            iterator begin() const { return merged_.begin(); }
+            iterator end() const { return merged_.end(); }
+
+            size_type size() const { return merged_.size(); }
+            // Bytes read back from the spill file, 0 when the input fit in memory
+            size_type spilled_bytes() const noexcept { return spill_.size(); }
+
+        private:
+            static std::vector<span<const T>> runs(const mapped_file &spill, const std::vector<run> &spilled, const std::vector<T> &memory,
+                                                   const std::vector<run> &resident) {
+                std::vector<span<const T>> result;
+                result.reserve(spilled.size() + resident.size());
+                // The mapping is page aligned and runs start at multiples of `sizeof(T)`
+                const T *file = reinterpret_cast<const T *>(spill.data());
+                for (const run &r: spilled) {
+                    result.emplace_back(file + r.first, r.second);
+                }
+                for (const run &r: resident) {
+                    result.emplace_back(memory.data() + r.first, r.second);
+                }
+                return result;
+            }
+
+            mapped_file spill_;
+            std::vector<T> memory_;
+            merge_type merged_;
+        };
+#endif
+    } // namespace views
+
+    // Tuning of a `pipeline`. Elements travel between threads in batches of `batch_size`; every queue holds up to
+    // `queue_capacity` batches (rounded up to a power of two), and a full queue blocks its producers. Unordered
+    // pipelines hand results over as soon as any replica finishes them.
+    struct pipeline_options {
+        constexpr pipeline_options(std::size_t batch_size = 256, std::size_t queue_capacity = 8, bool ordered = true) noexcept :
+            batch_size(batch_size != 0 ? batch_size : 1), queue_capacity(queue_capacity), ordered(ordered) {}
+
+        std::size_t batch_size;
+        std::size_t queue_capacity;
+        bool ordered;
+    };
+
+    // Counters of one thread group of a `pipeline` run, see `async_pipeline::stats`. The queue counters describe the
+    // queue the group reads from, so they are 0 for the source.
+    struct pipeline_stage_stats {
+        std::size_t replicas;
+        std::uint64_t batches;
+        std::uint64_t items_in;
+        std::uint64_t items_out;
+        // Time spent inside the stage callable (reading the range for the source), summed over the replicas
+        std::chrono::nanoseconds busy;
+        std::size_t queue_capacity;
+        std::size_t queue_peak;
+        // Pushes that found the queue full (backpressure on the previous stage), pops that found it empty
+        std::uint64_t queue_full_waits;
+        std::uint64_t queue_empty_waits;
+
+        // Items per second the stage could sustain with its replicas if it never waited. The lowest one bounds the
+        // pipeline and is the stage to replicate.
+        double throughput() const noexcept {
+            return busy.count() == 0 ? 0.0 : static_cast<double>(items_in) * 1e9 * static_cast<double>(replicas) / static_cast<double>(busy.count());
+        }
+    };
+
+    struct pipeline_counters {
+        pipeline_counters() noexcept :
+            replicas(0), batches(0), items_in(0), items_out(0), busy(0), queue_capacity(0), queue_peak(0), queue_full_waits(0), queue_empty_waits(0) {}
+
+        void record(std::size_t in, std::size_t out, std::chrono::steady_clock::duration elapsed) noexcept {
+            batches.fetch_add(1, std::memory_order_relaxed);
+            items_in.fetch_add(in, std::memory_order_relaxed);
+            items_out.fetch_add(out, std::memory_order_relaxed);
+            busy.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), std::memory_order_relaxed);
+        }
+
+        pipeline_stage_stats snapshot() const noexcept {
+            return pipeline_stage_stats {replicas, batches.load(std::memory_order_relaxed), items_in.load(std::memory_order_relaxed),
+                                         items_out.load(std::memory_order_relaxed),
+                                         std::chrono::nanoseconds(static_cast<std::int64_t>(busy.load(std::memory_order_relaxed))), queue_capacity,
+                                         queue_peak.load(std::memory_order_relaxed), queue_full_waits.load(std::memory_order_relaxed),
+                                         queue_empty_waits.load(std::memory_order_relaxed)};
+        }
+
+        std::size_t replicas;
+        std::atomic<std::uint64_t> batches;
+        std::atomic<std::uint64_t> items_in;
+        std::atomic<std::uint64_t> items_out;
+        std::atomic<std::uint64_t> busy;
+        std::size_t queue_capacity;
+        std::atomic<std::size_t> queue_peak;
+        std::atomic<std::uint64_t> queue_full_waits;
+        std::atomic<std::uint64_t> queue_empty_waits;
+    };
+
+    // Waiting on a full or empty queue: yield a few times, then sleep, so a blocked stage leaves the core to the
+    // stage it waits for
+    struct pipeline_backoff {
+        pipeline_backoff() noexcept : rounds(0) {}
+
+        void wait() {
+            if (rounds < 16) {
+                ++rounds;
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+
+        unsigned rounds;
+    };
+
+    template<typename T>
+    struct pipeline_batch {
+        std::size_t sequence;
+        std::vector<T> items;
+    };
+
+    // Queue of batches between two thread groups: an `spsc_queue` between single threads, an `mpmc_queue` as soon as
+    // a side is replicated. It closes when the last producer is done, and every wait gives up once the run is
+    // cancelled.
+    template<typename T>
+    class pipeline_channel {
+    public:
+        pipeline_channel(std::size_t capacity, std::size_t producers, std::size_t consumers, pipeline_counters &counters,
+                         const std::atomic<bool> &cancelled) :
+            single_(producers == 1 && consumers == 1 ? new spsc_queue<pipeline_batch<T>>(capacity) : nullptr),
+            shared_(single_ ? nullptr : new mpmc_queue<pipeline_batch<T>>(capacity)), producers_(producers), closed_(false),
+            counters_(&counters), cancelled_(&cancelled) {
+            counters.queue_capacity = single_ ? single_->capacity() : shared_->capacity();
+        }
+
+        // Blocks while the queue is full; false when the run was cancelled
+        bool push(pipeline_batch<T> &&batch) {
+            pipeline_backoff backoff;
+            while (!try_push(std::move(batch))) {
+                if (backoff.rounds == 0)
+                    counters_->queue_full_waits.fetch_add(1, std::memory_order_relaxed);
+                if (cancelled_->load(std::memory_order_relaxed))
+                    return false;
+                backoff.wait();
+            }
+            const std::size_t occupancy = single_ ? single_->size() : shared_->size();
+            std::size_t peak = counters_->queue_peak.load(std::memory_order_relaxed);
+            while (occupancy > peak && !counters_->queue_peak.compare_exchange_weak(peak, occupancy, std::memory_order_relaxed)) {}
+            return true;
+        }
+        // Blocks while the queue is empty and open; false once it is closed and drained, or the run was cancelled
+        bool pop(pipeline_batch<T> &batch) {
+            pipeline_backoff backoff;
+            while (!try_pop(batch)) {
+                if (closed_.load(std::memory_order_acquire))
+                    return try_pop(batch);
+                if (backoff.rounds == 0)
+                    counters_->queue_empty_waits.fetch_add(1, std::memory_order_relaxed);
+                if (cancelled_->load(std::memory_order_relaxed))
+                    return false;
+                backoff.wait();
+            }
+            return true;
+        }
+        // Called once by every producer when it is done
+        void close() noexcept {
+            if (producers_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                closed_.store(true, std::memory_order_release);
+        }
+
+    private:
+        bool try_push(pipeline_batch<T> &&batch) { return single_ ? single_->try_push(std::move(batch)) : shared_->try_push(std::move(batch)); }
+        bool try_pop(pipeline_batch<T> &batch) { return single_ ? single_->try_pop(batch) : shared_->try_pop(batch); }
+
+        std::unique_ptr<spsc_queue<pipeline_batch<T>>> single_;
+        std::unique_ptr<mpmc_queue<pipeline_batch<T>>> shared_;
+        std::atomic<std::size_t> producers_;
+        std::atomic<bool> closed_;
+        pipeline_counters *counters_;
+        const std::atomic<bool> *cancelled_;
+    };
+
+    // Threads and queues of one `pipeline` run. The first exception thrown by any thread cancels the run and is
+    // rethrown by `finish`; destroying an unfinished run cancels it and joins the threads.
+    class pipeline_runtime {
+    public:
+        pipeline_runtime(pipeline_counters *counters, const pipeline_options &options, std::size_t window) :
+            counters_(counters), options_(options), window_(window), cancelled_(false), delivered_(0) {}
+        ~pipeline_runtime() {
+            cancelled_.store(true, std::memory_order_relaxed);
+            join();
+        }
+
+        pipeline_runtime(const pipeline_runtime &) = delete;
+        pipeline_runtime &operator=(const pipeline_runtime &) = delete;
+
+        // Queue read by the thread group `stage`, owned by the run
+        template<typename T>
+        pipeline_channel<T> &channel(std::size_t stage, std::size_t producers, std::size_t consumers) {
+            const std::shared_ptr<pipeline_channel<T>> result =
+                std::make_shared<pipeline_channel<T>>(options_.queue_capacity, producers, consumers, counters_[stage], cancelled_);
+            channels_.push_back(result);
+            return *result;
+        }
+
+        template<typename Task>
+        void spawn(const Task &task) {
+            threads_.emplace_back([this, task] {
+                try {
+                    task();
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+            });
+        }
+
+        void fail(std::exception_ptr error) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_)
+                    error_ = error;
+            }
+            cancelled_.store(true, std::memory_order_relaxed);
+        }
+
+        // Ordered runs keep the source at most `window` batches ahead of the consumer, which bounds the reordering
+        bool wait_window(std::size_t sequence) {
+            if (!options_.ordered)
+                return true;
+            pipeline_backoff backoff;
+            while (sequence >= delivered_.load(std::memory_order_acquire) + window_) {
+                if (cancelled_.load(std::memory_order_relaxed))
+                    return false;
+                backoff.wait();
+            }
+            return true;
+        }
+
+        // Runs on the calling thread: hands every element of `output` to `emit`, in source order when ordered
+        template<typename T, typename Emit>
+        void drain(pipeline_channel<T> &output, std::size_t stage, const Emit &emit) {
+            pipeline_counters &counters = counters_[stage];
+            counters.replicas = 1;
+            pipeline_batch<T> batch;
+            if (!options_.ordered) {
+                while (output.pop(batch)) {
+                    deliver(batch.items, counters, emit);
+                }
+                return;
+            }
+
+            // Batches that arrived ahead of their turn, at `sequence % window`
+            std::vector<pipeline_batch<T>> pending(window_);
+            std::vector<bool> present(window_, false);
+            std::size_t next = 0;
+            while (output.pop(batch)) {
+                const std::size_t slot = batch.sequence % window_;
+                pending[slot] = std::move(batch);
+                present[slot] = true;
+                for (std::size_t current; present[current = next % window_]; ++next) {
+                    present[current] = false;
+                    deliver(pending[current].items, counters, emit);
+                    delivered_.store(next + 1, std::memory_order_release);
+                }
+            }
+        }
+
+        void finish() {
+            join();
+            if (error_)
+                std::rethrow_exception(error_);
+        }
+
+        const pipeline_options &options() const noexcept { return options_; }
+        pipeline_counters &counters(std::size_t stage) noexcept { return counters_[stage]; }
+
+    private:
+        template<typename T, typename Emit>
+        static void deliver(std::vector<T> &items, pipeline_counters &counters, const Emit &emit) {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (T &item: items) {
+                emit(item);
+            }
+            counters.record(items.size(), items.size(), std::chrono::steady_clock::now() - start);
+        }
+
+        void join() noexcept {
+            for (std::thread &thread: threads_) {
+                if (thread.joinable())
+                    thread.join();
+            }
+            threads_.clear();
+        }
+
+        pipeline_counters *counters_;
+        const pipeline_options options_;
+        const std::size_t window_;
+        std::atomic<bool> cancelled_;
+        std::atomic<std::size_t> delivered_;
+        std::vector<std::shared_ptr<void>> channels_;
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        std::exception_ptr error_;
+    };
+
+    // First thread group of a `pipeline`: one thread copying the range into batches
+    template<typename Range>
+    class pipeline_source {
+    public:
+        using value_type = typename std::decay<decltype(*std::begin(std::declval<const Range &>()))>::type;
+        static constexpr std::size_t depth = 0;
+
+        explicit pipeline_source(Range &&range) : range_(std::move(range)) {}
+
+        std::size_t replicas() const noexcept { return 1; }
+        std::size_t threads() const noexcept { return 1; }
+
+        void launch(pipeline_runtime &run, pipeline_channel<value_type> &output) const {
+            run.counters(depth).replicas = 1;
+            run.spawn([this, &run, &output] { produce(run, output); });
+        }
+
+    private:
+        void produce(pipeline_runtime &run, pipeline_channel<value_type> &output) const {
+            const std::size_t batch_size = run.options().batch_size;
+            pipeline_counters &counters = run.counters(depth);
+            pipeline_batch<value_type> batch {0, std::vector<value_type>()};
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            auto emit = [&]() -> bool {
+                const std::size_t size = batch.items.size();
+                counters.record(size, size, std::chrono::steady_clock::now() - start);
+                const std::size_t sequence = batch.sequence;
+                if (!run.wait_window(sequence) || !output.push(std::move(batch)))
+                    return false;
+                batch.sequence = sequence + 1;
+                batch.items.clear();
+                start = std::chrono::steady_clock::now();
+                return true;
+            };
+
+            for (auto it = std::begin(range_), end = std::end(range_); it != end; ++it) {
+                if (batch.items.empty())
+                    batch.items.reserve(batch_size);
+                batch.items.push_back(*it);
+                if (batch.items.size() == batch_size && !emit())
+                    return;
+            }
+            if (!batch.items.empty())
+                emit();
+            output.close();
+        }
+
+        Range range_;
+    };
+
+    // Stage applying `Func` to every element, see `async_pipeline::transform`
+    template<typename T, typename Func>
+    struct pipeline_transform {
+        using function_type = callable_t<Func>;
+        using output_type = typename std::decay<typename std::result_of<const function_type &(T &&)>::type>::type;
+
+        explicit pipeline_transform(const Func &func) : func(func) {}
+
+        void operator()(std::vector<T> &input, std::vector<output_type> &output) const {
+            output.reserve(input.size());
+            for (T &item: input) {
+                output.push_back(func(std::move(item)));
+            }
+        }
+
+        function_type func;
+    };
+
+    // Stage keeping the elements satisfying `Pred`, see `async_pipeline::filter`
+    template<typename T, typename Pred>
+    struct pipeline_filter {
+        using function_type = callable_t<Pred>;
+        using output_type = T;
+
+        explicit pipeline_filter(const Pred &pred) : pred(pred) {}
+
+        void operator()(std::vector<T> &input, std::vector<T> &output) const {
+            std::size_t kept = 0;
+            for (T &item: input) {
+                if (pred(static_cast<const T &>(item))) {
+                    if (&item != &input[kept])
+                        input[kept] = std::move(item);
+                    ++kept;
+                }
+            }
+            input.resize(kept);
+            output.swap(input);
+        }
+
+        function_type pred;
+    };
+
+    // Stage `Stage` run by `replicas` threads, after the thread groups of `Upstream`
+    template<typename Upstream, typename Stage>
+    class pipeline_link {
+    public:
+        using input_type = typename Upstream::value_type;
+        using value_type = typename Stage::output_type;
+        static constexpr std::size_t depth = Upstream::depth + 1;
+
+        pipeline_link(Upstream &&upstream, Stage &&stage, std::size_t replicas) :
+            upstream_(std::move(upstream)), stage_(std::move(stage)), replicas_(replicas != 0 ? replicas : std::max<std::size_t>(std::thread::hardware_concurrency(), 1)) {}
+
+        std::size_t replicas() const noexcept { return replicas_; }
+        std::size_t threads() const noexcept { return upstream_.threads() + replicas_; }
+
+        void launch(pipeline_runtime &run, pipeline_channel<value_type> &output) const {
+            pipeline_channel<input_type> &input = run.template channel<input_type>(depth, upstream_.replicas(), replicas_);
+            run.counters(depth).replicas = replicas_;
+            for (std::size_t i{0}; i < replicas_; ++i) {
+                run.spawn([this, &run, &input, &output] { process(run, input, output); });
+            }
+            upstream_.launch(run, input);
+        }
+
+    private:
+        void process(pipeline_runtime &run, pipeline_channel<input_type> &input, pipeline_channel<value_type> &output) const {
+            pipeline_counters &counters = run.counters(depth);
+            pipeline_batch<input_type> batch;
+            while (input.pop(batch)) {
+                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                // Filtered out batches still travel, empty, so ordered runs see every sequence number
+                pipeline_batch<value_type> result {batch.sequence, std::vector<value_type>()};
+                const std::size_t size = batch.items.size();
+                stage_(batch.items, result.items);
+                counters.record(size, result.items.size(), std::chrono::steady_clock::now() - start);
+                if (!output.push(std::move(result)))
+                    return;
+            }
+            output.close();
+        }
+
+        Upstream upstream_;
+        Stage stage_;
+        std::size_t replicas_;
+    };
+
+    // Result of `pipeline`: a chain of stages, each run by its own threads, connected by bounded lock-free queues of
+    // batches. Building does not start anything; `for_each` and `to` run the whole chain, consuming the results on
+    // the calling thread, and return when the source is exhausted. Stage callables are shared by their replicas and
+    // must be safe to call concurrently.
+    template<typename Chain>
+    class async_pipeline {
+    public:
+        using value_type = typename Chain::value_type;
+
+        async_pipeline(Chain &&chain, const pipeline_options &options) : chain_(std::move(chain)), options_(options) {}
+
+        // Adds a stage calling `func` on every element, run by `replicas` threads (0 - one per hardware thread)
+        template<typename Func>
+        async_pipeline<pipeline_link<Chain, pipeline_transform<value_type, Func>>> transform(const Func &func, std::size_t replicas = 1) && {
+            return {pipeline_link<Chain, pipeline_transform<value_type, Func>>(std::move(chain_), pipeline_transform<value_type, Func>(func), replicas),
+                    options_};
+        }
+        template<typename Func>
+        async_pipeline<pipeline_link<Chain, pipeline_transform<value_type, Func>>> transform(const Func &func, std::size_t replicas = 1) const & {
+            return async_pipeline(Chain(chain_), options_).transform(func, replicas);
+        }
+        // Adds a stage keeping the elements satisfying `pred`, run by `replicas` threads (0 - one per hardware thread)
+        template<typename Pred>
+        async_pipeline<pipeline_link<Chain, pipeline_filter<value_type, Pred>>> filter(const Pred &pred, std::size_t replicas = 1) && {
+            return {pipeline_link<Chain, pipeline_filter<value_type, Pred>>(std::move(chain_), pipeline_filter<value_type, Pred>(pred), replicas),
+                    options_};
+        }
+        template<typename Pred>
+        async_pipeline<pipeline_link<Chain, pipeline_filter<value_type, Pred>>> filter(const Pred &pred, std::size_t replicas = 1) const & {
+            return async_pipeline(Chain(chain_), options_).filter(pred, replicas);
+        }
+
+        // Runs the pipeline, calling `sink` on the calling thread for every result. The first exception thrown by a
+        // stage or by `sink` stops every thread and is rethrown.
+        template<typename Func>
+        void for_each(const Func &sink) {
+            run([&sink](value_type &item) { sink(item); });
+        }
+        // Runs the pipeline into a new container
+        template<template<typename, typename...> class Tt>
+        Tt<value_type> to() {
+            Tt<value_type> result;
+            run([&result](value_type &item) { result.insert(result.end(), std::move(item)); });
+            return result;
+        }
+
+        // Counters of the last run, which may still be going (e.g. when called from the sink): the source first, then
+        // every stage in order, then the consuming thread
+        std::vector<pipeline_stage_stats> stats() const {
+            std::vector<pipeline_stage_stats> result;
+            if (counters_) {
+                result.reserve(Chain::depth + 2);
+                for (std::size_t i{0}; i < Chain::depth + 2; ++i) {
+                    result.push_back(counters_[i].snapshot());
+                }
+            }
+            return result;
+        }
+
+    private:
+        template<typename Emit>
+        void run(const Emit &emit) {
+            counters_.reset(new pipeline_counters[Chain::depth + 2]);
+            // Every queue full, plus a batch in and out of every thread
+            const std::size_t window = spsc_queue<int>::ring_capacity(options_.queue_capacity) * (Chain::depth + 1) + 2 * chain_.threads();
+            pipeline_runtime runtime(counters_.get(), options_, window);
+            pipeline_channel<value_type> &output = runtime.template channel<value_type>(Chain::depth + 1, chain_.replicas(), 1);
+            chain_.launch(runtime, output);
+            runtime.drain(output, Chain::depth + 1, emit);
+            runtime.finish();
+        }
+
+        Chain chain_;
+        pipeline_options options_;
+        std::unique_ptr<pipeline_counters[]> counters_;
+    };
+
+    template<std_container T, typename Pred>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::any_of` instead")]]
+#endif
+    constexpr bool any(const T &container, const Pred &func);
+    template<std_container T, typename Pred>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::any_of` instead")]]
+#endif
+    constexpr bool any(T &container, const Pred &func);
+    template<std_container T, typename Pred>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::all_of` instead")]]
+#endif
+    constexpr bool all(const T &container, const Pred &func);
+    template<std_container T, typename Pred>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::all_of` instead")]]
+#endif
+    constexpr bool all(T &container, const Pred &func);
+    template<std_container T>
+    constexpr bool contains(const T &container, const typename T::value_type &value);
+    template<std_container T>
+    constexpr bool contains(T &container, const typename T::value_type &value);
+    template<std_container T, typename Func>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::for_each` instead")]]
+#endif
+    constexpr void for_each(const T &container, const Func &func);
+    template<std_container T, typename Func>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::for_each` instead")]]
+#endif
+    constexpr void for_each(T &container, const Func &func);
+    template<std_container T, typename Pred>
+    constexpr typename T::value_type
+    first_or_default(const T &container, const Pred &func,
+                     const typename T::value_type &default_value = typename T::value_type());
+    template<std_container T, typename Pred>
+    constexpr typename T::value_type
+    first_or_default(T &container, const Pred &func,
+                     const typename T::value_type &default_value = typename T::value_type());
+
+    template<template<typename, typename...> class Tt, class Tf>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::to` instead")]]
+#endif
+    constexpr Tt<typename Tf::value_type> to(const Tf &container);
+    template<template<typename, typename...> class Tt, class Tf>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::to` instead")]]
+#endif
+    constexpr Tt<typename Tf::value_type> to(Tf &container);
+    template<template<typename, typename...> class Tt, class Tf>
+    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::to` instead")]]
+#endif
+    to(const Tf &container);
+    template<template<typename, typename...> class Tt, class Tf>
+    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::to` instead")]]
+#endif
+    to(Tf &container);
+    // The allocator given to a materializing function. With c++17 a `std::pmr::memory_resource *` stands for a
+    // `std::pmr::polymorphic_allocator` over it.
+    template<typename Alloc, typename = void>
+    struct allocator_of {
+        using type = Alloc;
+    };
+#if __cplusplus >= 201703L
+    template<typename Resource>
+    struct allocator_of<Resource *, typename std::enable_if<std::is_base_of<std::pmr::memory_resource, Resource>::value>::type> {
+        using type = std::pmr::polymorphic_allocator<char>;
+    };
+#endif
+    template<typename Alloc, typename T>
+    using rebind_allocator_t = typename std::allocator_traits<typename allocator_of<Alloc>::type>::template rebind_alloc<T>;
+
+    template<typename... Ts>
+    struct type_list {};
+    template<template<typename...> class C, typename Alloc, typename Done, typename... Rest>
+    struct replace_last_argument;
+    template<template<typename...> class C, typename Alloc, typename... Done, typename Last>
+    struct replace_last_argument<C, Alloc, type_list<Done...>, Last> {
+        using type = C<Done..., Alloc>;
+    };
+    template<template<typename...> class C, typename Alloc, typename... Done, typename Head, typename Next, typename... Rest>
+    struct replace_last_argument<C, Alloc, type_list<Done...>, Head, Next, Rest...>
+        : replace_last_argument<C, Alloc, type_list<Done..., Head>, Next, Rest...> {};
+
+    // `Container` allocating its `Value`s through `Alloc`, which replaces the last template argument (the allocator of
+    // every standard container)
+    template<typename Container, typename Alloc, typename Value>
+    struct with_allocator;
+    template<template<typename...> class C, typename... Args, typename Alloc, typename Value>
+    struct with_allocator<C<Args...>, Alloc, Value> : replace_last_argument<C, rebind_allocator_t<Alloc, Value>, type_list<>, Args...> {};
+    template<typename Container, typename Alloc, typename Value>
+    using with_allocator_t = typename with_allocator<Container, Alloc, Value>::type;
+
+    // `to<>` allocating through `allocator`, rebound to the element type: e.g. an `arena_allocator` or, with c++17, a
+    // `std::pmr::memory_resource *`
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename Tf::value_type>, Alloc, typename Tf::value_type> to(const Tf &container, const Alloc &allocator);
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename Tf::value_type>, Alloc, typename Tf::value_type> to(Tf &container, const Alloc &allocator);
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>, Alloc,
+                     std::pair<const typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>>
+    to(const Tf &container, const Alloc &allocator);
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>, Alloc,
+                     std::pair<const typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>>
+    to(Tf &container, const Alloc &allocator);
+    template<std::size_t N, std_container T>
+    constexpr std::array<typename T::value_type, N> to_array(T &container);
+    template<std::size_t N, std_container T>
+    constexpr std::array<typename T::value_type, N> to_array(const T &container);
+    template<std_container T, typename Pred>
+    constexpr size_t count_if(const T &container, const Pred &func);
+    template<std_container T, typename Pred>
+    constexpr size_t count_if(T &container, const Pred &func);
+    template<std_container T, typename Compare = std::less<typename T::value_type>>
+    constexpr typename T::value_type max(const T &container, const Compare &cmp = {});
+    template<std_container T, typename Compare = std::less<typename T::value_type>>
+    constexpr typename T::value_type max(T &container, const Compare &cmp = {});
+    template<std_container T, typename Compare = more<typename T::value_type>>
+    constexpr typename T::value_type min(const T &container, const Compare &cmp = {});
+    template<std_container T, typename Compare = more<typename T::value_type>>
+    constexpr typename T::value_type min(T &container, const Compare &cmp = {});
+    // The `k` greatest elements by `cmp` (the `k` smallest with `std::greater`), greatest first, like the front of a
+    // descending sort. Equivalent elements are kept, and ordered, by position in the range. Elements are streamed
+    // through a heap of at most `k` entries: O(n log k) time and O(k) memory, on any range including lazy views.
+    template<std_container T, typename Compare = std::less<typename T::value_type>>
+    std::vector<typename T::value_type> top_k(const T &range, std::size_t k, const Compare &cmp = {});
+    // The element a sort by `cmp` would put at position `n`, as with `std::nth_element`, found without copying or
+    // reordering the range: a bounded heap keeps the `n + 1` first elements of that order, or the last ones when
+    // fewer for a random access range. Throws `std::out_of_range` when the range has no more than `n` elements.
+    template<std_container T, typename Compare = std::less<typename T::value_type>>
+    typename T::value_type nth(const T &range, std::size_t n, const Compare &cmp = {});
+    // `init` combined with every element by `op`, which must be associative but need not be commutative. Random access
+    // ranges are folded by blocks of `parallel_min_chunk` elements, each by four accumulators over its consecutive
+    // quarters so that their dependency chains overlap; the blocks are combined in order. Other ranges are folded
+    // left to right.
+    template<std_container T, typename U = typename T::value_type, typename BinaryOp = std::plus<U>>
+    enable_if_not_execution_policy<T, U> reduce(const T &range, U init = U(), const BinaryOp &op = BinaryOp());
+    // `reduce` of `transform(element)`, without materializing the transformed elements
+    template<std_container T, typename U, typename BinaryOp, typename UnaryOp>
+    U transform_reduce(const T &range, U init, const BinaryOp &op, const UnaryOp &transform);
+    // Running totals including each element: `{a, a op b, a op b op c, ...}`
+    template<std_container T, typename BinaryOp = std::plus<typename T::value_type>>
+    enable_if_not_execution_policy<T, std::vector<typename T::value_type>> inclusive_scan(const T &range, const BinaryOp &op = BinaryOp());
+    // Running totals from `init` excluding each element: `{init, init op a, init op a op b, ...}`
+    template<std_container T, typename U, typename BinaryOp = std::plus<U>>
+    enable_if_not_execution_policy<T, std::vector<U>> exclusive_scan(const T &range, U init, const BinaryOp &op = BinaryOp());
+
+#if __cplusplus < 201703L
+    template<std_container T, class Inserter = typename std::conditional<has_reserve<typename std::decay<T>::type>::value, std::back_insert_iterator<typename std::decay<T>::type>, std::insert_iterator<typename std::decay<T>::type>>::type, typename ...Args>
+    constexpr void emplace_range(T &container, Args &&...args) = delete;
+#else
+    template<std_container T, class Inserter = typename std::conditional<has_reserve<typename std::decay<T>::type>::value, std::back_insert_iterator<typename std::decay<T>::type>, std::insert_iterator<typename std::decay<T>::type>>::type, typename ...Args>
+    constexpr void emplace_range(T &container, Args &&...args);
+#endif
+    template<std_container T, class Inserter = typename std::conditional<has_reserve<typename std::decay<T>::type>::value, std::back_insert_iterator<typename std::decay<T>::type>, std::insert_iterator<typename std::decay<T>::type>>::type, typename Range>
+    constexpr void emplace_range(T &container, Range &&range);
+    template<class T, class Inserter = std::back_insert_iterator<T>>
+    constexpr void emplace_range(T &container, std::initializer_list<typename T::value_type> list);
+
+    // Lvalue ranges are referenced and rvalue ranges are moved into the view, as with `range | filter(pred)`
+    template<std_container T, class Pred>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_ref_view<const T, Pred>>::type filter(const T &container, const Pred &func);
+    template<std_container T, class Pred>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_ref_view<T, Pred>>::type filter(T &container, const Pred &func);
+    template<std_container T, class Pred>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value && !std::is_lvalue_reference<T>::value,
+                                      views::filter_view<typename std::decay<T>::type, Pred>>::type filter(T &&container, const Pred &func);
+    template<typename T, size_t N, typename Pred, class AllocT = std::allocator<T>>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, std::vector<T, rebind_allocator_t<AllocT, T>>>::type
+    filter(const std::array<T, N> &array, const Pred &func, const AllocT &allocator = AllocT());
+    // Range adaptor closure for `range | filter(pred)`
+    template<class Pred>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_adaptor<Pred>>::type filter(const Pred &func);
+
+    template<template<typename...> class T, typename... Args, typename Pred>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::transform` instead")]]
+#endif
+    constexpr views::transform<T<Args...>, Pred> transform(T<Args...> &container, const Pred &pred);
+    template<template<typename...> class T, typename... Args, typename Pred>
+#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
+    [[deprecated("Preffer using `std::ranges::transform` instead")]]
+#endif
+    constexpr views::transform<const T<Args...>, Pred> transform(const T<Args...> &container, const Pred &pred);
+    // Range adaptor closure for `range | transform(func)`
+    template<typename Pred>
+    constexpr views::transform_adaptor<Pred> transform(const Pred &pred);
+
+    // Tag for `filter(selection, ...)`: the predicate is evaluated once, without branches, into a bitmask of a
+    // contiguous range
+    struct selection_t { explicit selection_t() = default; };
+    constexpr selection_t selection {};
+
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_bool_predicate<Pred>::value, views::selection_view<views::ref_view_of<T>, Pred>>::type
+    filter(selection_t, T &range, const Pred &pred);
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_bool_predicate<Pred>::value, views::selection_view<views::ref_view_of<const T>, Pred>>::type
+    filter(selection_t, const T &range, const Pred &pred);
+    // Range adaptor closure for `range | filter(selection, pred)`
+    template<typename Pred>
+    typename std::enable_if<is_bool_predicate<Pred>::value, views::selection_adaptor<Pred>>::type filter(selection_t, const Pred &pred);
+
+    // Consecutive chunks of `n` elements: spans into contiguous ranges, buffered copies of other ones. Lvalue ranges are
+    // referenced and rvalue ranges are moved into the view.
+    template<std_container T>
+    views::chunk_view<views::ref_view_of<T>> chunk(T &range, std::size_t n);
+    template<std_container T>
+    typename std::enable_if<!std::is_lvalue_reference<T>::value, views::chunk_view<T>>::type chunk(T &&range, std::size_t n);
+    // Range adaptor closure for `range | chunk(n)`
+    constexpr views::chunk_adaptor chunk(std::size_t n) noexcept;
+
+    // The first `n` elements, found in O(1) over random access ranges. Other ranges stop on the `n`th element, so
+    // `filter(...) | take(10)` reads the base range no further than its tenth match.
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::take_view<views::ref_view_of<T>>>::type take(T &range, std::size_t n);
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::take_view<T>>::type take(T &&range, std::size_t n);
+    // Range adaptor closure for `range | take(n)`
+    constexpr views::take_adaptor take(std::size_t n) noexcept;
+
+    // The elements after the first `n`, skipped in O(1) over random access ranges
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::drop_view<views::ref_view_of<T>>>::type drop(T &range, std::size_t n);
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::drop_view<T>>::type drop(T &&range, std::size_t n);
+    // Range adaptor closure for `range | drop(n)`
+    constexpr views::drop_adaptor drop(std::size_t n) noexcept;
+
+    // The elements at positions [first, last): `drop(first)` then `take(last - first)`
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::take_view<views::drop_view<views::ref_view_of<T>>>>::type
+    slice(T &range, std::size_t first, std::size_t last);
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::take_view<views::drop_view<T>>>::type
+    slice(T &&range, std::size_t first, std::size_t last);
+    // Range adaptor closure for `range | slice(first, last)`
+    views::slice_adaptor slice(std::size_t first, std::size_t last);
+
+    // Every `n`th element from the first one. Throws `std::invalid_argument` if `n` is zero.
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::stride_view<views::ref_view_of<T>>>::type stride(T &range, std::size_t n);
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::stride_view<T>>::type stride(T &&range, std::size_t n);
+    // Range adaptor closure for `range | stride(n)`
+    constexpr views::stride_adaptor stride(std::size_t n) noexcept;
+
+    // The leading elements satisfying `pred`. The first one failing it ends the view, the rest of the range isn't read.
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::take_while_view<views::ref_view_of<T>, Pred>>::type take_while(T &range, const Pred &pred);
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::take_while_view<T, Pred>>::type
+    take_while(T &&range, const Pred &pred);
+    // Range adaptor closure for `range | take_while(pred)`
+    template<typename Pred>
+    views::take_while_adaptor<Pred> take_while(const Pred &pred);
+
+    // The elements from the first one failing `pred`
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::drop_while_view<views::ref_view_of<T>, Pred>>::type drop_while(T &range, const Pred &pred);
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::drop_while_view<T, Pred>>::type
+    drop_while(T &&range, const Pred &pred);
+    // Range adaptor closure for `range | drop_while(pred)`
+    template<typename Pred>
+    views::drop_while_adaptor<Pred> drop_while(const Pred &pred);
+
+    // Default cache capacity of `transform_cached` and `memoize`: every element
+    constexpr std::size_t cache_all = static_cast<std::size_t>(-1);
+
+    // `transform` computing every element at most once. Results are kept in a side buffer, contiguous for random access
+    // ranges and a chunked deque otherwise, so dereferencing again or traversing again reads them back. Given
+    // `max_cached`, only the first `max_cached` elements are kept and the following ones are computed on every
+    // dereference: the view is then an input range whose elements are returned by value.
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<T>, Pred>>::type
+    transform_cached(T &range, const Pred &func);
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<const T>, Pred>>::type
+    transform_cached(const T &range, const Pred &func);
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<T>, Pred, true>>::type
+    transform_cached(T &range, const Pred &func, std::size_t max_cached);
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<const T>, Pred, true>>::type
+    transform_cached(const T &range, const Pred &func, std::size_t max_cached);
+    // Range adaptor closure for `range | transform_cached(func)`
+    template<typename Pred>
+    views::cached_transform_adaptor<Pred> transform_cached(const Pred &func);
+    template<typename Pred>
+    views::cached_transform_adaptor<Pred, true> transform_cached(const Pred &func, std::size_t max_cached);
+
+    // Caches the elements of a range whose dereference is expensive, e.g. a `transform`, as `transform_cached` does
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::memoized_view<views::ref_view_of<T>>>::type memoize(T &range);
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::memoized_view<T>>::type memoize(T &&range);
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::memoized_view<views::ref_view_of<T>, true>>::type memoize(T &range, std::size_t max_cached);
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::memoized_view<T, true>>::type
+    memoize(T &&range, std::size_t max_cached);
+    // Range adaptor closure for `range | memoize()`
+    constexpr views::memoize_adaptor<> memoize() noexcept;
+    constexpr views::memoize_adaptor<true> memoize(std::size_t max_cached) noexcept;
+
+    // Zero-copy lines of a text buffer, e.g. a `mapped_file` or a `std::string`
+    views::lines_view lines(string_view text) noexcept;
+    // Binary records of type `T` stored back to back in a byte buffer, e.g. a `mapped_file`
+    template<typename T>
+    views::records_view<T> records(string_view bytes) noexcept;
+
+    // Tag for `zip(strict, ...)`, which throws `std::runtime_error` when the ranges differ in size
+    struct strict_t { explicit strict_t() = default; };
+    constexpr strict_t strict {};
+
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<T, U, Rest...> zip(T &first, U &second, Rest &... rest);
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<const T, const U, const Rest...> zip(const T &first, const U &second, const Rest &... rest);
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<T, U, Rest...> zip(strict_t, T &first, U &second, Rest &... rest);
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<const T, const U, const Rest...> zip(strict_t, const T &first, const U &second, const Rest &... rest);
+    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
+    constexpr Ta<std::tuple<T1, T2>, N> zip(Ta<T1, N> &first, Ta<T2, N> &second);
+    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
+    constexpr Ta<std::tuple<T1, T2>, N> zip(const Ta<T1, N> &first, const Ta<T2, N> &second);
+    // Columns produced by `to_soa`: one `std::vector` per element of a tuple or pair
+    template<typename T, typename Alloc = std::allocator<char>>
+    struct soa_columns;
+    template<typename... Ts, typename Alloc>
+    struct soa_columns<std::tuple<Ts...>, Alloc> {
+        using type = std::tuple<std::vector<typename std::decay<Ts>::type, rebind_allocator_t<Alloc, typename std::decay<Ts>::type>>...>;
+    };
+    template<typename T1, typename T2, typename Alloc>
+    struct soa_columns<std::pair<T1, T2>, Alloc> : soa_columns<std::tuple<T1, T2>, Alloc> {};
+    template<typename T, typename Alloc = std::allocator<char>>
+    using soa_columns_t = typename soa_columns<T, Alloc>::type;
+
+    // Appends the I-th element of every tuple (or pair) of `range` to the I-th column
+    template<std_container T, typename... Columns>
+    void unzip(const T &range, Columns &... columns);
+    // Structure-of-arrays copy of a range of tuples: one contiguous vector per tuple element. Random access zips are
+    // copied column by column straight from the zipped ranges.
+    template<std_container T, typename Alloc = std::allocator<char>>
+    soa_columns_t<typename T::value_type, Alloc> to_soa(const T &range, const Alloc &allocator = Alloc());
+    template<typename... Ranges, typename Alloc = std::allocator<char>>
+    soa_columns_t<typename views::zip<Ranges...>::value_type, Alloc> to_soa(const views::zip<Ranges...> &view, const Alloc &allocator = Alloc());
+
+    template<typename T>
+    struct is_join_tag : std::false_type {};
+    template<join_kind Kind>
+    struct is_join_tag<join_tag<Kind>> : std::true_type {};
+
+    // Rows of `build` and `probe` elements with equal keys, `build_key(b) == probe_key(p)`, streamed in probe order.
+    // `build` is indexed in a hash table up front and the sides are never swapped, since that would change the order
+    // of the rows and their element types: the caller must pass the smaller range as `build`. It must outlive the
+    // view, unlike `probe`, which is moved into the view when it is an rvalue and may be unsized.
+    template<std_container B, typename P, typename BuildKey, typename ProbeKey>
+    views::hash_join_view<views::ref_view_of<const B>, views::stored_range_t<P>, BuildKey, ProbeKey, join_kind::inner>
+    hash_join(const B &build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key);
+    template<join_kind Kind, std_container B, typename P, typename BuildKey, typename ProbeKey>
+    views::hash_join_view<views::ref_view_of<const B>, views::stored_range_t<P>, BuildKey, ProbeKey, Kind>
+    hash_join(join_tag<Kind>, const B &build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key);
+    template<std_container B, typename P, typename BuildKey, typename ProbeKey>
+    void hash_join(const B &&build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key) = delete;
+    template<join_kind Kind, std_container B, typename P, typename BuildKey, typename ProbeKey>
+    void hash_join(join_tag<Kind>, const B &&build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key) = delete;
+    // The same rows from two ranges sorted by key, `compare` being the order of both
+    template<typename B, typename P, typename BuildKey, typename ProbeKey, typename Compare = transparent_less>
+    typename std::enable_if<is_range<typename std::remove_reference<B>::type>::value && !is_join_tag<typename std::decay<B>::type>::value,
+        views::merge_join_view<views::stored_range_t<B>, views::stored_range_t<P>, BuildKey, ProbeKey, Compare, join_kind::inner>>::type
+    merge_join(B &&build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key, const Compare &compare = Compare());
+    template<join_kind Kind, typename B, typename P, typename BuildKey, typename ProbeKey, typename Compare = transparent_less>
+    typename std::enable_if<is_range<typename std::remove_reference<B>::type>::value,
+        views::merge_join_view<views::stored_range_t<B>, views::stored_range_t<P>, BuildKey, ProbeKey, Compare, Kind>>::type
+    merge_join(join_tag<Kind>, B &&build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key, const Compare &compare = Compare());
+
+    // Tag for `merge(unique_merge, ...)`: equivalent elements are yielded once, from the first range holding them
+    struct unique_merge_t { explicit unique_merge_t() = default; };
+    constexpr unique_merge_t unique_merge {};
+
+    template<typename R, typename... Rs>
+    using merge_of_t = typename std::enable_if<all_true<is_range<typename std::remove_reference<Rs>::type>::value...>::value,
+        typename std::decay<R>::type>::type;
+
+    // Lazily merges two or more ranges sorted by `<` into one sorted sequence, see `views::merge_view`. Lvalue ranges
+    // are referenced and rvalue ranges (e.g. `filter` views) are moved into the view; all of them must end up stored
+    // as the same type, such as shards of one container type.
+    template<typename R1, typename R2, typename... Rs>
+    merge_of_t<views::merge_view<views::stored_range_t<R1>, transparent_less, false>, R1, R2, Rs...>
+    merge(R1 &&first, R2 &&second, Rs &&... rest);
+    template<typename R1, typename R2, typename... Rs>
+    merge_of_t<views::merge_view<views::stored_range_t<R1>, transparent_less, true>, R1, R2, Rs...>
+    merge(unique_merge_t, R1 &&first, R2 &&second, Rs &&... rest);
+    // Any number of ranges, each sorted by `compare`
+    template<std_container R, typename Compare = transparent_less>
+    typename std::enable_if<!is_range<Compare>::value, views::merge_view<views::ref_view_of<const R>, Compare, false>>::type
+    merge(const std::vector<R> &ranges, const Compare &compare = Compare());
+    template<std_container R, typename Compare = transparent_less>
+    typename std::enable_if<!is_range<Compare>::value, views::merge_view<R, Compare, false>>::type
+    merge(std::vector<R> &&ranges, const Compare &compare = Compare());
+    template<std_container R, typename Compare = transparent_less>
+    views::merge_view<views::ref_view_of<const R>, Compare, true> merge(unique_merge_t, const std::vector<R> &ranges, const Compare &compare = Compare());
+    template<std_container R, typename Compare = transparent_less>
+    views::merge_view<R, Compare, true> merge(unique_merge_t, std::vector<R> &&ranges, const Compare &compare = Compare());
+
+    template<typename T, typename KeyFn>
+    using distinct_key_t = typename std::decay<decltype(std::declval<const KeyFn &>()(*std::begin(std::declval<const T &>())))>::type;
+
+    // The elements of `range` whose key was not seen before, lazily and in order. Keys are remembered in a flat hash
+    // set, reserved from the base size when known (see `views::exact_seen`). Lvalue ranges are referenced, rvalues
+    // moved into the view.
+    template<typename T, typename KeyFn = agg::identity>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value,
+        views::distinct_view<views::stored_range_t<T>, KeyFn, views::exact_seen<distinct_key_t<T, KeyFn>>>>::type
+    distinct(T &&range, const KeyFn &key = KeyFn());
+    // Compares every element with the previous one only, like `std::unique`: no memory and a forward view
+    template<typename T, typename KeyFn = agg::identity>
+    views::adjacent_distinct_view<views::stored_range_t<T>, KeyFn> distinct(sorted_input_t, T &&range, const KeyFn &key = KeyFn());
+    template<typename T, typename KeyFn = agg::identity>
+    views::distinct_view<views::stored_range_t<T>, KeyFn, views::bloom_seen<distinct_key_t<T, KeyFn>>>
+    distinct(approximate_t mode, T &&range, const KeyFn &key = KeyFn());
+
+    // The elements of two or more ranges, one range after the other, without copies (see `views::concat_view`). Lvalue
+    // ranges are referenced and rvalue ranges are moved into the view.
+    template<typename R1, typename R2, typename... Rs>
+    typename std::enable_if<all_true<is_range<typename std::remove_reference<R1>::type>::value, is_range<typename std::remove_reference<R2>::type>::value,
+                                     is_range<typename std::remove_reference<Rs>::type>::value...>::value,
+        views::concat_view<views::stored_range_t<R1>, views::stored_range_t<R2>, views::stored_range_t<Rs>...>>::type
+    concat(R1 &&first, R2 &&second, Rs &&... rest);
+    // The elements of each range of a range of ranges in turn, e.g. of a `std::vector<std::vector<T>>`, without copies
+    // (see `views::flatten_view`). An lvalue range is referenced, an rvalue moved into the view.
+    template<typename T>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::flatten_view<views::stored_range_t<T>>>::type
+    flatten(T &&range);
+
+    // Every run of `n` consecutive elements, advancing by one: `size - n + 1` windows, none over a shorter range. The
+    // windows are ranges of base iterators (see `views::window`), over any forward range. Throws
+    // `std::invalid_argument` if `n` is zero.
+    template<typename T>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::sliding_view<views::stored_range_t<T>>>::type
+    sliding(T &&range, std::size_t n);
+    // The aggregate of every window of `sliding(range, n)`, updated as the window moves rather than recomputed: O(1)
+    // amortized per element for `agg::count`, `agg::sum` and `agg::mean`, which subtract the element leaving, and for
+    // `agg::min` and `agg::max`, which keep a monotonic deque of candidates (see `views::window_state`). Each element
+    // is read once, and `n` projected elements are buffered.
+    template<typename T, typename Aggregator>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::sliding_aggregate_view<views::stored_range_t<T>, Aggregator>>::type
+    sliding(T &&range, std::size_t n, const Aggregator &aggregator);
+    // Range adaptor closures for `range | sliding(n)` and `range | sliding(n, aggregator)`
+    constexpr views::sliding_adaptor sliding(std::size_t n) noexcept;
+    template<typename Aggregator>
+    views::window_aggregate_adaptor<views::sliding_aggregate_view, Aggregator> sliding(std::size_t n, const Aggregator &aggregator);
+
+    // Consecutive windows of `n` elements that don't overlap, the last one possibly shorter. Unlike `chunk`, windows
+    // are ranges of base iterators, the elements of non-contiguous ranges are not copied. Throws `std::invalid_argument`
+    // if `n` is zero.
+    template<typename T>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::tumbling_view<views::stored_range_t<T>>>::type
+    tumbling(T &&range, std::size_t n);
+    // The aggregate of every window of `tumbling(range, n)`, by any aggregator of `aggregate_by`
+    template<typename T, typename Aggregator>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::tumbling_aggregate_view<views::stored_range_t<T>, Aggregator>>::type
+    tumbling(T &&range, std::size_t n, const Aggregator &aggregator);
+    // Range adaptor closures for `range | tumbling(n)` and `range | tumbling(n, aggregator)`
+    constexpr views::tumbling_adaptor tumbling(std::size_t n) noexcept;
+    template<typename Aggregator>
+    views::window_aggregate_adaptor<views::tumbling_aggregate_view, Aggregator> tumbling(std::size_t n, const Aggregator &aggregator);
+
+#if RANGED_HAS_MMAP
+    // Default memory budget of `external_sort`, in bytes
+    constexpr std::size_t external_sort_budget = std::size_t {256} << 20;
+
+    // Sorts a range of trivially copyable elements that may not fit in memory. Runs of `memory_budget` bytes are
+    // sorted in memory and appended, as raw bytes, to an unlinked temporary file in `temp_dir` (see `temporary_file`);
+    // the returned view merges them lazily (see `merge`). An input that fits the budget is never written. Equivalent
+    // elements come in no particular order. Throws `std::system_error` when the file cannot be written or mapped.
+    template<std_container T, typename Compare = std::less<typename T::value_type>>
+    views::external_sort_view<typename T::value_type, Compare>
+    external_sort(const T &range, const Compare &cmp = {}, std::size_t memory_budget = external_sort_budget, const std::string &temp_dir = std::string());
+    // Every run is split into chunks sorted by different threads, and spilled as that many shorter runs
+    template<typename Policy, std_container T, typename Compare = std::less<typename T::value_type>>
+    enable_if_execution_policy<Policy, views::external_sort_view<typename T::value_type, Compare>>
+    external_sort(const Policy &policy, const T &range, const Compare &cmp = {}, std::size_t memory_budget = external_sort_budget,
+                  const std::string &temp_dir = std::string());
+#endif
+
+    // Runs `transform` and `filter` stages over `range` on threads of their own, so a slow stage only slows the stages
+    // after it instead of the whole chain, and can be given several replicas:
+    //     auto rows = ranged::pipeline(lines).transform(parse, 4).filter(valid).to<std::vector>();
+    // Rvalue ranges are moved into the pipeline; lvalues are referenced and must not change until it finished.
+    template<typename T>
+    async_pipeline<pipeline_source<views::stored_range_t<T>>> pipeline(T &&range, const pipeline_options &options = pipeline_options());
+
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, bool> any(const Policy &policy, const T &container, const Pred &func);
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, bool> all(const Policy &policy, const T &container, const Pred &func);
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, size_t> count_if(const Policy &policy, const T &container, const Pred &func);
+    template<typename Policy, std_container T, typename Func>
+    enable_if_execution_policy<Policy, void> for_each(const Policy &policy, T &container, const Func &func);
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, typename T::value_type>
+    first_or_default(const Policy &policy, const T &container, const Pred &func,
+                     const typename T::value_type &default_value = typename T::value_type());
+    template<typename Policy, std_container T, typename Compare = std::less<typename T::value_type>>
+    enable_if_execution_policy<Policy, typename T::value_type> max(const Policy &policy, const T &container, const Compare &cmp = {});
+    template<typename Policy, std_container T, typename Compare = more<typename T::value_type>>
+    enable_if_execution_policy<Policy, typename T::value_type> min(const Policy &policy, const T &container, const Compare &cmp = {});
+    // Random access ranges fill one heap per chunk, then the heaps are merged with the same tie rule: the result does
+    // not depend on the number of threads
+    template<typename Policy, std_container T, typename Compare = std::less<typename T::value_type>>
+    enable_if_execution_policy<Policy, std::vector<typename T::value_type>> top_k(const Policy &policy, const T &range, std::size_t k, const Compare &cmp = {});
+    template<typename Policy, std_container T, typename Compare = std::less<typename T::value_type>>
+    enable_if_execution_policy<Policy, typename T::value_type> nth(const Policy &policy, const T &range, std::size_t n, const Compare &cmp = {});
+    // Chunks are folded in parallel and their results combined in order, so `op` still need not be commutative.
+    // Floating point results depend on the number of chunks, hence on the concurrency, unless the policy is
+    // `execution::deterministic`: then they are bit for bit those of the sequential version.
+    template<typename Policy, std_container T, typename U = typename T::value_type, typename BinaryOp = std::plus<U>>
+    enable_if_execution_policy<Policy, U> reduce(const Policy &policy, const T &range, U init = U(), const BinaryOp &op = BinaryOp());
+    template<typename Policy, std_container T, typename U, typename BinaryOp, typename UnaryOp>
+    enable_if_execution_policy<Policy, U> transform_reduce(const Policy &policy, const T &range, U init, const BinaryOp &op, const UnaryOp &transform);
+    // Two passes over chunks: their totals, then their scans continuing from the running total of the chunks before.
+    // With `execution::deterministic`, the chunks and so the results do not depend on the concurrency.
+    template<typename Policy, std_container T, typename BinaryOp = std::plus<typename T::value_type>>
+    enable_if_execution_policy<Policy, std::vector<typename T::value_type>> inclusive_scan(const Policy &policy, const T &range, const BinaryOp &op = BinaryOp());
+    template<typename Policy, std_container T, typename U, typename BinaryOp = std::plus<U>>
+    enable_if_execution_policy<Policy, std::vector<U>> exclusive_scan(const Policy &policy, const T &range, U init, const BinaryOp &op = BinaryOp());
+
+    template<typename Agg, typename Reference>
+    using aggregator_state_t = typename std::decay<decltype(std::declval<const Agg &>().start(std::declval<Reference>()))>::type;
+    template<typename Agg, typename Reference>
+    using aggregator_result_t =
+        typename std::decay<decltype(std::declval<const Agg &>().finish(std::declval<aggregator_state_t<Agg, Reference>>()))>::type;
+
+    template<typename... Results>
+    struct aggregate_value {
+        using type = std::tuple<Results...>;
+    };
+    template<typename Result>
+    struct aggregate_value<Result> {
+        using type = Result;
+    };
+
+    // Types involved in `aggregate_by(range, key, aggregators...)`
+    template<typename T, typename KeyFn, typename... Aggs>
+    struct aggregation {
+        using reference = decltype(*std::begin(std::declval<const T &>()));
+        using key_type = typename std::decay<decltype(std::declval<const KeyFn &>()(std::declval<reference>()))>::type;
+        using state_type = std::tuple<aggregator_state_t<Aggs, reference>...>;
+        using state_map = flat_hash_map<key_type, state_type>;
+        // One aggregator maps keys to its result, several to a tuple of results
+        using result_map = flat_hash_map<key_type, typename aggregate_value<aggregator_result_t<Aggs, reference>...>::type>;
+    };
+    template<bool Enable, typename Aggregation>
+    struct enable_if_aggregation {};
+    template<typename Aggregation>
+    struct enable_if_aggregation<true, Aggregation> {
+        using type = typename Aggregation::result_map;
+    };
+    template<typename T, typename KeyFn, typename... Aggs>
+    using aggregate_result_t = typename enable_if_aggregation<!execution::is_execution_policy<T>::value, aggregation<T, KeyFn, Aggs...>>::type;
+    template<typename Policy, typename T, typename KeyFn, typename... Aggs>
+    using parallel_aggregate_result_t =
+        typename enable_if_aggregation<execution::is_execution_policy<typename std::decay<Policy>::type>::value, aggregation<T, KeyFn, Aggs...>>::type;
+
+    // Groups the elements by `key(element)` and folds every group with the aggregators (see `agg`) in a single pass.
+    // Groups are stored in a `flat_hash_map`, in order of first appearance; keys need a `ranged::hash`.
+    template<std_container T, typename KeyFn, typename Agg, typename... Aggs>
+    aggregate_result_t<T, KeyFn, Agg, Aggs...> aggregate_by(const T &range, const KeyFn &key, const Agg &aggregator, const Aggs &... aggregators);
+    // The elements of each group, in range order
+    template<std_container T, typename KeyFn>
+    aggregate_result_t<T, KeyFn, agg::collect_aggregator> group_by(const T &range, const KeyFn &key);
+    // Random access ranges are split into one chunk per thread. Each chunk is aggregated into its own tables, one per
+    // partition of the key space, and then every partition is merged by its own thread, in chunk order: groups keep
+    // their elements in range order, but the groups themselves are in no particular order.
+    template<typename Policy, std_container T, typename KeyFn, typename Agg, typename... Aggs>
+    parallel_aggregate_result_t<Policy, T, KeyFn, Agg, Aggs...>
+    aggregate_by(const Policy &policy, const T &range, const KeyFn &key, const Agg &aggregator, const Aggs &... aggregators);
+    template<typename Policy, std_container T, typename KeyFn>
+    parallel_aggregate_result_t<Policy, T, KeyFn, agg::collect_aggregator> group_by(const Policy &policy, const T &range, const KeyFn &key);
+
+
+#ifdef RANGED_IMPLEMENTATION
+
+
+    template<std_container T, typename Pred>
+    constexpr bool any(const T &container, const Pred &func) {
+#if __cplusplus >= 202002L
+        return std::ranges::any_of(container, func);
+#else
+        for (const auto &element: container) {
+            if (func(element))
+                return true;
+        }
+
+        return false;
+#endif
+    }
+    template<std_container T, typename Pred>
+    constexpr bool any(T &container, const Pred &func) {
+#if __cplusplus >= 202002L
+        return std::ranges::any_of(container, func);
+#else
+        for (const auto &element: container) {
+            if (func(element))
+                return true;
+        }
+
+        return false;
+#endif
+    }
+
+    template<std_container T, typename Pred>
+    constexpr bool all(const T &container, const Pred &func) {
+#if __cplusplus >= 202002L
+        return std::ranges::all_of(container, func);
+#else
+        for (const auto &element: container) {
+            if (!func(element))
+                return false;
+        }
+
+        return true;
+#endif
+    }
+    template<std_container T, typename Pred>
+    constexpr bool all(T &container, const Pred &func) {
+#if __cplusplus >= 202002L
+        return std::ranges::all_of(container, func);
+#else
+        for (const auto &element: container) {
+            if (!func(element))
+                return false;
+        }
+
+        return true;
+#endif
+    }
+    template<typename T>
+    constexpr bool contains(const T &container, const typename T::value_type &value, std::false_type) {
+#if __cplusplus >= 202002L
+        return std::ranges::find(container, value) != container.end();
+#else
+        return std::find(container.begin(), container.end(), value) != container.end();
+#endif
+    }
+#if RANGED_SIMD
+    template<typename T>
+    bool contains(const T &container, const typename T::value_type &value, std::true_type) {
+        return simd::contains(container.data(), container.size(), value);
+    }
+#endif
+    template<typename T>
+    bool contains(const T &container, const typename T::value_type &value, segmented_scan) {
+        for (const auto segment: container.segments()) {
+            if (contains(segment, value))
+                return true;
+        }
+
+        return false;
+    }
+    template<std_container T>
+    constexpr bool contains(const T &container, const typename T::value_type &value) {
+        return contains(container, value, segmented_or<T, is_simd_range<const T>> {});
+    }
+    template<std_container T>
+    constexpr bool contains(T &container, const typename T::value_type &value) {
+        return contains(container, value, segmented_or<T, is_simd_range<const T>> {});
+    }
+    template<std_container T, typename Func>
+    constexpr void for_each(const T &container, const Func &func) {
+#if __cplusplus >= 202002L
+        std::ranges::for_each(container, func);
+#else
+        for (const auto &element: container) {
+            func(element);
+        }
+#endif
+    }
+    template<std_container T, typename Func>
+    constexpr void for_each(T &container, const Func &func) {
+#if __cplusplus >= 202002L
+        std::ranges::for_each(container, func);
+#else
+        for (const auto &element: container) {
+            func(element);
+        }
+#endif
+    }
+    template<std_container T, typename Pred>
+    constexpr typename T::value_type first_or_default(const T &container, const Pred &func, const typename T::value_type &default_value) {
+        for (const auto &item: container) {
+            if (func(item))
+                return item;
+        }
+
+        return default_value;
+    }
+    template<std_container T, typename Pred>
+    constexpr typename T::value_type first_or_default(T &container, const Pred &func,
+                                                      const typename T::value_type &default_value) {
+        for (const auto &item: container) {
+            if (func(item))
+                return item;
+        }
+
+        return default_value;
+    }
+    // How `to<>` builds its result: the iterator-pair constructor already sizes itself exactly for random access
+    // sources, otherwise a container with `reserve()` is reserved up front from `size()` (or `size_hint()`, if enabled).
+    template<typename R>
+    std::size_t range_size(const R &range, std::true_type) { return range.size(); }
+    template<typename R>
+    std::size_t range_size(const R &range, std::false_type) {
+        return static_cast<std::size_t>(std::distance(std::begin(range), std::end(range)));
+    }
+
+    enum class materialize_strategy { construct, reserve_size, reserve_hint };
+
+    template<typename Result, typename Source>
+    using materialize_strategy_t = std::integral_constant<materialize_strategy,
+        !has_reserve<Result>::value || is_random_access_iterator<decltype(std::begin(std::declval<Source &>()))>::value
+            ? materialize_strategy::construct
+            : sized<Source>::value
+                ? materialize_strategy::reserve_size
+                : (RANGED_RESERVE_SIZE_HINT && has_size_hint<Source>::value)
+                    ? materialize_strategy::reserve_hint
+                    : materialize_strategy::construct>;
+
+    template<typename Result, typename Source>
+    Result materialize(Source &source, std::integral_constant<materialize_strategy, materialize_strategy::construct>) {
+        return Result(std::begin(source), std::end(source));
+    }
+    template<typename Result, typename Source>
+    void materialize_into(Result &result, Source &source, std::true_type) {
+        std::copy(std::begin(source), std::end(source), std::back_inserter(result));
+    }
+    template<typename Result, typename Source>
+    void materialize_into(Result &result, Source &source, std::false_type) {
+        std::copy(std::begin(source), std::end(source), std::inserter(result, result.end()));
+    }
+    template<typename Result, typename Source>
+    Result materialize(Source &source, std::integral_constant<materialize_strategy, materialize_strategy::reserve_size>) {
+        Result result;
+        result.reserve(source.size());
+        materialize_into(result, source, has_emplace_back<Result> {});
+        return result;
+    }
+    template<typename Result, typename Source>
+    Result materialize(Source &source, std::integral_constant<materialize_strategy, materialize_strategy::reserve_hint>) {
+        Result result;
+        result.reserve(source.size_hint());
+        materialize_into(result, source, has_emplace_back<Result> {});
+        return result;
+    }
+
+    // Reservation made by the allocator-aware `to<>`, which cannot use the range constructors: they take the allocator
+    // in different positions for different containers
+    template<typename Result, typename Source>
+    using reserve_strategy_t = std::integral_constant<materialize_strategy,
+        has_reserve<Result>::value && (sized<Source>::value || is_random_access_iterator<decltype(std::begin(std::declval<Source &>()))>::value)
+            ? materialize_strategy::reserve_size
+            : (has_reserve<Result>::value && RANGED_RESERVE_SIZE_HINT && has_size_hint<Source>::value)
+                ? materialize_strategy::reserve_hint
+                : materialize_strategy::construct>;
+
+    template<typename Result, typename Source>
+    void reserve_for(Result &, Source &, std::integral_constant<materialize_strategy, materialize_strategy::construct>) {}
+    template<typename Result, typename Source>
+    void reserve_for(Result &result, Source &source, std::integral_constant<materialize_strategy, materialize_strategy::reserve_size>) {
+        result.reserve(range_size(source, sized<Source> {}));
+    }
+    template<typename Result, typename Source>
+    void reserve_for(Result &result, Source &source, std::integral_constant<materialize_strategy, materialize_strategy::reserve_hint>) {
+        result.reserve(source.size_hint());
+    }
+    template<typename Result, typename Source, typename Alloc>
+    Result materialize(Source &source, const Alloc &allocator) {
+        Result result {typename Result::allocator_type(allocator)};
+        reserve_for(result, source, reserve_strategy_t<Result, Source> {});
+        materialize_into(result, source, has_emplace_back<Result> {});
+        return result;
+    }
+
+    template<template<typename, typename...> class Tt, class Tf>
+    constexpr Tt<typename Tf::value_type> to(const Tf &container) {
+        using result_type = Tt<typename Tf::value_type>;
+        return materialize<result_type>(container, materialize_strategy_t<result_type, const Tf> {});
+    }
+    template<template<typename, typename...> class Tt, class Tf>
+    constexpr Tt<typename Tf::value_type> to(Tf &container) {
+        using result_type = Tt<typename Tf::value_type>;
+        return materialize<result_type>(container, materialize_strategy_t<result_type, Tf> {});
+    }
+    template<template<typename, typename...> class Tt, class Tf>
+    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
+    to(const Tf &container) {
+        using result_type = Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>;
+        return materialize<result_type>(container, materialize_strategy_t<result_type, const Tf> {});
+    }
+    template<template<typename, typename...> class Tt, class Tf>
+    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
+    to(Tf &container) {
+        using result_type = Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>;
+        return materialize<result_type>(container, materialize_strategy_t<result_type, Tf> {});
+    }
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename Tf::value_type>, Alloc, typename Tf::value_type> to(const Tf &container, const Alloc &allocator) {
+        return materialize<with_allocator_t<Tt<typename Tf::value_type>, Alloc, typename Tf::value_type>>(container, allocator);
+    }
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename Tf::value_type>, Alloc, typename Tf::value_type> to(Tf &container, const Alloc &allocator) {
+        return materialize<with_allocator_t<Tt<typename Tf::value_type>, Alloc, typename Tf::value_type>>(container, allocator);
+    }
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>, Alloc,
+                     std::pair<const typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>>
+    to(const Tf &container, const Alloc &allocator) {
+        using key_type = typename std::decay<typename Tf::value_type::first_type>::type;
+        using mapped_type = typename Tf::value_type::second_type;
+        using result_type = with_allocator_t<Tt<key_type, mapped_type>, Alloc, std::pair<const key_type, mapped_type>>;
+        return materialize<result_type>(container, allocator);
+    }
+    template<template<typename, typename...> class Tt, class Tf, class Alloc>
+    with_allocator_t<Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>, Alloc,
+                     std::pair<const typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>>
+    to(Tf &container, const Alloc &allocator) {
+        using key_type = typename std::decay<typename Tf::value_type::first_type>::type;
+        using mapped_type = typename Tf::value_type::second_type;
+        using result_type = with_allocator_t<Tt<key_type, mapped_type>, Alloc, std::pair<const key_type, mapped_type>>;
+        return materialize<result_type>(container, allocator);
+    }
+    template<std::size_t N, std_container T>
+    constexpr std::array<typename T::value_type, N> to_array(T &container) {
+        std::array<typename T::value_type, N> result{};
+        auto it = std::begin(container);
+        const auto end = std::end(container);
+        for (size_t i{0}; i < N && it != end; ++i, ++it) {
+            result[i] = *it;
+        }
+
+        return result;
+    }
+    template<std::size_t N, std_container T>
+    constexpr std::array<typename T::value_type, N> to_array(const T &container) {
+        std::array<typename T::value_type, N> result{};
+        auto it = std::begin(container);
+        const auto end = std::end(container);
+        for (size_t i{0}; i < N && it != end; ++i, ++it) {
+            result[i] = *it;
+        }
+
+        return result;
+    }
+    template<typename T, typename Pred>
+    constexpr size_t count_if(const T &container, const Pred &func, std::false_type) {
+        size_t result{};
+        for (const auto &item: container) {
+            if (func(item))
+                ++result;
+        }
+
+        return result;
+    }
+#if RANGED_SIMD
+    template<typename T, typename V, typename Compare>
+    size_t count_if(const T &container, const threshold<V, Compare> &func, std::true_type) {
+        return simd::count<simd::comparison_of<Compare>::value>(container.data(), container.size(), func.value);
+    }
+#endif
+
+    template<typename T, typename Pred>
+    size_t count_if(const T &container, const Pred &func, segmented_scan) {
+        size_t result{};
+        for (const auto segment: container.segments()) {
+            result += count_if(segment, func);
+        }
+
+        return result;
+    }
+
+    template<typename T, typename Pred>
+    struct is_simd_count : std::false_type {};
+    template<typename T, typename Compare>
+    struct is_simd_count<T, threshold<typename T::value_type, Compare>> : is_simd_range<const T> {};
+
+    template<std_container T, typename Pred>
+    constexpr size_t count_if(const T &container, const Pred &func) {
+        return count_if(container, func, segmented_or<T, is_simd_count<T, Pred>> {});
+    }
+    template<std_container T, typename Pred>
+    constexpr size_t count_if(T &container, const Pred &func) {
+        return count_if(container, func, segmented_or<T, is_simd_count<T, Pred>> {});
+    }
+    template<std_container T, class Pred>
+    constexpr
+            typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_ref_view<const T, Pred>>::type
+            filter(const T &container, const Pred &func) {
+        return views::filter_ref_view<const T, Pred>{container, func};
+    }
+    template<std_container T, class Pred>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_ref_view<T, Pred>>::type
+    filter(T &container, const Pred &func) {
+        return views::filter_ref_view<T, Pred>{container, func};
+    }
+    template<std_container T, class Pred>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value && !std::is_lvalue_reference<T>::value,
+                                      views::filter_view<typename std::decay<T>::type, Pred>>::type
+    filter(T &&container, const Pred &func) {
+        return views::filter_view<typename std::decay<T>::type, Pred>{std::forward<T>(container), func};
+    }
+    template<typename T, size_t N, typename Pred, class AllocT>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, std::vector<T, rebind_allocator_t<AllocT, T>>>::type
+    filter(const std::array<T, N> &array, const Pred &func, const AllocT &allocator) {
+        std::vector<T, rebind_allocator_t<AllocT, T>> result {rebind_allocator_t<AllocT, T>(allocator)};
+        result.reserve(N);
+        for (const T &item: array) {
+            if (func(item))
+                result.push_back(item);
+        }
+        return result;
+    }
+    template<class Pred>
+    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_adaptor<Pred>>::type filter(const Pred &func) {
+        return views::filter_adaptor<Pred>{func};
+    }
+    template<template<typename...> class T, typename... Args, typename Pred>
+    constexpr views::transform<T<Args...>, Pred> transform(T<Args...> &container, const Pred &pred) {
+        return views::transform<T<Args...>, Pred>{container, pred};
+    }
+    template<template<typename...> class T, typename... Args, typename Pred>
+    constexpr views::transform<const T<Args...>, Pred> transform(const T<Args...> &container, const Pred &pred) {
+        return views::transform<const T<Args...>, Pred>{container, pred};
+    }
+    template<typename Pred>
+    constexpr views::transform_adaptor<Pred> transform(const Pred &pred) {
+        return views::transform_adaptor<Pred>{pred};
+    }
+
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_bool_predicate<Pred>::value, views::selection_view<views::ref_view_of<T>, Pred>>::type
+    filter(selection_t, T &range, const Pred &pred) {
+        return views::selection_view<views::ref_view_of<T>, Pred>{views::as_ref_view(range), pred};
+    }
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_bool_predicate<Pred>::value, views::selection_view<views::ref_view_of<const T>, Pred>>::type
+    filter(selection_t, const T &range, const Pred &pred) {
+        return views::selection_view<views::ref_view_of<const T>, Pred>{views::as_ref_view(range), pred};
+    }
+    template<typename Pred>
+    typename std::enable_if<is_bool_predicate<Pred>::value, views::selection_adaptor<Pred>>::type filter(selection_t, const Pred &pred) {
+        return views::selection_adaptor<Pred>{pred};
+    }
+
+    template<std_container T>
+    views::chunk_view<views::ref_view_of<T>> chunk(T &range, std::size_t n) {
+        return views::chunk_view<views::ref_view_of<T>>{views::as_ref_view(range), n};
+    }
+    template<std_container T>
+    typename std::enable_if<!std::is_lvalue_reference<T>::value, views::chunk_view<T>>::type chunk(T &&range, std::size_t n) {
+        return views::chunk_view<T>{std::move(range), n};
+    }
+    constexpr views::chunk_adaptor chunk(std::size_t n) noexcept {
+        return views::chunk_adaptor{n};
+    }
+
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::take_view<views::ref_view_of<T>>>::type take(T &range, std::size_t n) {
+        return views::take_view<views::ref_view_of<T>>{views::as_ref_view(range), n};
+    }
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::take_view<T>>::type take(T &&range, std::size_t n) {
+        return views::take_view<T>{std::move(range), n};
+    }
+    constexpr views::take_adaptor take(std::size_t n) noexcept {
+        return views::take_adaptor{n};
+    }
+
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::drop_view<views::ref_view_of<T>>>::type drop(T &range, std::size_t n) {
+        return views::drop_view<views::ref_view_of<T>>{views::as_ref_view(range), n};
+    }
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::drop_view<T>>::type drop(T &&range, std::size_t n) {
+        return views::drop_view<T>{std::move(range), n};
+    }
+    constexpr views::drop_adaptor drop(std::size_t n) noexcept {
+        return views::drop_adaptor{n};
+    }
+
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::take_view<views::drop_view<views::ref_view_of<T>>>>::type
+    slice(T &range, std::size_t first, std::size_t last) {
+        return views::take_view<views::drop_view<views::ref_view_of<T>>>{drop(range, first), last > first ? last - first : 0};
+    }
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::take_view<views::drop_view<T>>>::type
+    slice(T &&range, std::size_t first, std::size_t last) {
+        return views::take_view<views::drop_view<T>>{drop(std::move(range), first), last > first ? last - first : 0};
+    }
+    inline views::slice_adaptor slice(std::size_t first, std::size_t last) {
+        return views::slice_adaptor{drop(first), take(last > first ? last - first : 0)};
+    }
+
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::stride_view<views::ref_view_of<T>>>::type stride(T &range, std::size_t n) {
+        return views::stride_view<views::ref_view_of<T>>{views::as_ref_view(range), n};
+    }
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::stride_view<T>>::type stride(T &&range, std::size_t n) {
+        return views::stride_view<T>{std::move(range), n};
+    }
+    constexpr views::stride_adaptor stride(std::size_t n) noexcept {
+        return views::stride_adaptor{n};
+    }
+
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::take_while_view<views::ref_view_of<T>, Pred>>::type take_while(T &range, const Pred &pred) {
+        return views::take_while_view<views::ref_view_of<T>, Pred>{views::as_ref_view(range), pred};
+    }
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::take_while_view<T, Pred>>::type
+    take_while(T &&range, const Pred &pred) {
+        return views::take_while_view<T, Pred>{std::move(range), pred};
+    }
+    template<typename Pred>
+    views::take_while_adaptor<Pred> take_while(const Pred &pred) {
+        return views::take_while_adaptor<Pred>{pred};
+    }
+
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::drop_while_view<views::ref_view_of<T>, Pred>>::type drop_while(T &range, const Pred &pred) {
+        return views::drop_while_view<views::ref_view_of<T>, Pred>{views::as_ref_view(range), pred};
+    }
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::drop_while_view<T, Pred>>::type
+    drop_while(T &&range, const Pred &pred) {
+        return views::drop_while_view<T, Pred>{std::move(range), pred};
+    }
+    template<typename Pred>
+    views::drop_while_adaptor<Pred> drop_while(const Pred &pred) {
+        return views::drop_while_adaptor<Pred>{pred};
+    }
+
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<T>, Pred>>::type
+    transform_cached(T &range, const Pred &func) {
+        return views::cached_transform_view<views::ref_view_of<T>, Pred>{views::as_ref_view(range), func, cache_all};
+    }
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<const T>, Pred>>::type
+    transform_cached(const T &range, const Pred &func) {
+        return views::cached_transform_view<views::ref_view_of<const T>, Pred>{views::as_ref_view(range), func, cache_all};
+    }
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<T>, Pred, true>>::type
+    transform_cached(T &range, const Pred &func, std::size_t max_cached) {
+        return views::cached_transform_view<views::ref_view_of<T>, Pred, true>{views::as_ref_view(range), func, max_cached};
+    }
+    template<std_container T, typename Pred>
+    typename std::enable_if<is_range<T>::value, views::cached_transform_view<views::ref_view_of<const T>, Pred, true>>::type
+    transform_cached(const T &range, const Pred &func, std::size_t max_cached) {
+        return views::cached_transform_view<views::ref_view_of<const T>, Pred, true>{views::as_ref_view(range), func, max_cached};
+    }
+    template<typename Pred>
+    views::cached_transform_adaptor<Pred> transform_cached(const Pred &func) {
+        return views::cached_transform_adaptor<Pred>{func, cache_all};
+    }
+    template<typename Pred>
+    views::cached_transform_adaptor<Pred, true> transform_cached(const Pred &func, std::size_t max_cached) {
+        return views::cached_transform_adaptor<Pred, true>{func, max_cached};
+    }
+
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::memoized_view<views::ref_view_of<T>>>::type memoize(T &range) {
+        return views::memoized_view<views::ref_view_of<T>>{views::as_ref_view(range), {}, cache_all};
+    }
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::memoized_view<T>>::type memoize(T &&range) {
+        return views::memoized_view<T>{std::move(range), {}, cache_all};
+    }
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value, views::memoized_view<views::ref_view_of<T>, true>>::type memoize(T &range, std::size_t max_cached) {
+        return views::memoized_view<views::ref_view_of<T>, true>{views::as_ref_view(range), {}, max_cached};
+    }
+    template<std_container T>
+    typename std::enable_if<is_range<T>::value && !std::is_lvalue_reference<T>::value, views::memoized_view<T, true>>::type
+    memoize(T &&range, std::size_t max_cached) {
+        return views::memoized_view<T, true>{std::move(range), {}, max_cached};
+    }
+    constexpr views::memoize_adaptor<> memoize() noexcept {
+        return views::memoize_adaptor<>{cache_all};
+    }
+    constexpr views::memoize_adaptor<true> memoize(std::size_t max_cached) noexcept {
+        return views::memoize_adaptor<true>{max_cached};
+    }
+
+    inline views::lines_view lines(string_view text) noexcept {
+        return views::lines_view{text};
+    }
+    template<typename T>
+    views::records_view<T> records(string_view bytes) noexcept {
+        return views::records_view<T>{bytes};
+    }
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<T, U, Rest...> zip(T &first, U &second, Rest &... rest) {
+        return views::zip<T, U, Rest...>{first, second, rest...};
+    }
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<const T, const U, const Rest...> zip(const T &first, const U &second, const Rest &... rest) {
+        return views::zip<const T, const U, const Rest...>{first, second, rest...};
+    }
+    template<typename T, typename U, typename... Rest>
+    void check_same_size(const T &first, const U &second, const Rest &... rest) {
+        const std::size_t size = range_size(first, sized<const T> {});
+        for (const std::size_t other: {range_size(second, sized<const U> {}), range_size(rest, sized<const Rest> {})...}) {
+            if (other != size)
+                throw std::runtime_error("Containers cannot have different size.");
+        }
+    }
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<T, U, Rest...> zip(strict_t, T &first, U &second, Rest &... rest) {
+        check_same_size(first, second, rest...);
+        return views::zip<T, U, Rest...>{first, second, rest...};
+    }
+    template<std_container T, std_container U, std_container... Rest>
+    views::zip<const T, const U, const Rest...> zip(strict_t, const T &first, const U &second, const Rest &... rest) {
+        check_same_size(first, second, rest...);
+        return views::zip<const T, const U, const Rest...>{first, second, rest...};
+    }
+    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
+    constexpr Ta<std::tuple<T1, T2>, N> zip(Ta<T1, N> &first, Ta<T2, N> &second) {
+        Ta<std::tuple<T1, T2>, N> result{};
+        for (std::size_t i{0}; i < N; ++i) {
+            result[i] = std::make_tuple(first[i], second[i]);
+        }
+
+        return result;
+    }
+    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
+    constexpr Ta<std::tuple<T1, T2>, N> zip(const Ta<T1, N> &first, const Ta<T2, N> &second) {
+        Ta<std::tuple<T1, T2>, N> result{};
+        for (std::size_t i{0}; i < N; ++i) {
+            result[i] = std::make_pair(first[i], second[i]);
+        }
+
+        return result;
+    }
+    template<typename Row, typename... Columns, std::size_t... Is>
+    void unzip_row(const Row &row, index_sequence<Is...>, Columns &... columns) {
+        using swallow = int[];
+        (void) swallow {0, (columns.emplace_back(std::get<Is>(row)), 0)...};
+    }
+    template<std_container T, typename... Columns>
+    void unzip(const T &range, Columns &... columns) {
+        for (auto it = std::begin(range), end = std::end(range); it != end; ++it) {
+            unzip_row(*it, make_index_sequence<sizeof...(Columns)> {}, columns...);
+        }
+    }
+    template<typename Result, std::size_t... Is>
+    void reserve_columns(Result &result, std::size_t size, index_sequence<Is...>) {
+        using swallow = int[];
+        (void) swallow {0, (std::get<Is>(result).reserve(size), 0)...};
+    }
+    // Empty columns, each allocating through `allocator`
+    template<typename Result, typename Alloc, std::size_t... Is>
+    Result make_columns(const Alloc &allocator, index_sequence<Is...>) {
+        return Result(typename std::tuple_element<Is, Result>::type(
+            typename std::tuple_element<Is, Result>::type::allocator_type(allocator))...);
+    }
+    template<typename Result, typename T, std::size_t... Is>
+    Result to_soa(Result result, const T &range, index_sequence<Is...>, std::true_type) {
+        reserve_columns(result, range.size(), index_sequence<Is...> {});
+        unzip(range, std::get<Is>(result)...);
+        return result;
+    }
+    template<typename Result, typename T, std::size_t... Is>
+    Result to_soa(Result result, const T &range, index_sequence<Is...>, std::false_type) {
+        unzip(range, std::get<Is>(result)...);
+        return result;
+    }
+    template<std_container T, typename Alloc>
+    soa_columns_t<typename T::value_type, Alloc> to_soa(const T &range, const Alloc &allocator) {
+        using result_type = soa_columns_t<typename T::value_type, Alloc>;
+        using indices = make_index_sequence<std::tuple_size<result_type>::value>;
+        return to_soa(make_columns<result_type>(allocator, indices {}), range, indices {}, sized<const T> {});
+    }
+    template<typename Result, typename Zip, std::size_t... Is>
+    Result zip_to_soa(Result result, const Zip &view, index_sequence<Is...>, std::true_type) {
+        using swallow = int[];
+        (void) swallow {0, (std::get<Is>(result).assign(std::get<Is>(view.begin().base()), std::get<Is>(view.end().base())), 0)...};
+        return result;
+    }
+    template<typename Result, typename Zip, std::size_t... Is>
+    Result zip_to_soa(Result result, const Zip &view, index_sequence<Is...>, std::false_type) {
+        unzip(view, std::get<Is>(result)...);
+        return result;
+    }
+    template<typename... Ranges, typename Alloc>
+    soa_columns_t<typename views::zip<Ranges...>::value_type, Alloc> to_soa(const views::zip<Ranges...> &view, const Alloc &allocator) {
+        using result_type = soa_columns_t<typename views::zip<Ranges...>::value_type, Alloc>;
+        using indices = make_index_sequence<sizeof...(Ranges)>;
+        return zip_to_soa(make_columns<result_type>(allocator, indices {}), view, indices {},
+                          is_random_access_iterator<typename views::zip<Ranges...>::iterator> {});
+    }
+    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
+    constexpr Ta<std::pair<T1, T2>, N> zip(const Ta<T1, N> &first, const Ta<T2, N> &second) {
+        Ta<std::pair<T1, T2>, N> result{};
+        for (std::size_t i{0}; i < N; ++i) {
+            result[i] = std::make_pair(first[i], second[i]);
+        }
+
+        return result;
+    }
+    template<typename T, typename Compare>
+    constexpr typename T::value_type max(const T &container, const Compare &cmp, std::false_type) {
+        if (container.empty())
+            return std::numeric_limits<typename T::value_type>::min();
+        // Tracks the best position rather than copying each better element, which also works for const members
+        auto it = std::begin(container);
+        auto result = it;
+        const auto end = std::end(container);
+
+        for (++it; it != end; ++it) {
+            if (cmp(*result, *it))
+                result = it;
+        }
+
+        return *result;
+    }
+    template<typename T, typename Compare>
+    constexpr typename T::value_type min(const T &container, const Compare &cmp, std::false_type) {
+        if (container.empty())
+            return std::numeric_limits<typename T::value_type>::max();
+        auto it = std::begin(container);
+        auto result = it;
+        const auto end = std::end(container);
+
+        for (++it; it != end; ++it) {
+            if (cmp(*result, *it))
+                result = it;
+        }
+
+        return *result;
+    }
+#if RANGED_SIMD
+    // Which of several equal (or unordered, e.g. NaN) elements is returned is unspecified for the SIMD kernels
+    template<typename T, typename Compare>
+    typename T::value_type max(const T &container, const Compare &, std::true_type) {
+        if (container.empty())
+            return std::numeric_limits<typename T::value_type>::min();
+        return simd::max(container.data(), container.size());
+    }
+    template<typename T, typename Compare>
+    typename T::value_type min(const T &container, const Compare &, std::true_type) {
+        if (container.empty())
+            return std::numeric_limits<typename T::value_type>::max();
+        return simd::min(container.data(), container.size());
+    }
+#endif
 
+    // The best of the segments' extrema; ties go to the earlier segment, as they go to the earlier element
+    template<typename T, typename Compare>
+    typename T::value_type max(const T &container, const Compare &cmp, segmented_scan) {
+        typename T::value_type result = std::numeric_limits<typename T::value_type>::min();
+        bool found = false;
+        for (const auto segment: container.segments()) {
+            if (segment.empty())
+                continue;
+            const typename T::value_type best = max(segment, cmp);
+            if (!found || cmp(result, best))
+                result = best;
+            found = true;
+        }
 
-            iterator& begin() { return begin_it; }
-            iterator& end() { return end_it; }
-            iterator begin() const { return begin_it; }
-            iterator end() const { return end_it; }
+        return result;
+    }
+    template<typename T, typename Compare>
+    typename T::value_type min(const T &container, const Compare &cmp, segmented_scan) {
+        typename T::value_type result = std::numeric_limits<typename T::value_type>::max();
+        bool found = false;
+        for (const auto segment: container.segments()) {
+            if (segment.empty())
+                continue;
+            const typename T::value_type best = min(segment, cmp);
+            if (!found || cmp(result, best))
+                result = best;
+            found = true;
+        }
 
-        private:
-            iterator begin_it;
-            iterator end_it;
-        };
+        return result;
+    }
 
-    } // namespace _decl
+    template<typename T, typename Compare, typename Default>
+    using is_simd_extremum = std::integral_constant<bool, is_simd_range<const T>::value && std::is_same<Compare, Default>::value>;
 
-    template<std_container T, typename Pred>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::any_of` instead")]]
-#endif
-    constexpr bool any(const T &container, const Pred &func);
-    template<std_container T, typename Pred>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::any_of` instead")]]
-#endif
-    constexpr bool any(T &container, const Pred &func);
-    template<std_container T, typename Pred>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::all_of` instead")]]
-#endif
-    constexpr bool all(const T &container, const Pred &func);
-    template<std_container T, typename Pred>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::all_of` instead")]]
-#endif
-    constexpr bool all(T &container, const Pred &func);
-    template<std_container T>
-    constexpr bool contains(const T &container, const typename T::value_type &value);
-    template<std_container T>
-    constexpr bool contains(T &container, const typename T::value_type &value);
-    template<std_container T, typename Func>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::for_each` instead")]]
-#endif
-    constexpr void for_each(const T &container, const Func &func);
-    template<std_container T, typename Func>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::for_each` instead")]]
-#endif
-    constexpr void for_each(T &container, const Func &func);
-    template<std_container T, typename Pred>
-    constexpr typename T::value_type
-    first_or_default(const T &container, const Pred &func,
-                     const typename T::value_type &default_value = typename T::value_type());
-    template<std_container T, typename Pred>
-    constexpr typename T::value_type
-    first_or_default(T &container, const Pred &func,
-                     const typename T::value_type &default_value = typename T::value_type());
+    template<std_container T, class Compare>
+    constexpr typename T::value_type max(const T &container, const Compare &cmp) {
+        return max(container, cmp, segmented_or<T, is_simd_extremum<T, Compare, std::less<typename T::value_type>>> {});
+    }
+    template<std_container T, typename Compare>
+    constexpr typename T::value_type max(T &container, const Compare &cmp) {
+        return max(container, cmp, segmented_or<T, is_simd_extremum<T, Compare, std::less<typename T::value_type>>> {});
+    }
+    template<std_container T, typename Compare>
+    constexpr typename T::value_type min(const T &container, const Compare &cmp) {
+        return min(container, cmp, segmented_or<T, is_simd_extremum<T, Compare, more<typename T::value_type>>> {});
+    }
+    template<std_container T, typename Compare>
+    constexpr typename T::value_type min(T &container, const Compare &cmp) {
+        return min(container, cmp, segmented_or<T, is_simd_extremum<T, Compare, more<typename T::value_type>>> {});
+    }
 
-    template<template<typename, typename...> class Tt, class Tf>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::to` instead")]]
-#endif
-    constexpr Tt<typename Tf::value_type> to(const Tf &container);
-    template<template<typename, typename...> class Tt, class Tf>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::to` instead")]]
-#endif
-    constexpr Tt<typename Tf::value_type> to(Tf &container);
-    template<template<typename, typename...> class Tt, class Tf>
-    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::to` instead")]]
-#endif
-    to(const Tf &container);
-    template<template<typename, typename...> class Tt, class Tf>
-    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::to` instead")]]
-#endif
-    to(Tf &container);
-    template<std::size_t N, std_container T>
-    constexpr std::array<typename T::value_type, N> to_array(T &container);
-    template<std::size_t N, std_container T>
-    constexpr std::array<typename T::value_type, N> to_array(const T &container);
-    template<std_container T, typename Pred>
-    constexpr size_t count_if(const T &container, const Pred &func);
-    template<std_container T, typename Pred>
-    constexpr size_t count_if(T &container, const Pred &func);
-    template<std_container T, typename Compare = std::less<typename T::value_type>>
-    constexpr typename T::value_type max(const T &container, const Compare &cmp = {});
-    template<std_container T, typename Compare = std::less<typename T::value_type>>
-    constexpr typename T::value_type max(T &container, const Compare &cmp = {});
-    template<std_container T, typename Compare = more<typename T::value_type>>
-    constexpr typename T::value_type min(const T &container, const Compare &cmp = {});
-    template<std_container T, typename Compare = more<typename T::value_type>>
-    constexpr typename T::value_type min(T &container, const Compare &cmp = {});
+    // The best `k` elements offered so far, with their positions in the range: an element is better when it is greater
+    // by `cmp`, or equivalent and earlier. The worst one is on top of the heap, where a better element replaces it.
+    template<typename T, typename Compare>
+    class top_k_heap {
+    public:
+        using entry = std::pair<T, std::size_t>;
+
+        top_k_heap(std::size_t k, const Compare &cmp) : k_(k), better_{cmp} {}
+
+        void reserve(std::size_t size) { entries_.reserve(std::min(k_, size)); }
+
+        // Positions must be offered in increasing order, so an element equivalent to the top is never better
+        template<typename U>
+        void offer(U &&value, std::size_t position) {
+            if (entries_.size() < k_) {
+                entries_.emplace_back(std::forward<U>(value), position);
+                std::push_heap(entries_.begin(), entries_.end(), better_);
+            } else if (k_ != 0 && better_.cmp(entries_.front().first, value)) {
+                replace_top(entry(std::forward<U>(value), position));
+            }
+        }
 
-#if __cplusplus < 201703L
-    template<std_container T, class Inserter = typename std::conditional<has_reserve<typename std::decay<T>::type>::value, std::back_insert_iterator<typename std::decay<T>::type>, std::insert_iterator<typename std::decay<T>::type>>::type, typename ...Args>
-    constexpr void emplace_range(T &container, Args &&...args) = delete;
-#else
-    template<std_container T, class Inserter = typename std::conditional<_decl::has_reserve<typename std::decay<T>::type>::value, std::back_insert_iterator<typename std::decay<T>::type>, std::insert_iterator<typename std::decay<T>::type>>::type, typename ...Args>
-    constexpr void emplace_range(T &container, Args &&...args);
-#endif
-    template<std_container T, class Inserter = typename std::conditional<has_reserve<typename std::decay<T>::type>::value, std::back_insert_iterator<typename std::decay<T>::type>, std::insert_iterator<typename std::decay<T>::type>>::type, typename Range>
-    constexpr void emplace_range(T &container, Range &&range);
-    template<class T, class Inserter = std::back_insert_iterator<T>>
-    constexpr void emplace_range(T &container, std::initializer_list<typename T::value_type> list);
+        // Keeps the best of both heaps, whatever the positions
+        void merge(top_k_heap &&other) {
+            for (entry &candidate: other.entries_) {
+                if (entries_.size() < k_) {
+                    entries_.push_back(std::move(candidate));
+                    std::push_heap(entries_.begin(), entries_.end(), better_);
+                } else if (k_ != 0 && better_(candidate, entries_.front())) {
+                    replace_top(std::move(candidate));
+                }
+            }
+        }
 
-    template<std_container T, class Pred>
-    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_ref_view<const T, Pred>>::type filter(const T &container, const Pred &func);
-    template<std_container T, class Pred>
-    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_view<typename std::decay<T>::type, Pred>>::type filter(T &&container, const Pred &func);
-    template<typename T, size_t N, typename Pred, class AllocT = std::allocator<T>>
-    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, std::vector<T>>::type filter(const std::array<T, N> &array, const Pred &func);
+        std::size_t size() const noexcept { return entries_.size(); }
 
-    template<template<typename...> class T, typename... Args, typename Pred>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::transform` instead")]]
-#endif
-    constexpr views::transform<T<Args...>, Pred> transform(T<Args...> &container, const Pred &pred);
-    template<template<typename...> class T, typename... Args, typename Pred>
-#if __cplusplus >= 202002L && !(RANGED_NO_DEPRECATION_WARNINGS)
-    [[deprecated("Preffer using `std::ranges::transform` instead")]]
-#endif
-    constexpr views::transform<const T<Args...>, Pred> transform(const T<Args...> &container, const Pred &pred);
+        // The last of the kept elements, on top of the heap
+        T worst() && { return std::move(entries_.front().first); }
 
-    template<std_container T, std_container U>
-    constexpr views::zip<T, U> zip(T &first, U &second);
-    template<std_container T, std_container U>
-    constexpr views::zip<const T, const U> zip(const T &first, const U &second);
-    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
-    constexpr Ta<std::tuple<T1, T2>, N> zip(Ta<T1, N> &first, Ta<T2, N> &second);
-    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
-    constexpr Ta<std::tuple<T1, T2>, N> zip(const Ta<T1, N> &first, const Ta<T2, N> &second);
+        // Best first
+        std::vector<T> sorted() && {
+            std::sort_heap(entries_.begin(), entries_.end(), better_);
+            std::vector<T> result;
+            result.reserve(entries_.size());
+            for (entry &e: entries_) {
+                result.push_back(std::move(e.first));
+            }
+            return result;
+        }
 
+    private:
+        struct better_entry {
+            Compare cmp;
 
-#ifdef RANGED_IMPLEMENTATION
+            bool operator()(const entry &lhs, const entry &rhs) const {
+                return cmp(rhs.first, lhs.first) || (!cmp(lhs.first, rhs.first) && lhs.second < rhs.second);
+            }
+        };
 
+        void replace_top(entry &&replacement) {
+            std::pop_heap(entries_.begin(), entries_.end(), better_);
+            entries_.back() = std::move(replacement);
+            std::push_heap(entries_.begin(), entries_.end(), better_);
+        }
 
-    template<std_container T, typename Pred>
-    constexpr bool any(const T &container, const Pred &func) {
-#if __cplusplus >= 202002L
-        return std::ranges::any_of(container, func);
-#else
-        for (const auto &element: container) {
-            if (func(element))
-                return true;
+        std::size_t k_;
+        better_entry better_;
+        std::vector<entry> entries_;
+    };
+
+    // `cmp` with its operands swapped, turning the greatest elements into the smallest
+    template<typename Compare>
+    struct reverse_compare {
+        Compare cmp;
+
+        template<typename T, typename U>
+        bool operator()(const T &lhs, const U &rhs) const { return cmp(rhs, lhs); }
+    };
+
+    // Room for `k` entries, unless the range is known to be shorter
+    template<typename T, typename Compare>
+    void reserve_top_k_hint(top_k_heap<typename T::value_type, Compare> &heap, const T &range, std::true_type) {
+        heap.reserve(range.size_hint());
+    }
+    template<typename T, typename Compare>
+    void reserve_top_k_hint(top_k_heap<typename T::value_type, Compare> &, const T &, std::false_type) noexcept {}
+    template<typename T, typename Compare>
+    void reserve_top_k(top_k_heap<typename T::value_type, Compare> &heap, const T &range, std::true_type) {
+        heap.reserve(static_cast<std::size_t>(std::end(range) - std::begin(range)));
+    }
+    template<typename T, typename Compare>
+    void reserve_top_k(top_k_heap<typename T::value_type, Compare> &heap, const T &range, std::false_type) {
+        reserve_top_k_hint(heap, range, has_size_hint<const T> {});
+    }
+
+    template<typename T, typename Compare>
+    top_k_heap<typename T::value_type, Compare> top_k_of(const T &range, std::size_t k, const Compare &cmp) {
+        top_k_heap<typename T::value_type, Compare> heap(k, cmp);
+        reserve_top_k(heap, range, is_random_access_iterator<decltype(std::begin(range))> {});
+        std::size_t position = 0;
+        for (auto it = std::begin(range), end = std::end(range); it != end; ++it) {
+            heap.offer(*it, position++);
+        }
+        return heap;
+    }
+    template<std_container T, typename Compare>
+    std::vector<typename T::value_type> top_k(const T &range, std::size_t k, const Compare &cmp) {
+        return top_k_of(range, k, cmp).sorted();
+    }
+
+    struct sequential_top_k {
+        template<typename T, typename Compare>
+        top_k_heap<typename T::value_type, Compare> operator()(const T &range, std::size_t k, const Compare &cmp) const {
+            return top_k_of(range, k, cmp);
         }
+    };
 
-        return false;
+    // Keeps the shorter side of position `n`: the `n + 1` first elements of the order, or the `size - n` last ones
+    template<typename T, typename Compare, typename TopK>
+    typename T::value_type nth_of(const T &range, std::size_t n, const Compare &cmp, const TopK &top_k, std::true_type) {
+        const std::size_t size = static_cast<std::size_t>(std::end(range) - std::begin(range));
+        if (n >= size)
+            throw std::out_of_range("Position is past the end of the range.");
+        if (size - n < n + 1)
+            return top_k(range, size - n, cmp).worst();
+        return top_k(range, n + 1, reverse_compare<Compare> {cmp}).worst();
+    }
+    template<typename T, typename Compare, typename TopK>
+    typename T::value_type nth_of(const T &range, std::size_t n, const Compare &cmp, const TopK &top_k, std::false_type) {
+        auto heap = top_k(range, n + 1, reverse_compare<Compare> {cmp});
+        if (n == std::numeric_limits<std::size_t>::max() || heap.size() <= n)
+            throw std::out_of_range("Position is past the end of the range.");
+        return std::move(heap).worst();
+    }
+    template<std_container T, typename Compare>
+    typename T::value_type nth(const T &range, std::size_t n, const Compare &cmp) {
+        return nth_of(range, n, cmp, sequential_top_k {}, is_random_access_iterator<decltype(std::begin(range))> {});
+    }
+#if __cplusplus >= 201703L
+    template<std_container T, class Inserter, typename... Args>
+    constexpr void emplace_range(T &container, Args &&...args) {
+        static_assert(has_emplace_back<std::decay_t<T>>::value && !std::is_const_v<T>);
+        (container.emplace_back(std::forward<Args>(args)), ...);
+    }
 #endif
+    template<std_container T, class Inserter, typename Range>
+    constexpr void emplace_range(T &container, Range &&range) {
+        static_assert(!std::is_const<T>::value, "Container cannot be const.");
+        std::copy(std::begin(std::forward<Range>(range)), std::end(std::forward<Range>(range)), Inserter{container});
     }
-    template<std_container T, typename Pred>
-    constexpr bool any(T &container, const Pred &func) {
-#if __cplusplus >= 202002L
-        return std::ranges::any_of(container, func);
-#else
-        for (const auto &element: container) {
-            if (func(element))
-                return true;
+
+    template<class T, class Inserter>
+    constexpr void emplace_range(T &container, std::initializer_list<typename T::value_type> list) {
+        std::copy(list.begin(), list.end(), Inserter(container));
+    }
+
+    template<std_container B, typename P, typename BuildKey, typename ProbeKey>
+    views::hash_join_view<views::ref_view_of<const B>, views::stored_range_t<P>, BuildKey, ProbeKey, join_kind::inner>
+    hash_join(const B &build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key) {
+        return hash_join(join_tag<join_kind::inner> {}, build, std::forward<P>(probe), build_key, probe_key);
+    }
+    template<join_kind Kind, std_container B, typename P, typename BuildKey, typename ProbeKey>
+    views::hash_join_view<views::ref_view_of<const B>, views::stored_range_t<P>, BuildKey, ProbeKey, Kind>
+    hash_join(join_tag<Kind>, const B &build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key) {
+        return views::hash_join_view<views::ref_view_of<const B>, views::stored_range_t<P>, BuildKey, ProbeKey, Kind>{
+            views::as_ref_view(build), views::store_range(std::forward<P>(probe)), build_key, probe_key};
+    }
+
+    template<typename B, typename P, typename BuildKey, typename ProbeKey, typename Compare>
+    typename std::enable_if<is_range<typename std::remove_reference<B>::type>::value && !is_join_tag<typename std::decay<B>::type>::value,
+        views::merge_join_view<views::stored_range_t<B>, views::stored_range_t<P>, BuildKey, ProbeKey, Compare, join_kind::inner>>::type
+    merge_join(B &&build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key, const Compare &compare) {
+        return merge_join(join_tag<join_kind::inner> {}, std::forward<B>(build), std::forward<P>(probe), build_key, probe_key, compare);
+    }
+    template<join_kind Kind, typename B, typename P, typename BuildKey, typename ProbeKey, typename Compare>
+    typename std::enable_if<is_range<typename std::remove_reference<B>::type>::value,
+        views::merge_join_view<views::stored_range_t<B>, views::stored_range_t<P>, BuildKey, ProbeKey, Compare, Kind>>::type
+    merge_join(join_tag<Kind>, B &&build, P &&probe, const BuildKey &build_key, const ProbeKey &probe_key, const Compare &compare) {
+        return views::merge_join_view<views::stored_range_t<B>, views::stored_range_t<P>, BuildKey, ProbeKey, Compare, Kind>{
+            views::store_range(std::forward<B>(build)), views::store_range(std::forward<P>(probe)), build_key, probe_key, compare};
+    }
+
+    template<typename Range, typename... Rs>
+    std::vector<Range> stored_ranges(Rs &&... ranges) {
+        static_assert(all_true<std::is_same<views::stored_range_t<Rs>, Range>::value...>::value,
+                      "Merged ranges must be stored as the same type: all lvalues, or all rvalues, of one range type");
+        std::vector<Range> result;
+        result.reserve(sizeof...(Rs));
+        int swallow[] = {0, (result.push_back(views::store_range(std::forward<Rs>(ranges))), 0)...};
+        (void) swallow;
+        return result;
+    }
+    template<typename Range>
+    std::vector<views::ref_view_of<const Range>> referenced_ranges(const std::vector<Range> &ranges) {
+        std::vector<views::ref_view_of<const Range>> result;
+        result.reserve(ranges.size());
+        for (const Range &range: ranges) {
+            result.push_back(views::as_ref_view(range));
         }
+        return result;
+    }
+
+    template<typename R1, typename R2, typename... Rs>
+    merge_of_t<views::merge_view<views::stored_range_t<R1>, transparent_less, false>, R1, R2, Rs...>
+    merge(R1 &&first, R2 &&second, Rs &&... rest) {
+        return views::merge_view<views::stored_range_t<R1>, transparent_less, false>{
+            stored_ranges<views::stored_range_t<R1>>(std::forward<R1>(first), std::forward<R2>(second), std::forward<Rs>(rest)...), transparent_less {}};
+    }
+    template<typename R1, typename R2, typename... Rs>
+    merge_of_t<views::merge_view<views::stored_range_t<R1>, transparent_less, true>, R1, R2, Rs...>
+    merge(unique_merge_t, R1 &&first, R2 &&second, Rs &&... rest) {
+        return views::merge_view<views::stored_range_t<R1>, transparent_less, true>{
+            stored_ranges<views::stored_range_t<R1>>(std::forward<R1>(first), std::forward<R2>(second), std::forward<Rs>(rest)...), transparent_less {}};
+    }
+    template<std_container R, typename Compare>
+    typename std::enable_if<!is_range<Compare>::value, views::merge_view<views::ref_view_of<const R>, Compare, false>>::type
+    merge(const std::vector<R> &ranges, const Compare &compare) {
+        return views::merge_view<views::ref_view_of<const R>, Compare, false>{referenced_ranges(ranges), compare};
+    }
+    template<std_container R, typename Compare>
+    typename std::enable_if<!is_range<Compare>::value, views::merge_view<R, Compare, false>>::type
+    merge(std::vector<R> &&ranges, const Compare &compare) {
+        return views::merge_view<R, Compare, false>{std::move(ranges), compare};
+    }
+    template<std_container R, typename Compare>
+    views::merge_view<views::ref_view_of<const R>, Compare, true> merge(unique_merge_t, const std::vector<R> &ranges, const Compare &compare) {
+        return views::merge_view<views::ref_view_of<const R>, Compare, true>{referenced_ranges(ranges), compare};
+    }
+    template<std_container R, typename Compare>
+    views::merge_view<R, Compare, true> merge(unique_merge_t, std::vector<R> &&ranges, const Compare &compare) {
+        return views::merge_view<R, Compare, true>{std::move(ranges), compare};
+    }
+
+    template<typename T, typename KeyFn>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value,
+        views::distinct_view<views::stored_range_t<T>, KeyFn, views::exact_seen<distinct_key_t<T, KeyFn>>>>::type
+    distinct(T &&range, const KeyFn &key) {
+        return views::distinct_view<views::stored_range_t<T>, KeyFn, views::exact_seen<distinct_key_t<T, KeyFn>>>{
+            views::store_range(std::forward<T>(range)), key, views::exact_seen<distinct_key_t<T, KeyFn>>()};
+    }
+    template<typename T, typename KeyFn>
+    views::adjacent_distinct_view<views::stored_range_t<T>, KeyFn> distinct(sorted_input_t, T &&range, const KeyFn &key) {
+        return views::adjacent_distinct_view<views::stored_range_t<T>, KeyFn>{views::store_range(std::forward<T>(range)), key};
+    }
+    template<typename T, typename KeyFn>
+    views::distinct_view<views::stored_range_t<T>, KeyFn, views::bloom_seen<distinct_key_t<T, KeyFn>>>
+    distinct(approximate_t mode, T &&range, const KeyFn &key) {
+        return views::distinct_view<views::stored_range_t<T>, KeyFn, views::bloom_seen<distinct_key_t<T, KeyFn>>>{
+            views::store_range(std::forward<T>(range)), key, views::bloom_seen<distinct_key_t<T, KeyFn>>(mode.bytes)};
+    }
+
+    template<typename R1, typename R2, typename... Rs>
+    typename std::enable_if<all_true<is_range<typename std::remove_reference<R1>::type>::value, is_range<typename std::remove_reference<R2>::type>::value,
+                                     is_range<typename std::remove_reference<Rs>::type>::value...>::value,
+        views::concat_view<views::stored_range_t<R1>, views::stored_range_t<R2>, views::stored_range_t<Rs>...>>::type
+    concat(R1 &&first, R2 &&second, Rs &&... rest) {
+        return views::concat_view<views::stored_range_t<R1>, views::stored_range_t<R2>, views::stored_range_t<Rs>...>{
+            views::store_range(std::forward<R1>(first)), views::store_range(std::forward<R2>(second)), views::store_range(std::forward<Rs>(rest))...};
+    }
+    template<typename T>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::flatten_view<views::stored_range_t<T>>>::type
+    flatten(T &&range) {
+        return views::flatten_view<views::stored_range_t<T>>{views::store_range(std::forward<T>(range))};
+    }
+
+    template<typename T>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::sliding_view<views::stored_range_t<T>>>::type
+    sliding(T &&range, std::size_t n) {
+        return views::sliding_view<views::stored_range_t<T>>{views::store_range(std::forward<T>(range)), n};
+    }
+    template<typename T, typename Aggregator>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::sliding_aggregate_view<views::stored_range_t<T>, Aggregator>>::type
+    sliding(T &&range, std::size_t n, const Aggregator &aggregator) {
+        return views::sliding_aggregate_view<views::stored_range_t<T>, Aggregator>{views::store_range(std::forward<T>(range)), n, aggregator};
+    }
+    constexpr views::sliding_adaptor sliding(std::size_t n) noexcept {
+        return views::sliding_adaptor{n};
+    }
+    template<typename Aggregator>
+    views::window_aggregate_adaptor<views::sliding_aggregate_view, Aggregator> sliding(std::size_t n, const Aggregator &aggregator) {
+        return views::window_aggregate_adaptor<views::sliding_aggregate_view, Aggregator>{n, aggregator};
+    }
+
+    template<typename T>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::tumbling_view<views::stored_range_t<T>>>::type
+    tumbling(T &&range, std::size_t n) {
+        return views::tumbling_view<views::stored_range_t<T>>{views::store_range(std::forward<T>(range)), n};
+    }
+    template<typename T, typename Aggregator>
+    typename std::enable_if<is_range<typename std::remove_reference<T>::type>::value, views::tumbling_aggregate_view<views::stored_range_t<T>, Aggregator>>::type
+    tumbling(T &&range, std::size_t n, const Aggregator &aggregator) {
+        return views::tumbling_aggregate_view<views::stored_range_t<T>, Aggregator>{views::store_range(std::forward<T>(range)), n, aggregator};
+    }
+    constexpr views::tumbling_adaptor tumbling(std::size_t n) noexcept {
+        return views::tumbling_adaptor{n};
+    }
+    template<typename Aggregator>
+    views::window_aggregate_adaptor<views::tumbling_aggregate_view, Aggregator> tumbling(std::size_t n, const Aggregator &aggregator) {
+        return views::window_aggregate_adaptor<views::tumbling_aggregate_view, Aggregator>{n, aggregator};
+    }
+
+    // Parallel algorithms split random access ranges into chunks of at least `parallel_min_chunk` elements, a few per
+    // thread so that uneven predicates still balance. Other ranges are not worth splitting and run sequentially.
+    constexpr std::size_t parallel_min_chunk = std::size_t {1} << 14;
+
+    struct parallel_plan {
+        std::size_t size;
+        std::size_t concurrency;
+        std::size_t chunks;
+        std::size_t chunk_size;
+
+        constexpr std::size_t begin(std::size_t chunk) const noexcept { return chunk * chunk_size; }
+        constexpr std::size_t end(std::size_t chunk) const noexcept { return (chunk + 1) * chunk_size < size ? (chunk + 1) * chunk_size : size; }
+    };
+
+    inline parallel_plan plan_parallel(std::size_t size, std::size_t concurrency) {
+        if (concurrency == 0)
+            concurrency = thread_pool::instance().concurrency();
+        const std::size_t wanted = std::max<std::size_t>(1, std::min(size / parallel_min_chunk, concurrency * 4));
+        const std::size_t chunk_size = std::max<std::size_t>(1, (size + wanted - 1) / wanted);
+        return parallel_plan {size, concurrency, (size + chunk_size - 1) / chunk_size, chunk_size};
+    }
+
+    // How many elements a chunk visits between checks for early cancellation
+    constexpr std::size_t cancellation_stride(const execution::parallel_policy &) noexcept { return 1024; }
+    constexpr std::size_t cancellation_stride(const execution::parallel_unsequenced_policy &) noexcept {
+        return std::numeric_limits<std::size_t>::max();
+    }
+
+    template<typename Policy, typename T>
+    using is_parallel_dispatch = std::integral_constant<bool,
+        !std::is_same<typename std::decay<Policy>::type, execution::sequenced_policy>::value &&
+        is_random_access_iterator<decltype(std::begin(std::declval<T &>()))>::value>;
+
+    template<typename Policy, typename Iter, typename Pred>
+    bool parallel_any(const Policy &policy, Iter first, Iter last, const Pred &func) {
+        const parallel_plan plan = plan_parallel(static_cast<std::size_t>(last - first), policy.concurrency);
+        const std::size_t stride = cancellation_stride(policy);
+        std::atomic<bool> found {false};
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            Iter it = first + plan.begin(chunk);
+            const Iter end = first + plan.end(chunk);
+            while (it != end && !found.load(std::memory_order_relaxed)) {
+                const Iter block_end = static_cast<std::size_t>(end - it) > stride ? it + stride : end;
+                for (; it != block_end; ++it) {
+                    if (func(*it)) {
+                        found.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            }
+        });
+
+        return found.load();
+    }
+    template<typename Policy, typename T, typename Pred>
+    bool any(const Policy &, const T &container, const Pred &func, std::false_type) {
+        return any(container, func);
+    }
+    template<typename Policy, typename T, typename Pred>
+    bool any(const Policy &policy, const T &container, const Pred &func, std::true_type) {
+        return parallel_any(policy, std::begin(container), std::end(container), func);
+    }
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, bool> any(const Policy &policy, const T &container, const Pred &func) {
+        return any(policy, container, func, is_parallel_dispatch<Policy, const T> {});
+    }
+
+    template<typename Policy, typename T, typename Pred>
+    bool all(const Policy &, const T &container, const Pred &func, std::false_type) {
+        return all(container, func);
+    }
+    template<typename Policy, typename T, typename Pred>
+    bool all(const Policy &policy, const T &container, const Pred &func, std::true_type) {
+        typedef typename std::iterator_traits<decltype(std::begin(container))>::reference reference;
+        return !parallel_any(policy, std::begin(container), std::end(container), [&func](reference item) { return !func(item); });
+    }
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, bool> all(const Policy &policy, const T &container, const Pred &func) {
+        return all(policy, container, func, is_parallel_dispatch<Policy, const T> {});
+    }
 
-        return false;
-#endif
+    template<typename Policy, typename T, typename Pred>
+    size_t count_if(const Policy &, const T &container, const Pred &func, std::false_type) {
+        return count_if(container, func);
     }
+    template<typename Policy, typename T, typename Pred>
+    size_t count_if(const Policy &policy, const T &container, const Pred &func, std::true_type) {
+        const auto first = std::begin(container);
+        const parallel_plan plan = plan_parallel(static_cast<std::size_t>(std::end(container) - first), policy.concurrency);
+        std::vector<size_t> counts(plan.chunks);
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            size_t result{};
+            const auto end = first + plan.end(chunk);
+            for (auto it = first + plan.begin(chunk); it != end; ++it) {
+                if (func(*it))
+                    ++result;
+            }
+            counts[chunk] = result;
+        });
 
-    template<std_container T, typename Pred>
-    constexpr bool all(const T &container, const Pred &func) {
-#if __cplusplus >= 202002L
-        return std::ranges::all_of(container, func);
-#else
-        for (const auto &element: container) {
-            if (!func(element))
-                return false;
+        size_t result{};
+        for (const size_t count: counts) {
+            result += count;
         }
+        return result;
+    }
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, size_t> count_if(const Policy &policy, const T &container, const Pred &func) {
+        return count_if(policy, container, func, is_parallel_dispatch<Policy, const T> {});
+    }
 
-        return true;
-#endif
+    template<typename Policy, typename T, typename Func>
+    void for_each(const Policy &, T &container, const Func &func, std::false_type) {
+        for_each(container, func);
+    }
+    template<typename Policy, typename T, typename Func>
+    void for_each(const Policy &policy, T &container, const Func &func, std::true_type) {
+        const auto first = std::begin(container);
+        const parallel_plan plan = plan_parallel(static_cast<std::size_t>(std::end(container) - first), policy.concurrency);
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            const auto end = first + plan.end(chunk);
+            for (auto it = first + plan.begin(chunk); it != end; ++it) {
+                func(*it);
+            }
+        });
+    }
+    template<typename Policy, std_container T, typename Func>
+    enable_if_execution_policy<Policy, void> for_each(const Policy &policy, T &container, const Func &func) {
+        for_each(policy, container, func, is_parallel_dispatch<Policy, T> {});
     }
-    template<std_container T, typename Pred>
-    constexpr bool all(T &container, const Pred &func) {
-#if __cplusplus >= 202002L
-        return std::ranges::all_of(container, func);
-#else
-        for (const auto &element: container) {
-            if (!func(element))
-                return false;
-        }
 
-        return true;
-#endif
+    template<typename Policy, typename T, typename Pred>
+    typename T::value_type first_or_default(const Policy &, const T &container, const Pred &func,
+                                            const typename T::value_type &default_value, std::false_type) {
+        return first_or_default(container, func, default_value);
     }
-    template<std_container T>
-    constexpr bool contains(const T &container, const typename T::value_type &value) {
-#if __cplusplus >= 202002L
-        return std::ranges::find(container, value) != container.end();
-#else
-        return std::find(container.begin(), container.end(), value) != container.end();
-#endif
+    // Every chunk remembers its own first match; chunks after the earliest matching one stop, earlier ones keep going
+    template<typename Policy, typename T, typename Pred>
+    typename T::value_type first_or_default(const Policy &policy, const T &container, const Pred &func,
+                                            const typename T::value_type &default_value, std::true_type) {
+        typedef decltype(std::begin(container)) iterator;
+        const iterator first = std::begin(container);
+        const iterator last = std::end(container);
+        const parallel_plan plan = plan_parallel(static_cast<std::size_t>(last - first), policy.concurrency);
+        const std::size_t stride = cancellation_stride(policy);
+        const std::size_t none = std::numeric_limits<std::size_t>::max();
+        std::atomic<std::size_t> first_chunk {none};
+        std::vector<iterator> matches(plan.chunks, last);
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            iterator it = first + plan.begin(chunk);
+            const iterator end = first + plan.end(chunk);
+            while (it != end && first_chunk.load(std::memory_order_relaxed) > chunk) {
+                const iterator block_end = static_cast<std::size_t>(end - it) > stride ? it + stride : end;
+                for (; it != block_end; ++it) {
+                    if (func(*it)) {
+                        matches[chunk] = it;
+                        std::size_t current = first_chunk.load(std::memory_order_relaxed);
+                        while (chunk < current && !first_chunk.compare_exchange_weak(current, chunk)) {}
+                        return;
+                    }
+                }
+            }
+        });
+
+        const std::size_t found = first_chunk.load();
+        return found == none ? default_value : *matches[found];
     }
-    template<std_container T>
-    constexpr bool contains(T &container, const typename T::value_type &value) {
-#if __cplusplus >= 202002L
-        return std::ranges::find(container, value) != container.end();
-#else
-        return std::find(container.begin(), container.end(), value) != container.end();
-#endif
+    template<typename Policy, std_container T, typename Pred>
+    enable_if_execution_policy<Policy, typename T::value_type>
+    first_or_default(const Policy &policy, const T &container, const Pred &func, const typename T::value_type &default_value) {
+        return first_or_default(policy, container, func, default_value, is_parallel_dispatch<Policy, const T> {});
     }
-    template<std_container T, typename Func>
-    constexpr void for_each(const T &container, const Func &func) {
-#if __cplusplus >= 202002L
-        std::ranges::for_each(container, func);
-#else
-        for (const auto &element: container) {
-            func(element);
+
+    // Each chunk finds the position of its own extremum, and chunks are reduced in order with the same tie rule as the
+    // sequential loop, so the result does not depend on the number of threads.
+    template<typename Policy, typename Iter, typename Compare>
+    Iter parallel_extremum(const Policy &policy, Iter first, Iter last, const Compare &cmp) {
+        const parallel_plan plan = plan_parallel(static_cast<std::size_t>(last - first), policy.concurrency);
+        std::vector<Iter> best(plan.chunks, first);
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            Iter it = first + plan.begin(chunk);
+            const Iter end = first + plan.end(chunk);
+            Iter result = it;
+            for (++it; it != end; ++it) {
+                if (cmp(*result, *it))
+                    result = it;
+            }
+            best[chunk] = result;
+        });
+
+        Iter result = best.front();
+        for (std::size_t chunk{1}; chunk < plan.chunks; ++chunk) {
+            if (cmp(*result, *best[chunk]))
+                result = best[chunk];
         }
-#endif
+        return result;
     }
-    template<std_container T, typename Func>
-    constexpr void for_each(T &container, const Func &func) {
-#if __cplusplus >= 202002L
-        std::ranges::for_each(container, func);
-#else
-        for (const auto &element: container) {
-            func(element);
-        }
-#endif
+    template<typename Policy, typename T, typename Compare>
+    typename T::value_type max(const Policy &, const T &container, const Compare &cmp, std::false_type) {
+        return max(container, cmp);
     }
-    template<std_container T, typename Pred>
-    constexpr typename T::value_type first_or_default(const T &container, const Pred &func, const typename T::value_type &default_value) {
-        for (const auto &item: container) {
-            if (func(item))
-                return item;
-        }
-
-        return default_value;
+    template<typename Policy, typename T, typename Compare>
+    typename T::value_type max(const Policy &policy, const T &container, const Compare &cmp, std::true_type) {
+        if (container.empty())
+            return std::numeric_limits<typename T::value_type>::min();
+        return *parallel_extremum(policy, std::begin(container), std::end(container), cmp);
     }
-    template<std_container T, typename Pred>
-    constexpr typename T::value_type first_or_default(T &container, const Pred &func,
-                                                      const typename T::value_type &default_value) {
-        for (const auto &item: container) {
-            if (func(item))
-                return item;
-        }
-
-        return default_value;
+    template<typename Policy, std_container T, typename Compare>
+    enable_if_execution_policy<Policy, typename T::value_type> max(const Policy &policy, const T &container, const Compare &cmp) {
+        return max(policy, container, cmp, is_parallel_dispatch<Policy, const T> {});
     }
-    template<template<typename, typename...> class Tt, class Tf>
-    constexpr Tt<typename Tf::value_type> to(const Tf &container) {
-        return Tt<typename Tf::value_type>(std::begin(container), std::end(container));
+    template<typename Policy, typename T, typename Compare>
+    typename T::value_type min(const Policy &, const T &container, const Compare &cmp, std::false_type) {
+        return min(container, cmp);
     }
-    template<template<typename, typename...> class Tt, class Tf>
-    constexpr Tt<typename Tf::value_type> to(Tf &container) {
-        return Tt<typename Tf::value_type>(std::begin(container), std::end(container));
+    template<typename Policy, typename T, typename Compare>
+    typename T::value_type min(const Policy &policy, const T &container, const Compare &cmp, std::true_type) {
+        if (container.empty())
+            return std::numeric_limits<typename T::value_type>::max();
+        return *parallel_extremum(policy, std::begin(container), std::end(container), cmp);
     }
-    template<template<typename, typename...> class Tt, class Tf>
-    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
-    to(const Tf &container) {
-        return Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>(
-                std::begin(container), std::end(container));
+    template<typename Policy, std_container T, typename Compare>
+    enable_if_execution_policy<Policy, typename T::value_type> min(const Policy &policy, const T &container, const Compare &cmp) {
+        return min(policy, container, cmp, is_parallel_dispatch<Policy, const T> {});
     }
-    template<template<typename, typename...> class Tt, class Tf>
-    constexpr Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>
-    to(Tf &container) {
-        return Tt<typename std::decay<typename Tf::value_type::first_type>::type, typename Tf::value_type::second_type>(
-                std::begin(container), std::end(container));
+
+    template<typename Policy, typename T, typename Compare>
+    top_k_heap<typename T::value_type, Compare> top_k_of(const Policy &, const T &range, std::size_t k, const Compare &cmp, std::false_type) {
+        return top_k_of(range, k, cmp);
     }
-    template<std::size_t N, std_container T>
-    constexpr std::array<typename T::value_type, N> to_array(T &container) {
-        std::array<typename T::value_type, N> result{};
-        const size_t iter_to = std::min(N, container.size());
-        for (size_t i{0}; i < iter_to; ++i) {
-            result[i] = container.at(i);
-        }
+    template<typename Policy, typename T, typename Compare>
+    top_k_heap<typename T::value_type, Compare> top_k_of(const Policy &policy, const T &range, std::size_t k, const Compare &cmp, std::true_type) {
+        typedef top_k_heap<typename T::value_type, Compare> heap_type;
+        const auto first = std::begin(range);
+        const parallel_plan plan = plan_parallel(static_cast<std::size_t>(std::end(range) - first), policy.concurrency);
+        if (plan.chunks == 0)
+            return heap_type(k, cmp);
+        std::vector<heap_type> heaps(plan.chunks, heap_type(k, cmp));
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            heap_type &heap = heaps[chunk];
+            heap.reserve(plan.end(chunk) - plan.begin(chunk));
+            const auto end = first + plan.end(chunk);
+            std::size_t position = plan.begin(chunk);
+            for (auto it = first + plan.begin(chunk); it != end; ++it) {
+                heap.offer(*it, position++);
+            }
+        });
 
-        return result;
+        for (std::size_t chunk{1}; chunk < plan.chunks; ++chunk) {
+            heaps.front().merge(std::move(heaps[chunk]));
+        }
+        return std::move(heaps.front());
     }
-    template<std::size_t N, std_container T>
-    constexpr std::array<typename T::value_type, N> to_array(const T &container) {
-        std::array<typename T::value_type, N> result{};
-        const size_t iter_to = std::min(N, container.size());
-        for (size_t i{0}; i < iter_to; ++i) {
-            result[i] = container.at(i);
+    template<typename Policy, std_container T, typename Compare>
+    enable_if_execution_policy<Policy, std::vector<typename T::value_type>> top_k(const Policy &policy, const T &range, std::size_t k, const Compare &cmp) {
+        return top_k_of(policy, range, k, cmp, is_parallel_dispatch<Policy, const T> {}).sorted();
+    }
+
+    template<typename Policy>
+    struct parallel_top_k {
+        const Policy &policy;
+
+        template<typename T, typename Compare>
+        top_k_heap<typename T::value_type, Compare> operator()(const T &range, std::size_t k, const Compare &cmp) const {
+            return top_k_of(policy, range, k, cmp, is_parallel_dispatch<Policy, const T> {});
         }
+    };
+    template<typename Policy, std_container T, typename Compare>
+    enable_if_execution_policy<Policy, typename T::value_type> nth(const Policy &policy, const T &range, std::size_t n, const Compare &cmp) {
+        return nth_of(range, n, cmp, parallel_top_k<Policy> {policy}, is_random_access_iterator<decltype(std::begin(range))> {});
+    }
 
-        return result;
+    // Number of elements of a random access range, `fallback` for other ranges
+    template<typename R>
+    std::size_t size_or(const R &range, std::size_t, std::true_type) { return static_cast<std::size_t>(std::end(range) - std::begin(range)); }
+    template<typename R>
+    std::size_t size_or(const R &, std::size_t fallback, std::false_type) noexcept { return fallback; }
+
+    // Blocks of `parallel_min_chunk` elements for sequential and deterministic reductions, which then associate the
+    // same way whatever the number of threads; a few chunks per thread otherwise
+    inline parallel_plan plan_reduction(std::size_t size, std::size_t concurrency, bool deterministic) {
+        if (!deterministic)
+            return plan_parallel(size, concurrency);
+        if (concurrency == 0)
+            concurrency = thread_pool::instance().concurrency();
+        return parallel_plan {size, concurrency, (size + parallel_min_chunk - 1) / parallel_min_chunk, parallel_min_chunk};
     }
-    template<std_container T, typename Pred>
-    constexpr size_t count_if(const T &container, const Pred &func) {
-        size_t result{};
-        for (const auto &item: container) {
-            if (func(item))
-                ++result;
+
+    // Fold of the non-empty random access range [first, last), by four accumulators over consecutive quarters that are
+    // combined in order: the four dependency chains overlap, and `op` only needs to be associative
+    template<typename U, typename Iter, typename BinaryOp, typename UnaryOp>
+    U reduce_block(Iter first, Iter last, const BinaryOp &op, const UnaryOp &transform) {
+        const std::size_t quarter = static_cast<std::size_t>(last - first) / 4;
+        if (quarter < 2) {
+            U result(transform(*first));
+            for (++first; first != last; ++first) {
+                result = op(result, transform(*first));
+            }
+            return result;
         }
 
-        return result;
+        const Iter second = first + quarter;
+        const Iter third = second + quarter;
+        const Iter fourth = third + quarter;
+        U a0(transform(*first));
+        U a1(transform(*second));
+        U a2(transform(*third));
+        U a3(transform(*fourth));
+        for (std::size_t i{1}; i < quarter; ++i) {
+            a0 = op(a0, transform(first[i]));
+            a1 = op(a1, transform(second[i]));
+            a2 = op(a2, transform(third[i]));
+            a3 = op(a3, transform(fourth[i]));
+        }
+        for (Iter it = fourth + quarter; it != last; ++it) {
+            a3 = op(a3, transform(*it));
+        }
+        return op(op(op(a0, a1), a2), a3);
     }
-    template<std_container T, typename Pred>
-    constexpr size_t count_if(T &container, const Pred &func) {
-        size_t result{};
-        for (const auto &item: container) {
-            if (func(item))
-                ++result;
+
+    template<typename U, typename T, typename BinaryOp, typename UnaryOp>
+    U transform_reduce_of(const T &range, U init, const BinaryOp &op, const UnaryOp &transform, std::true_type) {
+        const auto first = std::begin(range);
+        const parallel_plan plan = plan_reduction(static_cast<std::size_t>(std::end(range) - first), 1, true);
+        for (std::size_t chunk{0}; chunk < plan.chunks; ++chunk) {
+            init = op(init, reduce_block<U>(first + plan.begin(chunk), first + plan.end(chunk), op, transform));
+        }
+        return init;
+    }
+    template<typename U, typename T, typename BinaryOp, typename UnaryOp>
+    U transform_reduce_of(const T &range, U init, const BinaryOp &op, const UnaryOp &transform, std::false_type) {
+        for (auto it = std::begin(range), end = std::end(range); it != end; ++it) {
+            init = op(init, transform(*it));
         }
+        return init;
+    }
+    template<std_container T, typename U, typename BinaryOp>
+    enable_if_not_execution_policy<T, U> reduce(const T &range, U init, const BinaryOp &op) {
+        return transform_reduce_of(range, std::move(init), op, agg::identity {}, is_random_access_iterator<decltype(std::begin(range))> {});
+    }
+    template<std_container T, typename U, typename BinaryOp, typename UnaryOp>
+    U transform_reduce(const T &range, U init, const BinaryOp &op, const UnaryOp &transform) {
+        return transform_reduce_of(range, std::move(init), op, transform, is_random_access_iterator<decltype(std::begin(range))> {});
+    }
 
-        return result;
+    template<typename Policy, typename U, typename T, typename BinaryOp, typename UnaryOp>
+    U transform_reduce_of(const Policy &, const T &range, U init, const BinaryOp &op, const UnaryOp &transform, std::false_type) {
+        return transform_reduce_of(range, std::move(init), op, transform, is_random_access_iterator<decltype(std::begin(range))> {});
     }
-    template<class T, class Pred>
-    constexpr
-            typename std::enable_if<is_bool_predicate<Pred>::value, views::filter_ref_view<const T, Pred>>::type
-            filter(const T &container, const Pred &func) {
-        return views::filter_ref_view<const T, Pred>{container, func};
+    // Chunks are folded in parallel, and their results in order
+    template<typename Policy, typename U, typename T, typename BinaryOp, typename UnaryOp>
+    U transform_reduce_of(const Policy &policy, const T &range, U init, const BinaryOp &op, const UnaryOp &transform, std::true_type) {
+        const auto first = std::begin(range);
+        const parallel_plan plan = plan_reduction(static_cast<std::size_t>(std::end(range) - first), policy.concurrency, policy.deterministic);
+        std::vector<U> partials(plan.chunks, init);
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            partials[chunk] = reduce_block<U>(first + plan.begin(chunk), first + plan.end(chunk), op, transform);
+        });
+        for (const U &partial: partials) {
+            init = op(init, partial);
+        }
+        return init;
     }
-    template<class T, class Pred>
-    constexpr typename std::enable_if<is_bool_predicate<Pred>::value,
-                                      views::filter_view<typename std::decay<T>::type, Pred>>::type
-    filter(T &&container, const Pred &func) {
-        return views::filter_view<typename std::decay<T>::type, Pred>{std::forward<T>(container), func};
+    template<typename Policy, std_container T, typename U, typename BinaryOp>
+    enable_if_execution_policy<Policy, U> reduce(const Policy &policy, const T &range, U init, const BinaryOp &op) {
+        return transform_reduce_of(policy, range, std::move(init), op, agg::identity {}, is_parallel_dispatch<Policy, const T> {});
     }
-    template<typename T, size_t N, typename Pred, class AllocT>
-    constexpr typename std::enable_if<is_bool_predicate<Pred>::value, std::vector<T>>::type
-    filter(const std::array<T, N> &array, const Pred &func) {
-        std::vector<T, AllocT> result(N);
-#if __cplusplus >= 202002L
-        auto [std::ignore, out_it] = std::ranges::copy_if(array, result.begin(), pred);
-        result.resize(std::distance(result.begin(), out_it));
-#elif __cplusplus >= 201304L
-        size_t i{0};
-        for (size_t j{0}; j < N; ++j) {
-            if (func(array.at(j))) {
-                result[i] = array.at(j);
-                ++i;
-            }
+    template<typename Policy, std_container T, typename U, typename BinaryOp, typename UnaryOp>
+    enable_if_execution_policy<Policy, U> transform_reduce(const Policy &policy, const T &range, U init, const BinaryOp &op, const UnaryOp &transform) {
+        return transform_reduce_of(policy, range, std::move(init), op, transform, is_parallel_dispatch<Policy, const T> {});
+    }
+
+    // Left to right; `init` is null for an inclusive scan
+    template<typename U, typename T, typename BinaryOp>
+    std::vector<U> scan_of(const T &range, const U *init, const BinaryOp &op) {
+        std::vector<U> result;
+        auto it = std::begin(range);
+        const auto end = std::end(range);
+        result.reserve(size_or(range, 0, is_random_access_iterator<decltype(it)> {}) + (init != nullptr));
+        if (init != nullptr) {
+            result.push_back(*init);
+        } else if (it != end) {
+            result.push_back(*it);
+            ++it;
         }
-        result.resize(i);
-#else
-        size_t i{0};
-        for (size_t j{0}; j < N; ++j) {
-            if (func(array.at(j)))
-                result[i++] = array.at(j);
+        for (; it != end; ++it) {
+            result.push_back(op(result.back(), *it));
         }
-        result.resize(i);
-#endif
+        if (init != nullptr)
+            result.pop_back();
         return result;
     }
-    template<template<typename...> class T, typename... Args, typename Pred>
-    constexpr views::transform<T<Args...>, Pred> transform(T<Args...> &container, const Pred &pred) {
-        return views::transform<T<Args...>, Pred>{container, pred};
-    }
-    template<template<typename...> class T, typename... Args, typename Pred>
-    constexpr views::transform<const T<Args...>, Pred> transform(const T<Args...> &container, const Pred &pred) {
-        return views::transform<const T<Args...>, Pred>{container, pred};
-    }
-    template<std_container T, std_container U>
-    constexpr views::zip<T, U> zip(T &first, U &second) {
-        if (first.size() != second.size())
-            throw std::runtime_error("Containers cannot have different size.");
-        return views::zip<T, U>{first, second};
+    template<std_container T, typename BinaryOp>
+    enable_if_not_execution_policy<T, std::vector<typename T::value_type>> inclusive_scan(const T &range, const BinaryOp &op) {
+        return scan_of<typename T::value_type>(range, nullptr, op);
     }
-    template<std_container T, std_container U>
-    constexpr views::zip<const T, const U> zip(const T &first, const U &second) {
-        if (first.size() != second.size()) throw std::runtime_error("Containers cannot have different size.");
-        return views::zip<const T, const U>{first, second};
+    template<std_container T, typename U, typename BinaryOp>
+    enable_if_not_execution_policy<T, std::vector<U>> exclusive_scan(const T &range, U init, const BinaryOp &op) {
+        return scan_of(range, &init, op);
     }
-    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
-    constexpr Ta<std::tuple<T1, T2>, N> zip(Ta<T1, N> &first, Ta<T2, N> &second) {
-        Ta<std::tuple<T1, T2>, N> result{};
-        for (std::size_t i{0}; i < N; ++i) {
-            result[i] = std::make_tuple(first[i], second[i]);
-        }
 
-        return result;
+    template<typename Policy, typename U, typename T, typename BinaryOp>
+    std::vector<U> scan_of(const Policy &, const T &range, const U *init, const BinaryOp &op, std::false_type) {
+        return scan_of(range, init, op);
     }
-    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
-    constexpr Ta<std::tuple<T1, T2>, N> zip(const Ta<T1, N> &first, const Ta<T2, N> &second) {
-        Ta<std::tuple<T1, T2>, N> result{};
-        for (std::size_t i{0}; i < N; ++i) {
-            result[i] = std::make_pair(first[i], second[i]);
+    // Two passes: the totals of every chunk but the last one, in parallel, then their running totals in order, which
+    // every chunk continues from in parallel
+    template<typename Policy, typename U, typename T, typename BinaryOp>
+    std::vector<U> scan_of(const Policy &policy, const T &range, const U *init, const BinaryOp &op, std::true_type) {
+        const auto first = std::begin(range);
+        const std::size_t size = static_cast<std::size_t>(std::end(range) - first);
+        if (size == 0)
+            return std::vector<U>();
+        const parallel_plan plan = plan_reduction(size, policy.concurrency, policy.deterministic);
+        // Total of the chunks before each chunk (`init` included), unused for the first one of an inclusive scan
+        std::vector<U> carries(plan.chunks, init != nullptr ? *init : U(*first));
+        thread_pool::instance().parallel_for(plan.chunks - 1, plan.concurrency, [&](std::size_t chunk) {
+            carries[chunk + 1] = reduce_block<U>(first + plan.begin(chunk), first + plan.end(chunk), op, agg::identity {});
+        });
+        for (std::size_t chunk = init != nullptr ? 1 : 2; chunk < plan.chunks; ++chunk) {
+            carries[chunk] = op(carries[chunk - 1], carries[chunk]);
         }
 
+        std::vector<U> result(size);
+        thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+            auto it = first + plan.begin(chunk);
+            const auto end = first + plan.end(chunk);
+            auto out = result.begin() + static_cast<std::ptrdiff_t>(plan.begin(chunk));
+            if (init != nullptr) {
+                U total = carries[chunk];
+                for (; it != end; ++it, ++out) {
+                    *out = total;
+                    total = op(total, *it);
+                }
+                return;
+            }
+            U total = chunk == 0 ? U(*it++) : op(carries[chunk], *it++);
+            *out++ = total;
+            for (; it != end; ++it, ++out) {
+                total = op(total, *it);
+                *out = total;
+            }
+        });
         return result;
     }
-    template<template<typename, std::size_t> class Ta, typename T1, typename T2, std::size_t N>
-    constexpr Ta<std::pair<T1, T2>, N> zip(const Ta<T1, N> &first, const Ta<T2, N> &second) {
-        Ta<std::pair<T1, T2>, N> result{};
-        for (std::size_t i{0}; i < N; ++i) {
-            result[i] = std::make_pair(first[i], second[i]);
+    template<typename Policy, std_container T, typename BinaryOp>
+    enable_if_execution_policy<Policy, std::vector<typename T::value_type>> inclusive_scan(const Policy &policy, const T &range, const BinaryOp &op) {
+        return scan_of<Policy, typename T::value_type>(policy, range, nullptr, op, is_parallel_dispatch<Policy, const T> {});
+    }
+    template<typename Policy, std_container T, typename U, typename BinaryOp>
+    enable_if_execution_policy<Policy, std::vector<U>> exclusive_scan(const Policy &policy, const T &range, U init, const BinaryOp &op) {
+        return scan_of(policy, range, &init, op, is_parallel_dispatch<Policy, const T> {});
+    }
+
+#if RANGED_HAS_MMAP
+    // Sorts a full buffer as a single run
+    template<typename Compare>
+    struct sequential_run_sort {
+        const Compare &cmp;
+
+        template<typename T>
+        std::vector<std::size_t> operator()(std::vector<T> &buffer) const {
+            std::sort(buffer.begin(), buffer.end(), cmp);
+            return std::vector<std::size_t>(1, buffer.size());
         }
+    };
+    // Sorts the chunks of a buffer in parallel, each one becoming a run
+    template<typename Policy, typename Compare>
+    struct parallel_run_sort {
+        const Policy &policy;
+        const Compare &cmp;
+
+        template<typename T>
+        std::vector<std::size_t> operator()(std::vector<T> &buffer) const {
+            const parallel_plan plan = plan_parallel(buffer.size(), policy.concurrency);
+            thread_pool::instance().parallel_for(plan.chunks, plan.concurrency, [&](std::size_t chunk) {
+                std::sort(buffer.begin() + static_cast<std::ptrdiff_t>(plan.begin(chunk)), buffer.begin() + static_cast<std::ptrdiff_t>(plan.end(chunk)), cmp);
+            });
+            std::vector<std::size_t> sizes;
+            for (std::size_t chunk = 0; chunk < plan.chunks; ++chunk) {
+                sizes.push_back(plan.end(chunk) - plan.begin(chunk));
+            }
+            return sizes;
+        }
+    };
 
-        return result;
-    }
-    template<std_container T, class Compare>
-    constexpr typename T::value_type max(const T &container, const Compare &cmp) {
-        if (container.empty())
-            return std::numeric_limits<typename T::value_type>::min();
-        auto it = std::begin(container);
-        typename T::value_type result = *it;
-        const auto end = std::end(container);
+    template<typename T, typename R, typename Compare, typename SortRun>
+    views::external_sort_view<T, Compare> external_sort_runs(const R &range, const Compare &cmp, std::size_t memory_budget,
+                                                             const std::string &temp_dir, const SortRun &sort_run) {
+        typedef typename views::external_sort_view<T, Compare>::run run;
+        const std::size_t capacity = std::max<std::size_t>(1, memory_budget / sizeof(T));
+        std::vector<T> buffer;
+        buffer.reserve(std::min(capacity, size_or(range, capacity, is_random_access_iterator<decltype(std::begin(range))> {})));
+        std::unique_ptr<temporary_file> file;
+        std::vector<run> spilled;
+        // Appends the runs of the sorted buffer, at `offset` elements
+        const auto sorted_runs = [&](std::vector<run> &runs, std::size_t offset) {
+            for (const std::size_t size: sort_run(buffer)) {
+                if (size != 0)
+                    runs.emplace_back(offset, size);
+                offset += size;
+            }
+        };
 
-        for (++it; it != end; ++it) {
-            if (cmp(result, *it))
-                result = *it;
+        for (auto it = std::begin(range), end = std::end(range); it != end; ++it) {
+            buffer.push_back(*it);
+            if (buffer.size() == capacity) {
+                if (!file)
+                    file.reset(new temporary_file(temp_dir));
+                sorted_runs(spilled, file->size() / sizeof(T));
+                file->write(buffer.data(), buffer.size() * sizeof(T));
+                buffer.clear();
+            }
         }
 
-        return result;
+        std::vector<run> resident;
+        sorted_runs(resident, 0);
+        mapped_file spill = file ? mapped_file(file->descriptor(), mapped_file::access::normal) : mapped_file();
+        return views::external_sort_view<T, Compare>(std::move(spill), spilled, std::move(buffer), resident, cmp);
     }
     template<std_container T, typename Compare>
-    constexpr typename T::value_type max(T &container, const Compare &cmp) {
-        if (container.empty())
-            return std::numeric_limits<typename T::value_type>::min();
-        auto it = std::begin(container);
-        typename T::value_type result = *it;
-        const auto end = std::end(container);
+    views::external_sort_view<typename T::value_type, Compare>
+    external_sort(const T &range, const Compare &cmp, std::size_t memory_budget, const std::string &temp_dir) {
+        return external_sort_runs<typename T::value_type>(range, cmp, memory_budget, temp_dir, sequential_run_sort<Compare> {cmp});
+    }
+    template<typename Policy, std_container T, typename Compare>
+    enable_if_execution_policy<Policy, views::external_sort_view<typename T::value_type, Compare>>
+    external_sort(const Policy &policy, const T &range, const Compare &cmp, std::size_t memory_budget, const std::string &temp_dir) {
+        return external_sort_runs<typename T::value_type>(range, cmp, memory_budget, temp_dir, parallel_run_sort<Policy, Compare> {policy, cmp});
+    }
+#endif
 
-        for (++it; it != end; ++it) {
-            if (cmp(result, *it))
-                result = *it;
-        }
+    template<typename T>
+    async_pipeline<pipeline_source<views::stored_range_t<T>>> pipeline(T &&range, const pipeline_options &options) {
+        return {pipeline_source<views::stored_range_t<T>>(views::store_range(std::forward<T>(range))), options};
+    }
 
-        return result;
+    template<typename Map, typename Key, typename Reference, typename AggTuple, std::size_t... Is>
+    void aggregate_element(Map &groups, Key &&key, Reference &&element, const AggTuple &aggregators, index_sequence<Is...>) {
+        typedef typename Map::mapped_type state_type;
+        const auto inserted = groups.lazy_emplace(std::forward<Key>(key), [&] { return state_type(std::get<Is>(aggregators).start(element)...); });
+        if (!inserted.second) {
+            int swallow[] = {0, (std::get<Is>(aggregators).add(std::get<Is>(inserted.first->second), element), 0)...};
+            (void) swallow;
+        }
     }
-    template<std_container T, typename Compare>
-    constexpr typename T::value_type min(const T &container, const Compare &cmp) {
-        if (container.empty())
-            return std::numeric_limits<typename T::value_type>::max();
-        auto it = std::begin(container);
-        typename T::value_type result = *it;
-        const auto end = std::end(container);
 
-        for (++it; it != end; ++it) {
-            if (cmp(result, *it))
-                result = *it;
+    template<typename Map, typename State, typename AggTuple, std::size_t... Is>
+    void merge_states(Map &groups, typename Map::value_type &&entry, const AggTuple &aggregators, index_sequence<Is...>) {
+        State &other = entry.second;
+        const auto inserted = groups.lazy_emplace(std::move(entry.first), [&] { return std::move(other); });
+        if (!inserted.second) {
+            int swallow[] = {0, (std::get<Is>(aggregators).merge(std::get<Is>(inserted.first->second), std::get<Is>(other)), 0)...};
+            (void) swallow;
         }
+    }
 
-        return result;
+    template<typename Result, typename StateMap, typename AggTuple, std::size_t... Is>
+    void finish_groups(Result &result, StateMap &groups, const AggTuple &aggregators, index_sequence<Is...>) {
+        typedef typename Result::mapped_type mapped_type;
+        for (auto &entry: groups) {
+            result.lazy_emplace(std::move(entry.first), [&] { return mapped_type(std::get<Is>(aggregators).finish(std::move(std::get<Is>(entry.second)))...); });
+        }
     }
-    template<std_container T, typename Compare>
-    constexpr typename T::value_type min(T &container, const Compare &cmp) {
-        if (container.empty())
-            return std::numeric_limits<typename T::value_type>::max();
-        auto it = std::begin(container);
-        typename T::value_type result = *it;
-        const auto end = std::end(container);
 
-        for (++it; it != end; ++it) {
-            if (cmp(result, *it))
-                result = *it;
+    template<typename Aggregation, typename T, typename KeyFn, typename... Aggs>
+    typename Aggregation::result_map aggregate_groups(const T &range, const KeyFn &key, const Aggs &... aggregators) {
+        const std::tuple<const Aggs &...> aggs(aggregators...);
+        typename Aggregation::state_map groups;
+        for (auto &&element: range) {
+            aggregate_element(groups, key(element), element, aggs, make_index_sequence<sizeof...(Aggs)> {});
         }
 
+        typename Aggregation::result_map result(groups.size());
+        finish_groups(result, groups, aggs, make_index_sequence<sizeof...(Aggs)> {});
         return result;
     }
-#if __cplusplus >= 201703L
-    template<class T, class Inserter, typename... Args>
-    constexpr void emplace_range(T &container, Args &&...args) {
-        static_assert(_decl::has_emplace_back<std::decay_t<T>>::value && !std::is_const_v<T>);
-        (container.emplace_back(std::forward<Args>(args)), ...);
+    template<std_container T, typename KeyFn, typename Agg, typename... Aggs>
+    aggregate_result_t<T, KeyFn, Agg, Aggs...> aggregate_by(const T &range, const KeyFn &key, const Agg &aggregator, const Aggs &... aggregators) {
+        return aggregate_groups<aggregation<T, KeyFn, Agg, Aggs...>>(range, key, aggregator, aggregators...);
     }
-#endif
-    template<class T, class Inserter, typename Range>
-    constexpr void emplace_range(T &container, Range &&range) {
-        static_assert(!std::is_const<T>::value, "Container cannot be const.");
-        std::copy(std::begin(std::forward<Range>(range)), std::end(std::forward<Range>(range)), Inserter{container});
+    template<std_container T, typename KeyFn>
+    aggregate_result_t<T, KeyFn, agg::collect_aggregator> group_by(const T &range, const KeyFn &key) {
+        return aggregate_by(range, key, agg::collect());
     }
 
-    template<class T, class Inserter>
-    constexpr void emplace_range(T &container, std::initializer_list<typename T::value_type> list) {
-        std::copy(list.begin(), list.end(), Inserter(container));
+    template<typename Aggregation, typename Policy, typename T, typename KeyFn, typename... Aggs>
+    typename Aggregation::result_map aggregate_groups(const Policy &, const T &range, const KeyFn &key, std::false_type, const Aggs &... aggregators) {
+        return aggregate_groups<Aggregation>(range, key, aggregators...);
+    }
+    template<typename Aggregation, typename Policy, typename T, typename KeyFn, typename... Aggs>
+    typename Aggregation::result_map aggregate_groups(const Policy &policy, const T &range, const KeyFn &key, std::true_type, const Aggs &... aggregators) {
+        typedef typename Aggregation::key_type key_type;
+        typedef typename Aggregation::state_map state_map;
+        const auto first = std::begin(range);
+        const std::size_t size = static_cast<std::size_t>(std::end(range) - first);
+        const std::size_t concurrency = policy.concurrency != 0 ? policy.concurrency : thread_pool::instance().concurrency();
+        // Unlike the other algorithms, one chunk per thread: every chunk costs a set of tables
+        const std::size_t chunks = std::max<std::size_t>(1, std::min(size / parallel_min_chunk, concurrency));
+        if (chunks == 1)
+            return aggregate_groups<Aggregation>(range, key, aggregators...);
+
+        const std::tuple<const Aggs &...> aggs(aggregators...);
+        const std::size_t chunk_size = (size + chunks - 1) / chunks;
+        const std::size_t partitions = chunks;
+        const hash<key_type> hasher {};
+        // `tables[chunk * partitions + partition]`; the tables of the first chunk receive the merged partitions
+        std::vector<state_map> tables(chunks * partitions);
+        thread_pool::instance().parallel_for(chunks, concurrency, [&](std::size_t chunk) {
+            const auto end = first + static_cast<std::ptrdiff_t>(std::min(size, (chunk + 1) * chunk_size));
+            for (auto it = first + static_cast<std::ptrdiff_t>(chunk * chunk_size); it != end; ++it) {
+                auto &&element = *it;
+                key_type group = key(element);
+                // The middle bits of the mixed hash, as `flat_hash_map` picks slots with the top ones
+                const std::size_t partition = static_cast<std::size_t>(
+                    (static_cast<std::uint64_t>(hasher(group)) * 0x9e3779b97f4a7c15ull) >> 16 & 0xffff) % partitions;
+                aggregate_element(tables[chunk * partitions + partition], std::move(group), element, aggs, make_index_sequence<sizeof...(Aggs)> {});
+            }
+        });
+        thread_pool::instance().parallel_for(partitions, concurrency, [&](std::size_t partition) {
+            state_map &target = tables[partition];
+            for (std::size_t chunk{1}; chunk < chunks; ++chunk) {
+                state_map &source = tables[chunk * partitions + partition];
+                target.reserve(target.size() + source.size());
+                for (auto &entry: source) {
+                    merge_states<state_map, typename Aggregation::state_type>(target, std::move(entry), aggs, make_index_sequence<sizeof...(Aggs)> {});
+                }
+                source = state_map();
+            }
+        });
+
+        std::size_t groups = 0;
+        for (std::size_t partition{0}; partition < partitions; ++partition) {
+            groups += tables[partition].size();
+        }
+        typename Aggregation::result_map result(groups);
+        for (std::size_t partition{0}; partition < partitions; ++partition) {
+            finish_groups(result, tables[partition], aggs, make_index_sequence<sizeof...(Aggs)> {});
+        }
+        return result;
+    }
+    template<typename Policy, std_container T, typename KeyFn, typename Agg, typename... Aggs>
+    parallel_aggregate_result_t<Policy, T, KeyFn, Agg, Aggs...>
+    aggregate_by(const Policy &policy, const T &range, const KeyFn &key, const Agg &aggregator, const Aggs &... aggregators) {
+        return aggregate_groups<aggregation<T, KeyFn, Agg, Aggs...>>(policy, range, key, is_parallel_dispatch<Policy, const T> {}, aggregator, aggregators...);
+    }
+    template<typename Policy, std_container T, typename KeyFn>
+    parallel_aggregate_result_t<Policy, T, KeyFn, agg::collect_aggregator> group_by(const Policy &policy, const T &range, const KeyFn &key) {
+        return aggregate_by(policy, range, key, agg::collect());
     }
 
 #endif
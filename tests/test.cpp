@@ -2,6 +2,7 @@
 // Created by mmatz on 9/4/25.
 //
 #include <cassert>
+#include <cctype>
 #include <deque>
 #include <array>
 #include <list>
@@ -10,6 +11,10 @@
 #include <map>
 #include <unordered_map>
 #include <string>
+#include <numeric>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 
 #include "globals.h"
 #define RANGED_IMPLEMENTATION
@@ -90,6 +95,50 @@ TEST(vector, filter_test) {
     assert(result == expected);
 }
 
+TEST(vector, filter_lvalue_test) {
+    std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    auto filtered = ranged::filter(v, [](const int &i) { return i > 5; });
+    static_assert(ranged::is_specialization_of<decltype(filtered), ranged::views::filter_ref_view>::value,
+                  "lvalue ranges must be referenced, not moved into the view");
+    assert(v.size() == 10);
+    v[0] = 42;
+    assert(ranged::to<std::vector>(filtered) == (std::vector<int>{42, 6, 7, 8, 9, 10}));
+}
+
+TEST(vector, filter_stateless_predicate_test) {
+    std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const auto pred = [](const int &i) { return i % 2 == 0; };
+#if !RANGED_TYPE_ERASED_CALLABLES
+    using view_t = ranged::views::filter_view<std::vector<int>, decltype(pred)>;
+    using iterator_t = ranged::views::filter_iterator<std::vector<int>::iterator, decltype(pred)>;
+    using pointer_iterator_t = ranged::views::filter_iterator<std::vector<int>::iterator, bool (*)(const int &)>;
+    static_assert(sizeof(view_t) == sizeof(std::vector<int>), "stateless predicate must not add storage");
+    static_assert(sizeof(iterator_t) == 2 * sizeof(std::vector<int>::iterator), "stateless predicate must not add storage");
+    static_assert(std::is_copy_assignable<iterator_t>::value, "iterator must be copy assignable");
+#if __cplusplus >= 202002L
+    // Captureless closures are copy assignable since c++20, so nothing has to be re-constructed on assignment
+    static_assert(std::is_trivially_copyable<iterator_t>::value, "iterator must be trivially copyable");
+#endif
+    static_assert(std::is_trivially_copyable<pointer_iterator_t>::value, "iterator must be trivially copyable");
+#endif
+
+    const auto result = ranged::to<std::vector>(ranged::filter(std::move(v), pred));
+    assert(result == (std::vector<int>{2, 4, 6, 8, 10}));
+}
+
+TEST(vector, filter_capturing_predicate_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const int threshold = 7;
+    const auto filtered = ranged::filter(v, [threshold](const int &i) { return i > threshold; });
+#if !RANGED_TYPE_ERASED_CALLABLES
+    static_assert(std::is_copy_assignable<decltype(filtered.begin())>::value, "iterator must be copy assignable");
+#endif
+    auto it = filtered.begin();
+    it = filtered.end();
+    assert(it == filtered.end());
+    assert(ranged::to<std::vector>(filtered) == (std::vector<int>{8, 9, 10}));
+}
+
 TEST(vector, select_test) {
     const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
     const std::vector<std::string> expected = {"1", "2", "3", "4", "5", "6", "7", "8", "9", "10"};
@@ -107,6 +156,798 @@ TEST(vector, zip_test) {
     assert(std::get<0>(result[4]) == 5 && std::get<1>(result[4]) == 50);
 }
 
+TEST(vector, zip_sort_test) {
+    std::vector<int> keys = {5, 3, 1, 4, 2};
+    std::vector<std::string> values = {"e", "c", "a", "d", "b"};
+    auto zipped = ranged::zip(keys, values);
+    static_assert(std::is_same<decltype(zipped)::iterator::iterator_category, std::random_access_iterator_tag>::value,
+                  "zip over vectors must be random access");
+    std::sort(zipped.begin(), zipped.end());
+    assert(keys == (std::vector<int>{1, 2, 3, 4, 5}));
+    assert(values == (std::vector<std::string>{"a", "b", "c", "d", "e"}));
+}
+
+TEST(vector, zip_variadic_test) {
+    std::vector<int> ids = {3, 1, 2};
+    std::vector<double> prices = {3.5, 1.5, 2.5};
+    std::vector<std::string> names = {"c", "a", "b"};
+    auto zipped = ranged::zip(ids, prices, names);
+    assert(zipped.size() == 3);
+    assert(std::get<2>(zipped.begin()[1]) == "a");
+    std::sort(zipped.begin(), zipped.end());
+    assert(ids == (std::vector<int>{1, 2, 3}));
+    assert(prices == (std::vector<double>{1.5, 2.5, 3.5}));
+    assert(names == (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(vector, zip_shortest_test) {
+    const std::vector<int> v1 = {1, 2, 3, 4, 5};
+    const std::vector<int> v2 = {10, 20, 30};
+    const std::list<char> l = {'a', 'b', 'c', 'd'};
+    const auto zipped = ranged::zip(v1, v2);
+    assert(zipped.size() == 3);
+    assert(std::get<0>(*(zipped.end() - 1)) == 3);
+
+    const auto mixed = ranged::zip(v1, l, v2);
+    static_assert(std::is_same<decltype(mixed)::iterator::iterator_category, std::forward_iterator_tag>::value,
+                  "zip with a list must be a forward range");
+    const auto result = ranged::to<std::vector>(mixed);
+    assert(result.size() == 3);
+    assert(result.back() == std::make_tuple(3, 'c', 30));
+
+    // Without random access the end is never walked to: iteration stops where the shortest range runs out
+    const std::list<char> letters = {'a', 'b', 'c', 'd'};
+    const auto pairs = ranged::zip(v1, letters);
+    assert(ranged::to<std::vector>(pairs) == (std::vector<std::tuple<int, char>>{
+        std::make_tuple(1, 'a'), std::make_tuple(2, 'b'), std::make_tuple(3, 'c'), std::make_tuple(4, 'd')}));
+    assert(std::distance(pairs.begin(), pairs.end()) == 4 && std::next(pairs.begin()) != pairs.begin());
+
+    bool thrown = false;
+    try {
+        ranged::zip(ranged::strict, v1, l, v2);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(ranged::zip(ranged::strict, v2, v2, v2).size() == 3);
+}
+
+TEST(vector, to_soa_test) {
+    const std::vector<int> ids = {1, 2, 3, 4};
+    const std::vector<std::string> names = {"a", "b", "c"};
+    const auto columns = ranged::to_soa(ranged::zip(ids, names));
+    assert(std::get<0>(columns) == (std::vector<int>{1, 2, 3}));
+    assert(std::get<1>(columns) == (std::vector<std::string>{"a", "b", "c"}));
+
+    const std::list<int> l = {7, 8};
+    const auto from_list = ranged::to_soa(ranged::zip(l, ids));
+    assert(std::get<0>(from_list) == (std::vector<int>{7, 8}));
+    assert(std::get<1>(from_list) == (std::vector<int>{1, 2}));
+
+    const std::vector<std::pair<int, char>> rows = {{1, 'x'}, {2, 'y'}};
+    const auto pairs = ranged::to_soa(rows);
+    assert(std::get<0>(pairs) == (std::vector<int>{1, 2}));
+    assert(std::get<1>(pairs) == (std::vector<char>{'x', 'y'}));
+
+    std::deque<int> first;
+    std::vector<std::string> second;
+    ranged::unzip(ranged::zip(ids, names), first, second);
+    assert(first == (std::deque<int>{1, 2, 3}));
+    assert(second == names);
+}
+
+TEST(vector, select_random_access_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const auto squares = ranged::transform(v, [](const int &i) { return i * i; });
+    assert(std::distance(squares.begin(), squares.end()) == 10);
+    assert(squares.begin()[3] == 16);
+    assert(*std::lower_bound(squares.begin(), squares.end(), 50) == 64);
+}
+
+TEST(vector, pipe_filter_transform_test) {
+    std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const auto result = ranged::to<std::vector>(v | ranged::filter([](const int &i) { return i % 2 == 0; })
+                                                  | ranged::transform([](const int &i) { return std::to_string(i * i); }));
+    assert(result == (std::vector<std::string>{"4", "16", "36", "64", "100"}));
+    // Lvalue ranges are referenced, not moved into the view
+    assert(v.size() == 10);
+}
+
+TEST(vector, pipe_fusion_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    auto even = [](const int &i) { return i % 2 == 0; };
+    auto big = [](const int &i) { return i > 4; };
+    auto twice = [](const int &i) { return i * 2; };
+    auto inc = [](const int &i) { return i + 1; };
+
+    const auto filtered = v | ranged::filter(even) | ranged::filter(big);
+    const auto transformed = v | ranged::transform(twice) | ranged::transform(inc);
+#if !RANGED_TYPE_ERASED_CALLABLES
+    static_assert(std::is_same<decltype(filtered),
+                  const ranged::views::filter_ref_view<const std::vector<int>, ranged::fused_predicate<decltype(even), decltype(big)>>>::value,
+                  "adjacent filters must fuse into one view");
+    static_assert(std::is_same<decltype(transformed),
+                  const ranged::views::transform_view<ranged::views::ref_view<const std::vector<int>>, ranged::composed_function<decltype(twice), decltype(inc)>>>::value,
+                  "adjacent transforms must fuse into one view");
+    // Stateless callables are empty bases of the fused ones
+    static_assert(std::is_empty<ranged::fused_predicate<decltype(even), decltype(big)>>::value, "stateless predicates must fuse into an empty one");
+    static_assert(std::is_empty<ranged::composed_function<decltype(twice), decltype(inc)>>::value, "stateless functions must compose into an empty one");
+    static_assert(std::is_copy_assignable<decltype(filtered.begin())>::value, "fused filter iterators must be copy assignable");
+#if __cplusplus >= 202002L
+    static_assert(std::is_trivially_copyable<decltype(filtered.begin())>::value, "fused filter iterators must stay trivially copyable");
+#endif
+#endif
+    assert(ranged::to<std::vector>(filtered) == (std::vector<int>{6, 8, 10}));
+    assert(transformed.size() == 10);
+    assert(ranged::to<std::vector>(transformed) == (std::vector<int>{3, 5, 7, 9, 11, 13, 15, 17, 19, 21}));
+}
+
+#if __cplusplus >= 201402L && !RANGED_TYPE_ERASED_CALLABLES
+TEST(vector, pipe_generic_fusion_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    auto twice = [](auto i) { return i * 2; };
+    auto inc = [](const int &i) { return i + 1; };
+
+    // Generic callables have no signature to fuse on, in either position
+    const auto transformed = v | ranged::transform(twice) | ranged::transform(inc) | ranged::transform([](auto i) { return i * 10; });
+    assert(ranged::to<std::vector>(transformed) == (std::vector<int>{30, 50, 70, 90, 110, 130, 150, 170, 190, 210}));
+
+    const auto filtered = v | ranged::filter([](const auto &i) { return i % 2 == 0; }) | ranged::filter([](const int &i) { return i > 4; })
+                          | ranged::filter([](auto i) { return i != 8; });
+    static_assert(ranged::is_specialization_of<typename std::decay<decltype(filtered)>::type, ranged::views::filter_ref_view>::value,
+                  "generic filters must still fuse into one view");
+    assert(ranged::to<std::vector>(filtered) == (std::vector<int>{6, 10}));
+}
+#endif
+
+TEST(vector, pipe_rvalue_test) {
+    const auto big = [](const int &i) { return i > 3; };
+    auto filtered = std::vector<int> {1, 2, 3, 4, 5, 6} | ranged::filter([](const int &i) { return i % 2 == 0; }) | ranged::filter(big);
+    static_assert(ranged::is_specialization_of<decltype(filtered), ranged::views::filter_view>::value,
+                  "rvalue ranges must be owned by the view");
+    assert(ranged::to<std::vector>(filtered) == (std::vector<int>{4, 6}));
+
+    const auto squares = std::move(filtered) | ranged::transform([](const int &i) { return i * i; });
+    assert(ranged::to<std::vector>(squares) == (std::vector<int>{16, 36}));
+}
+
+TEST(vector, pipe_adaptor_composition_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const auto pipeline = ranged::filter([](const int &i) { return i % 3 == 0; })
+                          | ranged::transform([](const int &i) { return i * 10; })
+                          | ranged::filter([](const int &i) { return i != 60; });
+    assert(ranged::to<std::vector>(v | pipeline) == (std::vector<int>{30, 90}));
+    assert(ranged::count_if(v | pipeline, [](const int &i) { return i > 50; }) == 1);
+}
+
+TEST(vector, selection_filter_test) {
+    std::vector<int> v(200);
+    std::iota(v.begin(), v.end(), 0);
+    const auto multiple_of_three = [](const int &i) { return i % 3 == 0; };
+    const auto selected = ranged::filter(ranged::selection, v, multiple_of_three);
+    assert(selected.size() == 67);
+    assert(selected.mask().size() == 4);
+    const std::vector<int> &values = v;
+    assert(ranged::to<std::vector>(selected) == ranged::to<std::vector>(ranged::filter(values, multiple_of_three)));
+    assert(ranged::count_if(selected, [](const int &i) { return i > 100; }) == 33);
+
+    auto writable = ranged::filter(ranged::selection, v, [](const int &i) { return i >= 190; });
+    for (int &i: writable) {
+        i = -i;
+    }
+    assert(v[189] == 189 && v[190] == -190 && v[199] == -199);
+
+    const auto doubled = ranged::to<std::vector>(v | ranged::filter(ranged::selection, [](const int &i) { return i < 0; })
+                                                   | ranged::transform([](const int &i) { return i * 2; }));
+    assert(doubled.size() == 10 && doubled.front() == -380);
+
+    const std::vector<int> empty;
+    const auto none = ranged::filter(ranged::selection, empty, multiple_of_three);
+    assert(none.empty() && none.begin() == none.end());
+}
+
+TEST(vector, chunk_test) {
+    std::vector<int> v = {1, 2, 3, 4, 5, 6, 7};
+    auto chunks = ranged::chunk(v, 3);
+    static_assert(std::is_same<decltype(chunks)::value_type, ranged::span<int>>::value, "vector chunks must be spans");
+    static_assert(std::is_same<decltype(chunks)::iterator::iterator_category, std::random_access_iterator_tag>::value,
+                  "vector chunks must be random access");
+    assert(chunks.size() == 3);
+    assert(chunks.begin()[2].size() == 1 && chunks.begin()[2][0] == 7);
+    assert(chunks.begin()[1].data() == v.data() + 3);
+    for (const auto chunk: chunks) {
+        for (int &x: chunk) {
+            x *= 10;
+        }
+    }
+    assert(v == (std::vector<int>{10, 20, 30, 40, 50, 60, 70}));
+
+    // The callable of a transform over chunks receives a whole chunk
+    const auto sums = ranged::to<std::vector>(v | ranged::chunk(2) | ranged::transform([](ranged::span<const int> chunk) {
+        return std::accumulate(chunk.begin(), chunk.end(), 0);
+    }));
+    assert(sums == (std::vector<int>{30, 70, 110, 70}));
+    assert(ranged::chunk(std::vector<int>{}, 4).size() == 0);
+
+    bool thrown = false;
+    try {
+        ranged::chunk(v, 0);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+TEST(vector, chunk_filter_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const auto chunks = v | ranged::filter([](const int &i) { return i % 2 == 0; }) | ranged::chunk(3);
+    static_assert(std::is_same<decltype(chunks)::value_type, ranged::span<const int>>::value, "filter chunks must be buffered");
+    std::vector<std::vector<int>> result;
+    for (const auto chunk: chunks) {
+        result.emplace_back(chunk.begin(), chunk.end());
+    }
+    assert(result == (std::vector<std::vector<int>>{{2, 4, 6}, {8, 10}}));
+}
+
+TEST(vector, to_with_allocator_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6};
+    ranged::monotonic_arena arena;
+    const auto copy = ranged::to<std::vector>(v, ranged::arena_allocator<int>(arena));
+    static_assert(std::is_same<decltype(copy), const std::vector<int, ranged::arena_allocator<int>>>::value, "allocator must be used");
+    assert(copy.size() == 6 && std::equal(copy.begin(), copy.end(), v.begin()));
+    assert(arena.used() == 6 * sizeof(int));
+
+    // The allocator is rebound to the element type of the result
+    const auto evens = ranged::to<std::list>(ranged::filter(v, [](const int &i) { return i % 2 == 0; }), ranged::arena_allocator<char>(arena));
+    assert(evens.size() == 3 && evens.back() == 6);
+    const auto ordered = ranged::to<std::set>(v, ranged::arena_allocator<char>(arena));
+    assert(ordered.size() == 6 && *ordered.begin() == 1);
+    const std::vector<std::pair<int, std::string>> pairs = {{1, "a"}, {2, "b"}};
+    const auto map = ranged::to<std::map>(pairs, ranged::arena_allocator<char>(arena));
+    assert(map.at(2) == "b");
+    const auto hashed = ranged::to<std::unordered_map>(pairs, ranged::arena_allocator<char>(arena));
+    assert(hashed.at(1) == "a");
+
+    const auto columns = ranged::to_soa(ranged::zip(v, v), ranged::arena_allocator<char>(arena));
+    assert(std::get<1>(columns).size() == 6 && std::get<1>(columns).get_allocator().arena() == &arena);
+}
+
+TEST(vector, monotonic_arena_test) {
+    alignas(std::max_align_t) char buffer[64];
+    ranged::monotonic_arena arena(buffer, sizeof(buffer));
+    void *first = arena.allocate(3, 1);
+    void *second = arena.allocate(8, 8);
+    assert(first == buffer);
+    assert(static_cast<char *>(second) == buffer + 8);
+    // Past the buffer, memory comes from heap blocks
+    void *large = arena.allocate(1000, 64);
+    assert(reinterpret_cast<std::uintptr_t>(large) % 64 == 0);
+    assert(static_cast<char *>(large) < buffer || static_cast<char *>(large) >= buffer + sizeof(buffer));
+    std::memset(large, 0, 1000);
+    assert(arena.used() == 1011);
+
+    arena.reset();
+    assert(arena.used() == 0);
+    // The last block is reused after a reset
+    assert(arena.allocate(1000, 64) == large);
+
+    // Padding reaching past the end of the buffer moves on to a block
+    alignas(128) char small[64];
+    ranged::monotonic_arena padded(small, sizeof(small));
+    padded.allocate(40, 1);
+    char *over = static_cast<char *>(padded.allocate(8, 128));
+    assert(reinterpret_cast<std::uintptr_t>(over) % 128 == 0 && (over < small || over >= small + sizeof(small)));
+    std::memset(over, 0, 8);
+}
+
+TEST(vector, aggregate_by_test) {
+    const std::vector<int> v = {5, 1, 4, 2, 3, 6, 9};
+    const auto parity = [](const int &x) { return x % 2; };
+    const auto stats = ranged::aggregate_by(v, parity, ranged::agg::count(), ranged::agg::sum(), ranged::agg::min(), ranged::agg::max(),
+                                            ranged::agg::mean());
+    assert(stats.size() == 2);
+    // Groups are in order of first appearance
+    assert(stats.begin()->first == 1);
+    assert(stats.at(1) == std::make_tuple(std::size_t {4}, 18, 1, 9, 4.5));
+    assert(stats.at(0) == std::make_tuple(std::size_t {3}, 12, 2, 6, 4.0));
+
+    const auto squares = ranged::aggregate_by(v, parity, ranged::agg::sum([](const int &x) { return static_cast<long long>(x) * x; }));
+    static_assert(std::is_same<decltype(squares.at(0)), const long long &>::value, "a single aggregator is not wrapped in a tuple");
+    assert(squares.at(0) == 56);
+    const auto joined = ranged::aggregate_by(v, parity, ranged::agg::fold(std::string(), [](std::string s, const int &x) {
+        return s + std::to_string(x);
+    }, std::plus<std::string>()));
+    assert(joined.at(1) == "5139");
+
+    const auto groups = ranged::group_by(v, [](const int &x) { return x > 3; });
+    assert(groups.at(true) == (std::vector<int>{5, 4, 6, 9}));
+    assert(groups.at(false) == (std::vector<int>{1, 2, 3}));
+    assert(ranged::group_by(std::vector<int>{}, parity).empty());
+}
+
+TEST(vector, flat_hash_map_test) {
+    ranged::flat_hash_map<std::string, int> map;
+    for (int i = 0; i < 1000; ++i) {
+        map[std::to_string(i % 300)] += i;
+    }
+    assert(map.size() == 300);
+    assert(map.at("7") == 7 + 307 + 607 + 907);
+    assert(map.find("300") == map.end() && !map.contains("300"));
+    assert(!map.try_emplace("7", 0).second && map.try_emplace("x", 1).second);
+    bool thrown = false;
+    try {
+        map.at("y");
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown);
+    // Entries are kept in insertion order
+    assert(map.begin()->first == "0" && (map.end() - 1)->first == "x");
+}
+
+TEST(vector, hash_join_test) {
+    const std::vector<std::pair<int, std::string>> customers = {{1, "ann"}, {2, "bob"}, {3, "cyd"}, {2, "bea"}};
+    const std::vector<std::pair<int, int>> orders = {{10, 2}, {11, 4}, {12, 1}, {13, 2}};
+    const auto customer_id = [](const std::pair<int, std::string> &c) { return c.first; };
+    const auto order_customer = [](const std::pair<int, int> &o) { return o.second; };
+
+    std::vector<std::pair<int, std::string>> rows;
+    for (const auto &row: ranged::hash_join(customers, orders, customer_id, order_customer)) {
+        rows.emplace_back(std::get<1>(row).first, std::get<0>(row).second);
+    }
+    // Probe order, then build order among equal keys
+    assert(rows == (std::vector<std::pair<int, std::string>>{{10, "bob"}, {10, "bea"}, {12, "ann"}, {13, "bob"}, {13, "bea"}}));
+
+    std::vector<int> unmatched;
+    for (const auto &row: ranged::hash_join(ranged::left_join, customers, orders, customer_id, order_customer)) {
+        if (std::get<0>(row) == nullptr)
+            unmatched.push_back(std::get<1>(row).first);
+    }
+    assert(unmatched == std::vector<int>{11});
+    const auto order_id = [](const std::pair<int, int> &o) { return o.first; };
+    const auto with_customer = ranged::to<std::vector>(
+        ranged::hash_join(ranged::semi_join, customers, orders, customer_id, order_customer) | ranged::transform(order_id));
+    assert(with_customer == (std::vector<int>{10, 12, 13}));
+    const auto without_customer = ranged::to<std::vector>(
+        ranged::hash_join(ranged::anti_join, customers, orders, customer_id, order_customer) | ranged::transform(order_id));
+    assert(without_customer == std::vector<int>{11});
+
+    // The probe side may be a temporary view, which the join keeps
+    const auto recent = ranged::hash_join(customers, ranged::filter(orders, [](const std::pair<int, int> &o) { return o.first >= 12; }),
+                                          customer_id, order_customer);
+    assert(std::distance(recent.begin(), recent.end()) == 3);
+    const auto nothing = ranged::hash_join(customers, std::vector<std::pair<int, int>>{}, customer_id, order_customer);
+    assert(nothing.begin() == nothing.end() && nothing.key_count() == 3);
+
+    // Only the build side is indexed, so a small dimension table joins a large, unsized stream of facts
+    std::vector<std::pair<int, int>> facts;
+    for (int i = 0; i < 10000; ++i) {
+        facts.emplace_back(i, i % 5);
+    }
+    const auto known = ranged::hash_join(customers, facts | ranged::filter([](const std::pair<int, int> &o) { return o.second != 0; }),
+                                         customer_id, order_customer);
+    assert(known.key_count() == 3);
+    std::size_t joined = 0;
+    for (const auto &row: known) {
+        assert(std::get<0>(row).first == std::get<1>(row).second);
+        ++joined;
+    }
+    // Keys 1 and 3 match one customer, key 2 matches two
+    assert(joined == 2000 + 2 * 2000 + 2000);
+}
+
+TEST(vector, merge_join_test) {
+    const std::vector<int> build = {1, 2, 2, 4, 6, 6};
+    const std::vector<int> probe = {0, 2, 2, 3, 6, 7};
+    const auto key = [](const int &x) { return x; };
+
+    std::vector<std::pair<int, int>> rows;
+    for (const auto &row: ranged::merge_join(build, probe, key, key)) {
+        rows.emplace_back(std::get<0>(row), std::get<1>(row));
+    }
+    assert(rows == (std::vector<std::pair<int, int>>{{2, 2}, {2, 2}, {2, 2}, {2, 2}, {6, 6}, {6, 6}}));
+    std::size_t left_rows = 0, unmatched = 0;
+    for (const auto &row: ranged::merge_join(ranged::left_join, build, probe, key, key)) {
+        ++left_rows;
+        unmatched += std::get<0>(row) == nullptr;
+    }
+    assert(left_rows == 9 && unmatched == 3);
+    assert(ranged::to<std::vector>(ranged::merge_join(ranged::semi_join, build, probe, key, key)) == (std::vector<int>{2, 2, 6}));
+    assert(ranged::to<std::vector>(ranged::merge_join(ranged::anti_join, build, probe, key, key)) == (std::vector<int>{0, 3, 7}));
+
+    // Descending inputs with their own order, and the same rows as the hash join
+    const std::vector<int> descending(build.rbegin(), build.rend());
+    const std::vector<int> probe_descending(probe.rbegin(), probe.rend());
+    const auto merged = ranged::merge_join(descending, probe_descending, key, key, std::greater<int>());
+    const auto hashed = ranged::hash_join(descending, probe_descending, key, key);
+    assert(std::distance(merged.begin(), merged.end()) == std::distance(hashed.begin(), hashed.end()));
+}
+
+TEST(vector, transform_cached_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::size_t calls = 0;
+    const auto to_string = [&calls](const int &i) { ++calls; return std::to_string(i); };
+
+    const auto cached = ranged::transform_cached(v, to_string);
+    assert(ranged::count_if(cached, [](const std::string &s) { return s.size() == 1; }) == 9);
+    const auto strings = ranged::to<std::vector>(cached);
+    assert(strings == (std::vector<std::string>{"1", "2", "3", "4", "5", "6", "7", "8", "9", "10"}));
+    assert(&*cached.begin() == &*cached.begin() && cached.begin()[9] == "10" && cached.size() == 10);
+    assert(calls == 10);
+
+    // Past the capacity, elements are computed on every dereference
+    calls = 0;
+    const auto capped = v | ranged::transform_cached(to_string, 4);
+    assert(std::distance(capped.begin(), capped.end()) == 10 && calls == 0);
+    for (int pass = 0; pass < 2; ++pass) {
+        assert(ranged::to<std::vector>(capped) == strings);
+    }
+    assert(calls == 4 + 2 * 6);
+    // and are returned by value, so the capped view is an input range
+    static_assert(std::is_same<decltype(capped)::reference, std::string>::value, "capped elements must be values");
+    static_assert(std::is_same<decltype(capped)::iterator::iterator_category, std::input_iterator_tag>::value,
+                  "a capped cache must make an input range");
+    auto it = std::next(capped.begin(), 8);
+    const std::string ninth = *it++;
+    assert(ninth == "9" && *it == "10");
+
+    // Memoizing a plain transform, and an element never dereferenced is never computed
+    calls = 0;
+    auto memoized = ranged::memoize(ranged::transform(v, to_string));
+    assert(*std::next(memoized.begin(), 3) == "4" && *std::next(memoized.begin(), 3) == "4" && calls == 1);
+}
+
+TEST(vector, top_k_test) {
+    const std::vector<int> v = {5, 1, 9, 3, 7, 9, 2, 8};
+    assert(ranged::top_k(v, 3) == (std::vector<int>{9, 9, 8}));
+    assert(ranged::top_k(v, 2, std::greater<int>()) == (std::vector<int>{1, 2}));
+    assert(ranged::top_k(v, 0).empty() && ranged::top_k(v, 100).size() == v.size());
+    assert(ranged::top_k(std::vector<int>{}, 3).empty());
+
+    // Lazy views are streamed through the heap
+    const auto odd = ranged::filter(v, [](const int &x) { return x % 2 == 1; });
+    assert(ranged::top_k(odd, 2) == (std::vector<int>{9, 9}));
+    const auto negated = ranged::transform(v, [](const int &x) { return -x; });
+    assert(ranged::top_k(negated, 1) == std::vector<int>{-1});
+
+    // Equivalent elements are kept and ordered by position
+    const std::vector<std::pair<int, char>> ties = {{1, 'a'}, {2, 'b'}, {1, 'c'}, {2, 'd'}, {2, 'e'}};
+    const auto by_key = [](const std::pair<int, char> &lhs, const std::pair<int, char> &rhs) { return lhs.first < rhs.first; };
+    assert(ranged::top_k(ties, 2, by_key) == (std::vector<std::pair<int, char>>{{2, 'b'}, {2, 'd'}}));
+    assert(ranged::top_k(ties, 4, by_key).back() == std::make_pair(1, 'a'));
+}
+
+TEST(vector, nth_test) {
+    const std::vector<int> v = {5, 1, 9, 3, 7, 9, 2, 8};
+    std::vector<int> sorted = v;
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t n = 0; n < v.size(); ++n) {
+        assert(ranged::nth(v, n) == sorted[n]);
+        assert(ranged::nth(v, n, std::greater<int>()) == sorted[v.size() - 1 - n]);
+    }
+    const std::list<int> l(v.begin(), v.end());
+    assert(ranged::nth(l, 2) == 3 && ranged::nth(l, 7) == 9);
+
+    bool thrown = false;
+    try {
+        ranged::nth(l, 8);
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+TEST(vector, merge_test) {
+    const std::vector<int> a = {1, 4, 7, 10};
+    const std::vector<int> b = {2, 4, 8};
+    const std::vector<int> c = {0, 4, 11};
+    const std::vector<int> none;
+    assert(ranged::to<std::vector>(ranged::merge(a, b, c, none)) == (std::vector<int>{0, 1, 2, 4, 4, 4, 7, 8, 10, 11}));
+    assert(ranged::to<std::vector>(ranged::merge(ranged::unique_merge, a, b, c)) == (std::vector<int>{0, 1, 2, 4, 7, 8, 10, 11}));
+    assert(ranged::merge(a, b).size() == 7);
+
+    // Composes with other views, which are moved into the merge
+    const auto odd = [](const int &x) { return x % 2 == 1; };
+    const auto odds = ranged::merge(ranged::filter(a, odd), ranged::filter(c, odd));
+    assert(ranged::to<std::vector>(odds) == (std::vector<int>{1, 7, 11}));
+    const auto doubled = odds | ranged::transform([](const int &x) { return 2 * x; });
+    assert(ranged::to<std::vector>(doubled) == (std::vector<int>{2, 14, 22}));
+
+    // Many shards at once, equivalent elements in shard order
+    std::vector<std::vector<std::pair<int, int>>> shards(64);
+    std::vector<std::pair<int, int>> expected;
+    for (int shard = 0; shard < 64; ++shard) {
+        for (int i = 0; i < 50; ++i) {
+            shards[shard].emplace_back((i * 7 + shard * 13) % 101, shard);
+        }
+        std::sort(shards[shard].begin(), shards[shard].end());
+        expected.insert(expected.end(), shards[shard].begin(), shards[shard].end());
+    }
+    const auto by_key = [](const std::pair<int, int> &lhs, const std::pair<int, int> &rhs) { return lhs.first < rhs.first; };
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    std::vector<std::pair<int, int>> merged;
+    for (const auto &item: ranged::merge(shards, by_key)) {
+        merged.push_back(item);
+    }
+    assert(merged == expected);
+
+    std::vector<std::pair<int, int>> compacted;
+    for (const auto &item: ranged::merge(ranged::unique_merge, shards, by_key)) {
+        compacted.push_back(item);
+    }
+    expected.erase(std::unique(expected.begin(), expected.end(), [](const std::pair<int, int> &lhs, const std::pair<int, int> &rhs) {
+        return lhs.first == rhs.first;
+    }), expected.end());
+    assert(compacted == expected);
+
+    // Owned shards, sorted the other way
+    const auto descending = ranged::merge(std::vector<std::vector<int>>{{9, 5, 1}, {8, 5}}, std::greater<int>());
+    assert(ranged::to<std::vector>(descending) == (std::vector<int>{9, 8, 5, 5, 1}));
+    const auto empty = ranged::merge(std::vector<std::vector<int>>{});
+    assert(empty.begin() == empty.end() && empty.size() == 0);
+}
+
+#if RANGED_HAS_MMAP
+TEST(vector, external_sort_test) {
+    std::vector<int> v(10000);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<int>((i * 7919) % 1009);
+    }
+    const std::vector<int> &input = v;
+    std::vector<int> expected = v;
+    std::sort(expected.begin(), expected.end());
+
+    // A budget of 1000 ints spills 10 runs
+    const auto sorted = ranged::external_sort(input, std::less<int>(), 1000 * sizeof(int));
+    assert(std::vector<int>(sorted.begin(), sorted.end()) == expected);
+    assert(sorted.size() == v.size() && sorted.spilled_bytes() == v.size() * sizeof(int));
+    const auto in_memory = ranged::external_sort(input);
+    assert(ranged::to<std::vector>(in_memory) == expected && in_memory.spilled_bytes() == 0);
+
+    // Any input view, and parallel run sorting
+    const auto odd = ranged::filter(input, [](const int &x) { return x % 2 == 1; });
+    const auto descending = ranged::external_sort(ranged::execution::par(4), odd, std::greater<int>(), 999 * sizeof(int));
+    std::vector<int> expected_odd = ranged::to<std::vector>(odd);
+    std::sort(expected_odd.begin(), expected_odd.end(), std::greater<int>());
+    assert(std::vector<int>(descending.begin(), descending.end()) == expected_odd);
+    assert(ranged::external_sort(std::vector<int>{}).size() == 0);
+
+    bool thrown = false;
+    try {
+        ranged::external_sort(input, std::less<int>(), 64, "/nonexistent-directory");
+    } catch (const std::system_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+#endif
+
+TEST(vector, reduce_test) {
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 1);
+    const std::vector<int> &values = v;
+    assert(ranged::reduce(values) == 500500);
+    assert(ranged::reduce(values, 0LL, [](long long lhs, long long rhs) { return lhs + rhs; }) == 500500);
+    assert(ranged::transform_reduce(values, 0LL, std::plus<long long>(), [](int x) { return static_cast<long long>(x) * x; }) == 333833500);
+    assert(ranged::reduce(ranged::filter(values, [](const int &x) { return x % 2 == 0; }), 0) == 250500);
+
+    // Only associativity is assumed: blocks and accumulators are combined in order
+    std::vector<std::string> letters;
+    for (int i = 0; i < 100; ++i) {
+        letters.push_back(std::string(1, static_cast<char>('a' + i % 26)));
+    }
+    const std::vector<std::string> &words = letters;
+    assert(ranged::reduce(words, std::string(">")) == std::accumulate(words.begin(), words.end(), std::string(">")));
+
+    std::vector<int> running(v.size());
+    std::partial_sum(v.begin(), v.end(), running.begin());
+    assert(ranged::inclusive_scan(values) == running);
+    const auto from_ten = ranged::exclusive_scan(values, 10);
+    assert(from_ten.size() == v.size() && from_ten.front() == 10 && from_ten.back() == 10 + running[running.size() - 2]);
+    assert((ranged::inclusive_scan(ranged::filter(values, [](const int &x) { return x <= 3; }), std::multiplies<int>()) == std::vector<int> {1, 2, 6}));
+    const std::vector<int> none;
+    assert(ranged::reduce(none, 7) == 7 && ranged::inclusive_scan(none).empty() && ranged::exclusive_scan(none, 1).empty());
+}
+
+TEST(vector, distinct_test) {
+    const std::vector<int> v = {3, 1, 3, 2, 1, 5, 2};
+    assert((ranged::to<std::vector>(ranged::distinct(v)) == std::vector<int> {3, 1, 2, 5}));
+    assert((ranged::to<std::vector>(ranged::distinct(v, [](const int &x) { return x % 2; })) == std::vector<int> {3, 2}));
+    assert((ranged::to<std::vector>(ranged::distinct(ranged::filter(v, [](const int &x) { return x > 1; }))) == std::vector<int> {3, 2, 5}));
+    const std::vector<int> sorted = {1, 1, 2, 3, 3, 3, 4};
+    assert((ranged::to<std::vector>(ranged::distinct(ranged::sorted_input, sorted)) == std::vector<int> {1, 2, 3, 4}));
+    const std::vector<std::string> words = {"Apple", "avocado", "banana", "Blueberry", "cherry"};
+    assert((ranged::to<std::vector>(ranged::distinct(ranged::sorted_input, words, [](const std::string &word) { return std::tolower(word[0]); })) ==
+            std::vector<std::string> {"Apple", "banana", "cherry"}));
+
+    // Every traversal starts over
+    const auto unique = ranged::distinct(std::vector<int>(v));
+    assert(std::distance(unique.begin(), unique.end()) == 4 && std::distance(unique.begin(), unique.end()) == 4);
+    assert(unique.size_hint() == v.size());
+
+    // The approximate mode never yields a key twice, and with room to spare misses none
+    std::vector<int> many;
+    for (int i = 0; i < 20000; ++i) {
+        many.push_back(i % 5000);
+    }
+    const std::vector<int> &repeated = many;
+    assert(ranged::to<std::vector>(ranged::distinct(ranged::approximate, repeated)) == ranged::to<std::vector>(ranged::distinct(repeated)));
+    const auto squeezed = ranged::to<std::vector>(ranged::distinct(ranged::approximate(256), repeated));
+    assert(squeezed.size() < 5000 && ranged::to<std::set>(squeezed).size() == squeezed.size());
+}
+
+TEST(vector, take_drop_test) {
+    std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    auto first = ranged::take(v, 3);
+    static_assert(std::is_same<decltype(first)::iterator, std::vector<int>::iterator>::value, "vector take must keep its iterators");
+    assert(first.size() == 3 && *(first.end() - 1) == 3);
+    for (int &x: first) {
+        x = -x;
+    }
+    assert(v[2] == -3 && v[3] == 4);
+    v[0] = 1, v[1] = 2, v[2] = 3;
+
+    assert(ranged::to<std::vector>(ranged::take(v, 20)) == v);
+    assert(ranged::to<std::vector>(ranged::drop(v, 7)) == (std::vector<int>{8, 9, 10}));
+    assert(ranged::drop(v, 20).size() == 0 && ranged::drop(v, 20).begin() == v.end());
+    assert(ranged::to<std::vector>(v | ranged::slice(2, 5)) == (std::vector<int>{3, 4, 5}));
+    assert(ranged::to<std::vector>(ranged::slice(v, 8, 20)) == (std::vector<int>{9, 10}));
+    assert(ranged::slice(v, 5, 2).size() == 0);
+    assert(ranged::to<std::vector>(v | ranged::stride(3)) == (std::vector<int>{1, 4, 7, 10}));
+    assert(ranged::stride(v, 4).size() == 3);
+    assert(ranged::to<std::vector>(ranged::stride(std::vector<int>{1, 2, 3}, 5)) == (std::vector<int>{1}));
+
+    bool thrown = false;
+    try {
+        ranged::stride(v, 0);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+TEST(vector, take_filter_test) {
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    // The predicate isn't evaluated past the last element taken
+    std::size_t tested = 0;
+    const auto even = [&tested](const int &i) {
+        ++tested;
+        return i % 2 == 0;
+    };
+    assert(ranged::to<std::vector>(v | ranged::filter(even) | ranged::take(3)) == (std::vector<int>{2, 4, 6}));
+    tested = 0;
+    int sum = 0;
+    for (int x: v | ranged::filter(even) | ranged::take(3)) {
+        sum += x;
+    }
+    assert(sum == 12 && tested == 6);
+
+    const auto squares = ranged::to<std::vector>(v | ranged::transform([](const int &i) { return i * i; }) | ranged::drop(9));
+    assert(squares == (std::vector<int>{100, 121, 144}));
+    assert(ranged::to<std::vector>(v | ranged::filter(even) | ranged::drop(4) | ranged::stride(2)) == (std::vector<int>{10}));
+
+    const auto small = [](const int &i) { return i < 4; };
+    assert(ranged::to<std::vector>(v | ranged::take_while(small)) == (std::vector<int>{1, 2, 3}));
+    assert(ranged::to<std::vector>(ranged::drop_while(v, [](const int &i) { return i < 10; })) == (std::vector<int>{10, 11, 12}));
+    assert(ranged::to<std::vector>(v | ranged::drop_while(small) | ranged::take_while([](const int &i) { return i < 6; })) ==
+           (std::vector<int>{4, 5}));
+    assert(ranged::to<std::vector>(ranged::take_while(std::vector<int>{5, 1}, small)).empty());
+
+    // Without random access, the skipped elements are walked by the first `begin()` only
+    const auto dropped = v | ranged::filter(even) | ranged::drop(4);
+    tested = 0;
+    assert(*dropped.begin() == 10 && tested == 10);
+    assert(*dropped.begin() == 10 && tested == 10);
+    std::size_t skipped = 0;
+    const auto before_ten = [&skipped](const int &i) {
+        ++skipped;
+        return i < 10;
+    };
+    const auto rest = v | ranged::drop_while(before_ten);
+    assert(*rest.begin() == 10 && *rest.begin() == 10 && skipped == 10);
+    assert(ranged::to<std::vector>(rest) == (std::vector<int>{10, 11, 12}) && skipped == 10);
+}
+
+TEST(vector, concat_flatten_test) {
+    const std::vector<int> a = {3, 1, 4};
+    const std::vector<int> empty;
+    const auto both = ranged::concat(a, empty, std::vector<int>{1, 5, 9, 2});
+    static_assert(std::is_same<decltype(both)::reference, const int &>::value, "concat must not copy elements");
+    assert(ranged::to<std::vector>(both) == (std::vector<int>{3, 1, 4, 1, 5, 9, 2}));
+    assert(both.size() == 7 && both.segments().size() == 3 && both.segments()[0].data() == a.data());
+    assert(ranged::max(both) == 9 && ranged::min(both) == 1);
+    assert(ranged::count_if(both, ranged::greater_than(2)) == 4 && ranged::count_if(both, [](const int &i) { return i % 2 == 0; }) == 2);
+    assert(ranged::contains(both, 5) && !ranged::contains(both, 7));
+
+    // Ranges of different types, yielding values of the common type
+    const std::list<long> l = {-7, 8};
+    const auto mixed = ranged::concat(a, l, ranged::filter(a, [](const int &i) { return i > 2; }));
+    static_assert(!ranged::is_segmented<decltype(mixed)>::value, "lists have no segments");
+    static_assert(std::is_same<decltype(mixed)::reference, long>::value, "mixed elements must be of their common type");
+    assert(ranged::to<std::vector>(mixed) == (std::vector<long>{3, 1, 4, -7, 8, 3, 4}));
+    assert(ranged::max(mixed) == 8 && ranged::min(mixed) == -7);
+
+    const std::vector<std::vector<int>> partitions = {{}, {5, 3}, {}, {}, {8}, {1, 1, 2}, {}};
+    const auto all = ranged::flatten(partitions);
+    assert(ranged::to<std::vector>(all) == (std::vector<int>{5, 3, 8, 1, 1, 2}));
+    assert(all.size() == 6 && ranged::count_if(all, ranged::equal_to(1)) == 2);
+    assert(ranged::max(all) == 8 && ranged::min(all) == 1 && ranged::contains(all, 3));
+    assert(ranged::max(all, std::greater<int>()) == 1);
+    assert(ranged::to<std::vector>(ranged::flatten(std::vector<std::vector<int>>(3))).empty());
+    assert(ranged::to<std::vector>(ranged::flatten(partitions) | ranged::filter([](const int &i) { return i < 5; }) | ranged::take(2)) ==
+           (std::vector<int>{3, 1}));
+
+    const std::list<std::list<int>> nested = {{1}, {}, {2, 3}};
+    static_assert(!ranged::is_segmented<decltype(ranged::flatten(nested))>::value, "lists have no segments");
+    assert(ranged::to<std::vector>(ranged::flatten(nested)) == (std::vector<int>{1, 2, 3}));
+}
+
+TEST(vector, sliding_test) {
+    const std::vector<int> v = {4, 2, 12, 3, 8, 3, 1, 7};
+    const auto windows = ranged::sliding(v, 3);
+    assert(windows.size() == 6);
+    std::vector<int> maxima;
+    for (const auto window: windows) {
+        assert(window.size() == 3);
+        maxima.push_back(ranged::max(window));
+    }
+    assert(maxima == (std::vector<int>{12, 12, 12, 8, 8, 7}));
+    assert(ranged::to<std::vector>(ranged::sliding(v, 3, ranged::agg::max())) == maxima);
+    assert(ranged::to<std::vector>(v | ranged::sliding(3, ranged::agg::min())) == (std::vector<int>{2, 2, 3, 3, 1, 1}));
+    assert(ranged::to<std::vector>(ranged::sliding(v, 3, ranged::agg::sum())) == (std::vector<int>{18, 17, 23, 14, 12, 11}));
+    assert(ranged::to<std::vector>(ranged::sliding(v, 4, ranged::agg::mean())) == (std::vector<double>{5.25, 6.25, 6.5, 3.75, 4.75}));
+    assert(ranged::to<std::vector>(ranged::sliding(v, 2, ranged::agg::count())) == (std::vector<std::size_t>(7, 2)));
+    assert(ranged::sliding(v, 9).empty() && ranged::to<std::vector>(ranged::sliding(v, 9, ranged::agg::sum())).empty());
+    assert(ranged::sliding(v, 8).size() == 1 && ranged::to<std::vector>(ranged::sliding(v, 8, ranged::agg::sum())) == (std::vector<int>{40}));
+
+    // Monotonic deques against a scan of every window
+    std::vector<int> noise(300);
+    unsigned seed = 7;
+    for (int &x: noise) {
+        seed = seed * 1103515245u + 12345u;
+        x = static_cast<int>((seed >> 16) % 50);
+    }
+    const std::vector<int> &samples = noise;
+    for (std::size_t n = 1; n < 20; ++n) {
+        std::vector<int> lows, highs;
+        for (const auto window: ranged::sliding(samples, n)) {
+            lows.push_back(ranged::min(window));
+            highs.push_back(ranged::max(window));
+        }
+        assert(ranged::to<std::vector>(ranged::sliding(samples, n, ranged::agg::min())) == lows);
+        assert(ranged::to<std::vector>(samples | ranged::sliding(n, ranged::agg::max())) == highs);
+    }
+
+    // Over lazy views, whose elements are read once
+    std::size_t calls = 0;
+    const auto odd = v | ranged::filter([](const int &i) { return i % 2 != 0; });
+    assert(ranged::to<std::vector>(odd | ranged::sliding(2, ranged::agg::sum())) == (std::vector<int>{6, 4, 8}));
+    const auto scaled = ranged::transform(v, [&calls](const int &i) {
+        ++calls;
+        return i * 10;
+    });
+    assert(ranged::to<std::vector>(ranged::sliding(scaled, 5, ranged::agg::max())) == (std::vector<int>{120, 120, 120, 80}));
+    assert(calls == v.size());
+
+    const auto tumbling = ranged::tumbling(v, 3);
+    assert(tumbling.size() == 3);
+    std::vector<std::size_t> sizes;
+    for (const auto window: tumbling) {
+        sizes.push_back(window.size());
+    }
+    assert(sizes == (std::vector<std::size_t>{3, 3, 2}));
+    assert(ranged::to<std::vector>(ranged::tumbling(v, 3, ranged::agg::sum())) == (std::vector<int>{18, 14, 8}));
+    assert(ranged::to<std::vector>(v | ranged::tumbling(4, ranged::agg::max())) == (std::vector<int>{12, 8}));
+
+    bool thrown = false;
+    try {
+        ranged::sliding(v, 0);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
 TEST(vector, to_list_test) {
     const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
     const auto result = ranged::to<std::list>(v);
@@ -235,6 +1076,15 @@ TEST(array, zip_test) {
     assert(std::get<0>(result[3]) == 4 && std::get<1>(result[3]) == 40);
 }
 
+TEST(array, filter_with_allocator_test) {
+    const std::array<int, 6> a = {{1, 2, 3, 4, 5, 6}};
+    ranged::monotonic_arena arena;
+    const auto result = ranged::filter(a, [](const int &i) { return i > 3; }, ranged::arena_allocator<int>(arena));
+    static_assert(std::is_same<decltype(result), const std::vector<int, ranged::arena_allocator<int>>>::value, "allocator must be used");
+    assert(result.size() == 3 && result.front() == 4);
+    assert(arena.used() == 6 * sizeof(int));
+}
+
 // set tests (works for iterator-based ops; avoid max/min/to_array which need at())
 TEST(set, any_test) {
     const std::set<int> s = {1, 2, 3, 4, 5};
@@ -277,6 +1127,29 @@ TEST(set, select_test) {
     assert(result == expected);
 }
 
+TEST(set, transform_cached_test) {
+    const std::set<int> s = {1, 2, 3, 4, 5};
+    std::size_t calls = 0;
+    auto cached = ranged::filter(s, [](const int &i) { return i % 2 == 1; }) | ranged::transform_cached([&calls](const int &i) {
+        ++calls;
+        return std::to_string(i);
+    });
+    assert(ranged::to<std::set>(cached) == (std::set<std::string>{"1", "3", "5"}));
+    assert(ranged::to<std::set>(cached) == (std::set<std::string>{"1", "3", "5"}));
+    assert(calls == 3);
+
+    // Unsized ranges fill a chunked cache, whose elements do not move as it grows
+    std::list<int> many;
+    for (int i = 0; i < 1000; ++i) {
+        many.push_back(i);
+    }
+    const auto memoized = many | ranged::transform([&calls](const int &i) { ++calls; return i * 2; }) | ranged::memoize();
+    calls = 0;
+    const int &first = *memoized.begin();
+    assert(ranged::to<std::vector>(memoized).back() == 1998 && calls == 1000);
+    assert(&first == &*memoized.begin() && ranged::count_if(memoized, [](const int &i) { return i % 4 == 0; }) == 500 && calls == 1000);
+}
+
 TEST(set, zip_test) {
     const std::set<int> s = {1, 2, 3, 4, 5};
     const std::set<int> s2 = {1, 2, 3, 4, 5};
@@ -374,6 +1247,19 @@ TEST(map, select_test) {
     assert(result.at("c") == "30");
 }
 
+TEST(map, aggregate_by_test) {
+    const std::map<std::string, int> m = {{"apple", 3}, {"avocado", 5}, {"banana", 2}, {"blueberry", 7}, {"cherry", 1}};
+    const auto initial = [](const std::pair<const std::string, int> &p) { return p.first[0]; };
+    const auto totals = ranged::aggregate_by(ranged::filter(m, [](const std::pair<const std::string, int> &p) { return p.second > 1; }),
+                                             initial, ranged::agg::sum([](const std::pair<const std::string, int> &p) { return p.second; }));
+    assert(totals.size() == 2);
+    assert(totals.at('a') == 8 && totals.at('b') == 9);
+
+    const auto lengths = ranged::transform(m, [](const std::pair<const std::string, int> &p) { return p.first.size(); });
+    const auto by_length = ranged::aggregate_by(lengths, [](const std::size_t &size) { return size > 6; }, ranged::agg::count());
+    assert(by_length.at(true) == 2 && by_length.at(false) == 3);
+}
+
 TEST(unordered_map, any_test) {
     const std::unordered_map<std::string, int> m = {{"x", 10}, {"y", 20}, {"z", 30}};
     assert(ranged::any(m, [](const std::pair<const std::string, int> &p) { return p.second == 20; }));
@@ -403,6 +1289,12 @@ TEST(unordered_map, select_test) {
     assert(result.find("z_key") != result.end());
 }
 
+TEST(unordered_map, group_by_test) {
+    const std::unordered_map<std::string, int> m = {{"x", 10}, {"y", 20}, {"z", 30}};
+    const auto groups = ranged::group_by(m, [](const std::pair<const std::string, int> &p) { return p.second >= 20; });
+    assert(groups.at(true).size() == 2 && groups.at(false).front().first == "x");
+}
+
 // list tests (iterator-based only)
 TEST(list, any_test) {
     const std::list<int> l = {1, 2, 3, 4, 5};
@@ -438,6 +1330,28 @@ TEST(list, select_test) {
     assert(result == expected);
 }
 
+TEST(list, to_vector_reserves_test) {
+    const std::list<int> l = {1, 2, 3, 4, 5};
+    static_assert(ranged::sized<const std::list<int>>::value, "list knows its size");
+    const auto v = ranged::to<std::vector>(l);
+    assert(v.capacity() == l.size());
+    assert(v == (std::vector<int>{1, 2, 3, 4, 5}));
+}
+
+TEST(list, filter_size_hint_test) {
+    const std::list<int> l = {1, 2, 3, 4, 5};
+    const auto filtered = ranged::filter(l, [](const int &x) { return x > 2; });
+    static_assert(!ranged::sized<decltype(filtered)>::value, "filter cannot report an exact size");
+    assert(filtered.size_hint() == 5);
+    assert(ranged::to<std::vector>(filtered).size() == 3);
+}
+
+TEST(list, to_array_test) {
+    const std::list<int> l = {1, 2, 3};
+    const auto a = ranged::to_array<5>(l);
+    assert(a[0] == 1 && a[2] == 3 && a[3] == 0 && a[4] == 0);
+}
+
 TEST(list, zip_test) {
     std::list<std::string> l1 = {"1", "2", "3"};
     std::list<int> l2 = {10, 20, 30};
@@ -452,6 +1366,448 @@ TEST(list, zip_test) {
     assert(std::get<0>(*it) == "3" && std::get<1>(*it) == 30);
 }
 
+TEST(list, pipe_test) {
+    const std::list<int> l = {1, 2, 3, 4, 5};
+    const auto result = l | ranged::filter([](const int &i) { return i != 3; }) | ranged::transform([](const int &i) { return i * i; });
+    assert(result.size_hint() == 5);
+    assert(ranged::to<std::vector>(result) == (std::vector<int>{1, 4, 16, 25}));
+}
+
+TEST(list, chunk_test) {
+    const std::list<int> l = {1, 2, 3, 4, 5};
+    const auto chunks = ranged::chunk(l, 2);
+    assert(chunks.size() == 3);
+    std::vector<std::size_t> sizes;
+    std::vector<int> firsts;
+    for (const auto chunk: chunks) {
+        sizes.push_back(chunk.size());
+        firsts.push_back(chunk.front());
+    }
+    assert(sizes == (std::vector<std::size_t>{2, 2, 1}));
+    assert(firsts == (std::vector<int>{1, 3, 5}));
+}
+
+TEST(list, large_and_owned_chunk_test) {
+    std::list<std::uint64_t> l;
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        l.push_back(i);
+    }
+    // Chunks larger than the inline buffer of the iterator
+    const auto chunks = ranged::chunk(l, 40);
+    std::vector<std::size_t> sizes;
+    for (const auto chunk: chunks) {
+        sizes.push_back(chunk.size());
+        assert(chunk[0] == sizes.size() * 40 - 40);
+    }
+    assert(sizes == (std::vector<std::size_t>{40, 40, 20}));
+    auto it = chunks.begin();
+    const auto copy = it;
+    ++it;
+    assert((*copy)[39] == 39 && (*it)[0] == 40);
+
+    // Rvalue ranges are moved into the view
+    const auto owned = ranged::chunk(std::list<int>{1, 2, 3, 4, 5}, 2);
+    std::vector<std::vector<int>> result;
+    for (const auto chunk: owned) {
+        result.emplace_back(chunk.begin(), chunk.end());
+    }
+    assert(result == (std::vector<std::vector<int>>{{1, 2}, {3, 4}, {5}}));
+}
+
+TEST(list, take_drop_test) {
+    const std::list<int> l = {1, 2, 3, 4, 5, 6, 7};
+    const auto first = ranged::take(l, 3);
+    assert(first.size() == 3);
+    assert(ranged::to<std::vector>(first) == (std::vector<int>{1, 2, 3}));
+    assert(ranged::to<std::vector>(ranged::take(l, 10)) == (std::vector<int>{1, 2, 3, 4, 5, 6, 7}));
+    assert(ranged::to<std::vector>(l | ranged::drop(5)) == (std::vector<int>{6, 7}));
+    assert(ranged::to<std::vector>(l | ranged::slice(1, 3)) == (std::vector<int>{2, 3}));
+    assert(ranged::to<std::vector>(l | ranged::stride(3)) == (std::vector<int>{1, 4, 7}));
+    assert(ranged::to<std::vector>(ranged::take(l, 0)).empty());
+
+    // The iterator on the last element taken doesn't compare equal to the one past it
+    assert(std::distance(first.begin(), first.end()) == 3 && std::next(first.begin(), 2) != std::next(first.begin(), 3));
+    assert(ranged::to<std::vector>(ranged::sliding(first, 2, ranged::agg::sum())) == (std::vector<int>{3, 5}));
+    assert(ranged::to<std::vector>(ranged::tumbling(first, 3, ranged::agg::collect())) == (std::vector<std::vector<int>>{{1, 2, 3}}));
+    std::vector<std::vector<int>> windows;
+    for (const auto window: ranged::sliding(first, 2)) {
+        windows.emplace_back(window.begin(), window.end());
+    }
+    assert(windows == (std::vector<std::vector<int>>{{1, 2}, {2, 3}}));
+}
+
+TEST(list, sliding_test) {
+    const std::list<int> l = {5, 1, 4, 2, 3};
+    assert(ranged::to<std::vector>(ranged::sliding(l, 2, ranged::agg::max())) == (std::vector<int>{5, 4, 4, 3}));
+    assert(ranged::to<std::vector>(l | ranged::sliding(3, ranged::agg::sum())) == (std::vector<int>{10, 7, 9}));
+    assert(ranged::to<std::vector>(ranged::tumbling(l, 2, ranged::agg::collect())) == (std::vector<std::vector<int>>{{5, 1}, {4, 2}, {3}}));
+    std::vector<int> firsts;
+    for (const auto window: l | ranged::sliding(4)) {
+        firsts.push_back(*window.begin());
+    }
+    assert(firsts == (std::vector<int>{5, 1}));
+}
+
+// simd tests (every size up to a few vector widths, so each kernel's main loop and tail are exercised)
+template<typename T>
+static void check_simd_kernels() {
+    for (size_t size = 0; size < 300; ++size) {
+        std::vector<T> v(size);
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<T>(static_cast<int>((i * 37 + size) % 101) - 50);
+        }
+        const T pivot = static_cast<T>(7);
+
+        if (size > 0) {
+            assert(ranged::max(v) == *std::max_element(v.begin(), v.end()));
+            assert(ranged::min(v) == *std::min_element(v.begin(), v.end()));
+        }
+        assert(ranged::count_if(v, ranged::greater_than(pivot)) ==
+               static_cast<size_t>(std::count_if(v.begin(), v.end(), [&](const T &x) { return x > pivot; })));
+        assert(ranged::count_if(v, ranged::less_than(pivot)) ==
+               static_cast<size_t>(std::count_if(v.begin(), v.end(), [&](const T &x) { return x < pivot; })));
+        assert(ranged::count_if(v, ranged::equal_to(pivot)) == static_cast<size_t>(std::count(v.begin(), v.end(), pivot)));
+        assert(ranged::contains(v, pivot) == (std::find(v.begin(), v.end(), pivot) != v.end()));
+        assert(!ranged::contains(v, static_cast<T>(100)));
+    }
+}
+
+TEST(simd, int8_test) {
+    check_simd_kernels<signed char>();
+}
+
+TEST(simd, int32_test) {
+#if RANGED_SIMD
+    static_assert(ranged::is_simd_range<std::vector<int>>::value, "vector<int> takes the SIMD path");
+#endif
+    static_assert(!ranged::is_simd_range<std::deque<int>>::value, "deque is not contiguous");
+    check_simd_kernels<int>();
+}
+
+TEST(simd, int64_test) {
+    check_simd_kernels<long long>();
+}
+
+TEST(simd, float_test) {
+    check_simd_kernels<float>();
+}
+
+TEST(simd, double_test) {
+    check_simd_kernels<double>();
+}
+
+TEST(simd, uint8_count_does_not_overflow_test) {
+    const std::vector<unsigned char> v(100000, 3);
+    assert(ranged::count_if(v, ranged::equal_to<unsigned char>(3)) == v.size());
+    assert(ranged::count_if(v, ranged::greater_than<unsigned char>(3)) == 0);
+}
+
+TEST(simd, span_and_array_test) {
+    std::array<float, 9> a = {{3.5f, -1.0f, 8.25f, 0.0f, 2.0f, 8.0f, -7.5f, 1.0f, 4.0f}};
+    assert(ranged::max(a) == 8.25f);
+    assert(ranged::min(a) == -7.5f);
+
+    const ranged::span<float> s(a.data() + 2, 5);
+    assert(ranged::max(s) == 8.25f);
+    assert(ranged::min(s) == -7.5f);
+    assert(ranged::contains(s, 2.0f) && !ranged::contains(s, 3.5f));
+    assert(ranged::count_if(s, ranged::greater_than(1.0f)) == 3);
+    assert(ranged::count_if(s.subspan(1, 2), ranged::less_than(1.0f)) == 1);
+}
+
+TEST(simd, empty_range_keeps_limits_test) {
+    const std::vector<int> v;
+    assert(ranged::max(v) == std::numeric_limits<int>::min());
+    assert(ranged::min(v) == std::numeric_limits<int>::max());
+    assert(ranged::count_if(v, ranged::equal_to(0)) == 0);
+    assert(!ranged::contains(v, 0));
+}
+
+// parallel tests (large enough to be split into several chunks)
+static std::vector<int> parallel_input() {
+    std::vector<int> v(1 << 18);
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<int>((i * 7919) % 100003);
+    }
+    return v;
+}
+
+TEST(parallel, any_all_test) {
+    const std::vector<int> v = parallel_input();
+    assert(ranged::any(ranged::execution::par(4), v, [](const int &x) { return x == 100002; }));
+    assert(!ranged::any(ranged::execution::par_unseq(4), v, [](const int &x) { return x < 0; }));
+    assert(ranged::all(ranged::execution::par(4), v, [](const int &x) { return x >= 0; }));
+    assert(!ranged::all(ranged::execution::seq, v, [](const int &x) { return x > 0; }));
+}
+
+TEST(parallel, count_if_test) {
+    const std::vector<int> v = parallel_input();
+    const auto pred = [](const int &x) { return x % 3 == 0; };
+    assert(ranged::count_if(ranged::execution::par(4), v, pred) == ranged::count_if(v, pred));
+
+    // Workers fill the cache of a shared view, each element once
+    std::atomic<std::size_t> calls {0};
+    const auto cached = ranged::transform_cached(v, [&calls](const int &x) { ++calls; return x * 2; });
+    const auto doubled_pred = [](const int &x) { return x % 6 == 0; };
+    assert(ranged::count_if(ranged::execution::par(4), cached, doubled_pred) == ranged::count_if(v, pred));
+    assert(ranged::count_if(ranged::execution::par(4), cached, doubled_pred) == ranged::count_if(v, pred) && calls == v.size());
+}
+
+TEST(parallel, first_or_default_test) {
+    const std::vector<int> v = parallel_input();
+    const auto pred = [](const int &x) { return x > 100000; };
+    assert(ranged::first_or_default(ranged::execution::par(4), v, pred) == ranged::first_or_default(v, pred));
+    assert(ranged::first_or_default(ranged::execution::par(4), v, [](const int &x) { return x < 0; }, -1) == -1);
+}
+
+TEST(parallel, min_max_test) {
+    const std::vector<int> v = parallel_input();
+    assert(ranged::max(ranged::execution::par(4), v) == ranged::max(v));
+    assert(ranged::min(ranged::execution::par(4), v) == ranged::min(v));
+    assert(ranged::max(ranged::execution::par, std::vector<int>{}) == std::numeric_limits<int>::min());
+}
+
+TEST(parallel, for_each_test) {
+    std::vector<int> v(1 << 18, 1);
+    ranged::for_each(ranged::execution::par(4), v, [](int &x) { x *= 2; });
+    assert(ranged::all(v, [](const int &x) { return x == 2; }));
+}
+
+TEST(parallel, list_falls_back_to_sequential_test) {
+    const std::list<int> l = {1, 2, 3, 4, 5};
+    assert(ranged::count_if(ranged::execution::par, l, [](const int &x) { return x > 2; }) == 3);
+    assert(ranged::max(ranged::execution::par, l) == 5);
+}
+
+TEST(parallel, exception_test) {
+    const std::vector<int> v = parallel_input();
+    bool thrown = false;
+    try {
+        ranged::for_each(ranged::execution::par(4), v, [](const int &x) {
+            if (x == 100002)
+                throw std::runtime_error("boom");
+        });
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+TEST(parallel, pool_growth_test) {
+    ranged::thread_pool pool(1);
+    std::atomic<std::size_t> calls(0);
+    pool.parallel_for(1000, 256, [&calls](std::size_t) { calls.fetch_add(1, std::memory_order_relaxed); });
+    assert(calls == 1000);
+    // Asking for more threads than the hardware has runs on the ones it has, it does not leave idle ones behind
+    assert(pool.concurrency() <= std::max<std::size_t>(2, std::thread::hardware_concurrency()));
+}
+
+TEST(parallel, aggregate_by_test) {
+    const std::vector<int> v = parallel_input();
+    const auto bucket = [](const int &x) { return x % 1000; };
+    const auto expected = ranged::aggregate_by(v, bucket, ranged::agg::count(), ranged::agg::sum([](const int &x) { return static_cast<long long>(x); }),
+                                               ranged::agg::max());
+    const auto result = ranged::aggregate_by(ranged::execution::par(4), v, bucket, ranged::agg::count(),
+                                             ranged::agg::sum([](const int &x) { return static_cast<long long>(x); }), ranged::agg::max());
+    assert(result.size() == expected.size());
+    for (const auto &group: expected) {
+        assert(result.at(group.first) == group.second);
+    }
+
+    // Elements keep their range order within every group
+    const auto groups = ranged::group_by(ranged::execution::par(4), v, [](const int &x) { return x % 7; });
+    const auto sequential = ranged::group_by(v, [](const int &x) { return x % 7; });
+    assert(groups.size() == 7);
+    for (const auto &group: sequential) {
+        assert(groups.at(group.first) == group.second);
+    }
+}
+
+TEST(parallel, top_k_test) {
+    const std::vector<int> v = parallel_input();
+    assert(ranged::top_k(ranged::execution::par(4), v, 100) == ranged::top_k(v, 100));
+    assert(ranged::top_k(ranged::execution::par(4), v, 10, std::greater<int>()) == ranged::top_k(v, 10, std::greater<int>()));
+    assert(ranged::nth(ranged::execution::par(4), v, v.size() / 2) == ranged::nth(v, v.size() / 2));
+
+    // Ties are broken by position, as in the sequential version
+    const auto by_bucket = [](const int &lhs, const int &rhs) { return lhs / 1000 < rhs / 1000; };
+    assert(ranged::top_k(ranged::execution::par(4), v, 500, by_bucket) == ranged::top_k(v, 500, by_bucket));
+    assert(ranged::top_k(ranged::execution::par, std::vector<int>{}, 3).empty());
+}
+
+TEST(parallel, reduce_test) {
+    const std::vector<int> v = parallel_input();
+    assert(ranged::reduce(ranged::execution::par(4), v, 0LL) == ranged::reduce(v, 0LL));
+    const auto square = [](int x) { return static_cast<double>(x) * x; };
+    assert(ranged::transform_reduce(ranged::execution::par_unseq(3), v, 0LL, std::plus<long long>(), [](int x) { return static_cast<long long>(x) * x; })
+           == ranged::transform_reduce(v, 0LL, std::plus<long long>(), [](int x) { return static_cast<long long>(x) * x; }));
+
+    // Deterministic policies fold the same blocks as the sequential version, whatever the number of threads
+    const double sequential = ranged::transform_reduce(v, 0.0, std::plus<double>(), square);
+    for (const std::size_t threads: {1, 2, 4, 7}) {
+        assert(ranged::transform_reduce(ranged::execution::deterministic(ranged::execution::par(threads)), v, 0.0, std::plus<double>(), square) == sequential);
+    }
+
+    assert(ranged::inclusive_scan(ranged::execution::par(4), v, std::bit_xor<int>()) == ranged::inclusive_scan(v, std::bit_xor<int>()));
+    assert(ranged::exclusive_scan(ranged::execution::par(4), v, 5LL) == ranged::exclusive_scan(v, 5LL));
+    std::vector<double> fractions;
+    for (const int x: v) {
+        fractions.push_back(1.0 / (x + 1));
+    }
+    const auto scanned = ranged::inclusive_scan(ranged::execution::deterministic(ranged::execution::par(2)), fractions);
+    assert(ranged::inclusive_scan(ranged::execution::deterministic(ranged::execution::par(5)), fractions) == scanned);
+}
+
+TEST(parallel, pipeline_test) {
+    const std::vector<int> v = parallel_input();
+    const auto twice = [](int x) { return x * 2; };
+    const auto multiple_of_3 = [](const int &x) { return x % 3 == 0; };
+    const auto expected = ranged::to<std::vector>(ranged::transform(ranged::filter(ranged::to<std::vector>(ranged::transform(v, twice)), multiple_of_3),
+                                                                    [](int x) { return std::to_string(x); }));
+
+    // Replicated stages finish batches out of order; ordered runs restore the source order
+    auto pipeline = ranged::pipeline(v, ranged::pipeline_options(64, 2)).transform(twice, 3).filter(multiple_of_3).transform([](int x) {
+        return std::to_string(x);
+    }, 2);
+    assert(pipeline.to<std::vector>() == expected);
+    const auto stats = pipeline.stats();
+    assert(stats.size() == 5);
+    assert(stats[0].items_out == v.size() && stats[1].replicas == 3 && stats[1].items_in == v.size());
+    assert(stats[2].items_out == expected.size() && stats[4].items_in == expected.size());
+    assert(stats[1].queue_capacity == 2 && stats[1].queue_peak <= 2);
+
+    auto unordered = ranged::pipeline(std::vector<int>(v), ranged::pipeline_options(100, 4, false)).filter(multiple_of_3, 0).to<std::vector>();
+    auto filtered = ranged::to<std::vector>(ranged::filter(v, multiple_of_3));
+    std::sort(unordered.begin(), unordered.end());
+    std::sort(filtered.begin(), filtered.end());
+    assert(unordered == filtered);
+
+    const std::vector<int> none;
+    assert(ranged::pipeline(none).transform(twice).to<std::vector>().empty());
+
+    // The first exception, from a stage or from the sink, stops every thread and reaches the caller
+    bool thrown = false;
+    try {
+        ranged::pipeline(v).transform([](int x) {
+            if (x == 5000)
+                throw std::runtime_error("stage");
+            return x;
+        }, 2).for_each([](int) {});
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        ranged::pipeline(v).transform(twice, 2).for_each([](int x) {
+            if (x == 10000)
+                throw std::logic_error("sink");
+        });
+    } catch (const std::logic_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+#if RANGED_HAS_COROUTINES
+static ranged::generator<int> squares(std::allocator_arg_t, ranged::monotonic_arena &, int n) {
+    for (int i = 0; i < n; ++i)
+        co_yield i * i;
+}
+
+TEST(generator, sources_test) {
+    ranged::monotonic_arena arena;
+    const auto evens = ranged::to<std::vector>(ranged::filter(squares(std::allocator_arg, arena, 10), [](int x) { return x % 2 == 0; }));
+    assert((evens == std::vector<int> {0, 4, 16, 36, 64}));
+    assert(arena.used() > 0);
+    assert(ranged::count_if(squares(std::allocator_arg, arena, 10), [](int x) { return x > 10; }) == 6);
+    const auto halves = ranged::to<std::vector>(ranged::transform(squares(std::allocator_arg, arena, 4), [](int x) { return x / 2; }));
+    assert((halves == std::vector<int> {0, 0, 2, 4}));
+}
+#endif
+
+TEST(io, lines_test) {
+    const std::string text = "alpha\r\nbeta\n\ngamma";
+    const auto lines = ranged::lines(text);
+    const auto result = ranged::to<std::vector>(lines);
+    assert(result.size() == 4);
+    assert(result[0] == "alpha" && result[1] == "beta" && result[2] == "" && result[3] == "gamma");
+    assert(ranged::to<std::vector>(ranged::lines(std::string("a\nb\n"))).size() == 2);
+    const std::string nothing;
+    const auto none = ranged::lines(nothing);
+    assert(none.empty() && none.begin() == none.end());
+
+    const auto lengths = ranged::to<std::vector>(lines | ranged::transform([](const ranged::string_view &line) { return line.size(); }));
+    assert(lengths == (std::vector<std::size_t>{5, 4, 0, 5}));
+    assert(ranged::count_if(lines, [](const ranged::string_view &line) { return line.empty(); }) == 1);
+    const auto long_lines = ranged::to<std::vector>(ranged::filter(lines, [](const ranged::string_view &line) { return line.size() > 4; }));
+    assert(long_lines.size() == 2 && long_lines[1] == "gamma");
+}
+
+TEST(io, records_test) {
+    struct trade {
+        std::int32_t id;
+        float price;
+    };
+    const std::vector<trade> trades = {{1, 1.5f}, {2, 2.5f}, {3, 3.5f}};
+    // One byte too many: the partial record is ignored, and the records start unaligned
+    std::string bytes(1 + sizeof(trade) * trades.size() + 1, '\0');
+    std::memcpy(&bytes[1], trades.data(), sizeof(trade) * trades.size());
+    const auto records = ranged::records<trade>(ranged::string_view(bytes.data() + 1, bytes.size() - 1));
+    assert(records.size() == 3);
+    assert(records[1].id == 2 && records.begin()[2].price == 3.5f);
+    assert(ranged::count_if(records, [](const trade &t) { return t.price > 2; }) == 2);
+    assert(std::distance(records.begin(), records.end()) == 3);
+}
+
+#if RANGED_HAS_MMAP
+static std::string write_temp_file(const std::string &contents) {
+    char path[] = "/tmp/ranged_test_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    const ssize_t written = write(fd, contents.data(), contents.size());
+    assert(written == static_cast<ssize_t>(contents.size()));
+    (void) written;
+    close(fd);
+    return path;
+}
+
+TEST(io, mapped_file_test) {
+    // The views of a temporary mapping would dangle
+    static_assert(std::is_convertible<const ranged::mapped_file &, ranged::string_view>::value, "mapped files must be views");
+    static_assert(!std::is_convertible<ranged::mapped_file, ranged::string_view>::value, "temporary mappings must not be views");
+    const std::string path = write_temp_file("error: disk\ninfo: ok\nerror: net\n");
+    {
+        const ranged::mapped_file file(path);
+        assert(file.size() == 32);
+        const auto lines = ranged::lines(file);
+        assert(ranged::count_if(lines, [](const ranged::string_view &line) { return line.substr(0, 5) == "error"; }) == 2);
+        const auto errors = ranged::to<std::vector>(lines | ranged::filter([](const ranged::string_view &line) {
+            return line.substr(0, 5) == "error";
+        }) | ranged::transform([](const ranged::string_view &line) { return static_cast<std::string>(line.substr(7)); }));
+        assert(errors == (std::vector<std::string>{"disk", "net"}));
+        file.release(file.end());
+        assert(*lines.begin() == "error: disk");
+    }
+    std::remove(path.c_str());
+
+    const std::string empty = write_temp_file("");
+    {
+        const ranged::mapped_file none(empty);
+        assert(none.empty() && ranged::lines(none).empty());
+    }
+    std::remove(empty.c_str());
+
+    bool thrown = false;
+    try {
+        ranged::mapped_file missing(path);
+    } catch (const std::system_error &error) {
+        thrown = error.code().value() == ENOENT;
+    }
+    assert(thrown);
+}
+#endif
+
 int main() {
     dispatcher::run_tests<std::chrono::nanoseconds>();
     return 0;